@@ -12,6 +12,11 @@ function CSX = AddDiscMaterial(CSX, name, varargin)
 %  'Transform':        Apply a transformation, see AddBox for more infos
 %  'UseDBBackground':  set to 0, to use the properties background material
 %                      instead of the database material with index 0 (default)
+%  'LazyLoad':         set to 1, to keep the material indices on disk and load
+%                      them on demand (for very large models)
+%  'CacheSize':        memory budget in MB for lazy loading (default 256)
+%  'SparseIndex':      set to 0, to disable the compact storage of uniform
+%                      blocks of material indices
 %
 % examples:
 % %add human body model
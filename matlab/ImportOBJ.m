@@ -0,0 +1,26 @@
+function CSX = ImportOBJ(CSX, propName, prio, filename, varargin)
+% function CSX = ImportOBJ(CSX, propName, prio, filename, varargin)
+%
+% example:
+%   CSX = AddMetal( CSX, 'cad_model' ); % create a perfect electric conductor (PEC)
+%   CSX = ImportOBJ(CSX, 'cad_model',10, 'sphere.obj','Transform',{'Scale',1/unit});
+%
+%   Optional: cache the processed geometry for repeated runs (e.g. parameter sweeps)
+%   CSX = ImportOBJ(CSX, 'cad_model',10, 'sphere.obj','CacheDir','/tmp/csx_cache');
+%
+%   Note: make sure the file 'sphere.obj' is in the working directory
+%
+% See also AddBox, AddCylinder, AddCylindricalShell, AddSphere, AddSphericalShell,
+% AddCurve, AddWire, AddMetal, ImportSTL, ImportPLY
+%
+% CSXCAD matlab interface
+% -----------------------
+% author: Thorsten Liebig
+
+objfile.ATTRIBUTE.Priority = prio;
+objfile.ATTRIBUTE.FileName = filename;
+objfile.ATTRIBUTE.FileType = 'OBJ';
+
+objfile = AddPrimitiveArgs(objfile,varargin{:});
+
+CSX = Add2Property(CSX,propName, objfile, 'PolyhedronReader');
@@ -5,6 +5,9 @@ function CSX = ImportPLY(CSX, propName, prio, filename, varargin)
 %   CSX = AddMetal( CSX, 'cad_model' ); % create a perfect electric conductor (PEC)
 %   CSX = ImportPLY(CSX, 'cad_model',10, 'sphere.ply','Transform',{'Scale',1/unit});
 %
+%   Optional: cache the processed geometry for repeated runs (e.g. parameter sweeps)
+%   CSX = ImportPLY(CSX, 'cad_model',10, 'sphere.ply','CacheDir','/tmp/csx_cache');
+%
 %   Note: make sure the file 'sphere.ply' is in the working directory
 %
 % See also AddBox, AddCylinder, AddCylindricalShell, AddSphere, AddSphericalShell,
@@ -5,6 +5,9 @@ function CSX = ImportSTL(CSX, propName, prio, filename, varargin)
 %   CSX = AddMetal( CSX, 'cad_model' ); % create a perfect electric conductor (PEC)
 %   CSX = ImportSTL(CSX, 'cad_model',10, 'sphere.stl','Transform',{'Scale',1/unit});
 %
+%   Optional: cache the processed geometry for repeated runs (e.g. parameter sweeps)
+%   CSX = ImportSTL(CSX, 'cad_model',10, 'sphere.stl','CacheDir','/tmp/csx_cache');
+%
 %   Note: make sure the file 'sphere.stl' is in the working directory
 %
 % See also AddBox, AddCylinder, AddCylindricalShell, AddSphere, AddSphericalShell,
@@ -0,0 +1,44 @@
+# -*- coding: utf-8 -*-
+#
+# Copyright (C) 2016 Thorsten Liebig (Thorsten.Liebig@gmx.de)
+#
+# This program is free software: you can redistribute it and/or modify
+# it under the terms of the GNU Lesser General Public License as published
+# by the Free Software Foundation, either version 3 of the License, or
+# (at your option) any later version.
+#
+# This program is distributed in the hope that it will be useful,
+# but WITHOUT ANY WARRANTY; without even the implied warranty of
+# MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+# GNU Lesser General Public License for more details.
+#
+# You should have received a copy of the GNU Lesser General Public License
+# along with this program.  If not, see <http://www.gnu.org/licenses/>.
+
+from libcpp cimport bool
+from libcpp.vector cimport vector
+
+from CSXCAD cimport _ContinuousStructure, ContinuousStructure
+from CSRectGrid cimport _CSRectGrid, CSRectGrid
+
+cdef extern from "CSXCAD/CSEdgeDetector.h":
+    cdef cppclass _CSEdgeDetector "CSEdgeDetector":
+            _CSEdgeDetector(_ContinuousStructure* CSX) except +
+            void SetPropertyType(int type)
+            int GetPropertyType()
+            void SetMetalEdgeResolution(double res)
+            double GetMetalEdgeResolution()
+            void SetFeatureAngle(double angle)
+            double GetFeatureAngle()
+            void SetTolerance(double tol)
+            double GetTolerance()
+            void SetRegion(const double* box)
+            bool Detect()
+            vector[double] GetLines(int ny)
+            size_t GetNumPrimitives()
+            size_t GetNumSkipped()
+            bool AddToGrid(_CSRectGrid* grid)
+
+cdef class CSEdgeDetector:
+    cdef _CSEdgeDetector *thisptr      # hold a C++ instance which we're wrapping
+    cdef readonly ContinuousStructure __CSX
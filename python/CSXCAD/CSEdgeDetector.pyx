@@ -0,0 +1,131 @@
+# -*- coding: utf-8 -*-
+#
+# Copyright (C) 2016 Thorsten Liebig (Thorsten.Liebig@gmx.de)
+#
+# This program is free software: you can redistribute it and/or modify
+# it under the terms of the GNU Lesser General Public License as published
+# by the Free Software Foundation, either version 3 of the License, or
+# (at your option) any later version.
+#
+# This program is distributed in the hope that it will be useful,
+# but WITHOUT ANY WARRANTY; without even the implied warranty of
+# MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+# GNU Lesser General Public License for more details.
+#
+# You should have received a copy of the GNU Lesser General Public License
+# along with this program.  If not, see <http://www.gnu.org/licenses/>.
+
+"""
+Detect the edges of all primitives of a structure as mesh seed lines.
+"""
+
+import numpy as np
+cimport CSEdgeDetector
+from CSRectGrid cimport CSRectGrid
+from Utilities import CheckNyDir
+
+cdef class CSEdgeDetector:
+    """
+    Detect the edges of all primitives of a structure and collect them as
+    mesh seed lines for each direction.
+
+    :param CSX: ContinuousStructure -- the structure to detect the edges of
+    """
+    def __cinit__(self, ContinuousStructure CSX, *args, **kw):
+        self.__CSX = CSX
+        self.thisptr = new _CSEdgeDetector(CSX.thisptr)
+
+    def __dealloc__(self):
+        del self.thisptr
+
+    def SetPropertyType(self, prop_type):
+        """ SetPropertyType(prop_type)
+
+        Set the property types to detect (bitmask).
+        """
+        self.thisptr.SetPropertyType(prop_type)
+
+    def GetPropertyType(self):
+        return self.thisptr.GetPropertyType()
+
+    def SetMetalEdgeResolution(self, res):
+        """ SetMetalEdgeResolution(res)
+
+        Set the resolution for the thirds rule at 2D metal edges, 0 disables the rule.
+        """
+        self.thisptr.SetMetalEdgeResolution(res)
+
+    def GetMetalEdgeResolution(self):
+        return self.thisptr.GetMetalEdgeResolution()
+
+    def SetFeatureAngle(self, angle):
+        """ SetFeatureAngle(angle)
+
+        Set the min. angle (in degree) between the normals of two faces of a
+        polyhedron to detect their common edge.
+        """
+        self.thisptr.SetFeatureAngle(angle)
+
+    def GetFeatureAngle(self):
+        return self.thisptr.GetFeatureAngle()
+
+    def SetTolerance(self, tol):
+        """ SetTolerance(tol)
+
+        Set the relative tolerance to merge lines.
+        """
+        self.thisptr.SetTolerance(tol)
+
+    def GetTolerance(self):
+        return self.thisptr.GetTolerance()
+
+    def SetRegion(self, box):
+        """ SetRegion(box)
+
+        Restrict the detection to the primitives intersecting the given box
+        (xmin, xmax, ymin, ymax, zmin, zmax), None removes the restriction.
+        """
+        if box is None:
+            self.thisptr.SetRegion(NULL)
+            return
+        assert len(box)==6, 'SetRegion: box must have 6 values'
+        cdef double _box[6]
+        for n in range(6):
+            _box[n] = box[n]
+        self.thisptr.SetRegion(_box)
+
+    def Detect(self):
+        """ Detect()
+
+        Detect the edges of all primitives.
+
+        :returns: bool -- False if the structure has no usable mesh type
+        """
+        return self.thisptr.Detect()
+
+    def GetLines(self, ny):
+        """ GetLines(ny)
+
+        :param ny: int or str -- direction definition
+        :returns: array -- sorted seed lines found by the last Detect()
+        """
+        ny = CheckNyDir(ny)
+        return np.array(self.thisptr.GetLines(ny))
+
+    def GetNumPrimitives(self):
+        return self.thisptr.GetNumPrimitives()
+
+    def GetNumSkipped(self):
+        return self.thisptr.GetNumSkipped()
+
+    def AddToGrid(self, grid=None):
+        """ AddToGrid(grid=None)
+
+        Add the seed lines to the given grid, the grid of the structure if None.
+        """
+        if grid is None:
+            return self.thisptr.AddToGrid(NULL)
+        return self._AddToGrid(grid)
+
+    def _AddToGrid(self, CSRectGrid grid):
+        return self.thisptr.AddToGrid(grid.thisptr)
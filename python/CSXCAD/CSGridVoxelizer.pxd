@@ -0,0 +1,37 @@
+# -*- coding: utf-8 -*-
+#
+# Copyright (C) 2016 Thorsten Liebig (Thorsten.Liebig@gmx.de)
+#
+# This program is free software: you can redistribute it and/or modify
+# it under the terms of the GNU Lesser General Public License as published
+# by the Free Software Foundation, either version 3 of the License, or
+# (at your option) any later version.
+#
+# This program is distributed in the hope that it will be useful,
+# but WITHOUT ANY WARRANTY; without even the implied warranty of
+# MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+# GNU Lesser General Public License for more details.
+#
+# You should have received a copy of the GNU Lesser General Public License
+# along with this program.  If not, see <http://www.gnu.org/licenses/>.
+
+from libcpp cimport bool
+
+from CSXCAD cimport _ContinuousStructure, ContinuousStructure
+from CSProperties cimport PropertyType
+
+cdef extern from "CSXCAD/CSGridVoxelizer.h":
+    cdef cppclass _CSGridVoxelizer "CSGridVoxelizer":
+            _CSGridVoxelizer(_ContinuousStructure* CSX) except +
+            void SetSampleAtCellCenter(bool val)
+            bool Voxelize(PropertyType prop_type)
+            bool VoxelizeRegions(const double* regions, size_t numRegions)
+            bool VoxelizeDirtyRegions()
+            unsigned int GetNumSamples(int ny)
+            const double* GetSamplePositions(int ny)
+            const int* GetPropertyIndexArray()
+            size_t GetNumInsideTests()
+
+cdef class CSGridVoxelizer:
+    cdef _CSGridVoxelizer *thisptr      # hold a C++ instance which we're wrapping
+    cdef readonly ContinuousStructure __CSX
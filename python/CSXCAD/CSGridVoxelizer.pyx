@@ -0,0 +1,116 @@
+# -*- coding: utf-8 -*-
+#
+# Copyright (C) 2016 Thorsten Liebig (Thorsten.Liebig@gmx.de)
+#
+# This program is free software: you can redistribute it and/or modify
+# it under the terms of the GNU Lesser General Public License as published
+# by the Free Software Foundation, either version 3 of the License, or
+# (at your option) any later version.
+#
+# This program is distributed in the hope that it will be useful,
+# but WITHOUT ANY WARRANTY; without even the implied warranty of
+# MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+# GNU Lesser General Public License for more details.
+#
+# You should have received a copy of the GNU Lesser General Public License
+# along with this program.  If not, see <http://www.gnu.org/licenses/>.
+
+"""
+Rasterize all primitives of a structure onto the sample points of its grid.
+"""
+
+import numpy as np
+cimport CSGridVoxelizer
+cimport CSProperties as c_CSProperties
+from libc.stdlib cimport malloc, free
+from Utilities import CheckNyDir
+
+cdef class CSGridVoxelizer:
+    """
+    Rasterize all primitives of a structure onto the sample points of its
+    rectilinear grid, the result is identical to
+    ContinuousStructure.GetPropertyByCoordPriority for each sample point.
+
+    :param CSX: ContinuousStructure -- the structure to rasterize
+    """
+    def __cinit__(self, ContinuousStructure CSX, *args, **kw):
+        self.__CSX = CSX
+        self.thisptr = new _CSGridVoxelizer(CSX.thisptr)
+
+    def __dealloc__(self):
+        del self.thisptr
+
+    def SetSampleAtCellCenter(self, val):
+        """ SetSampleAtCellCenter(val)
+
+        Sample at the cell centers (default) or at the grid lines.
+
+        :param val: bool -- sample at the cell centers
+        """
+        self.thisptr.SetSampleAtCellCenter(val)
+
+    def Voxelize(self, prop_type=c_CSProperties.ANY):
+        """ Voxelize(prop_type=ANY)
+
+        Rasterize all primitives with properties of the given type.
+        """
+        return self.thisptr.Voxelize(prop_type)
+
+    def VoxelizeRegions(self, regions):
+        """ VoxelizeRegions(regions)
+
+        Rasterize again only the sample points inside the given boxes.
+
+        :param regions: (N,6) array -- boxes as (x0, x1, y0, y1, z0, z1)
+        """
+        regions = np.asarray(regions, dtype=float).ravel()
+        assert len(regions)%6==0, 'VoxelizeRegions: regions must be given as 6 values each'
+        cdef size_t N = len(regions)
+        cdef double* _regions = <double*>malloc(max(N,1)*sizeof(double))
+        for n in range(N):
+            _regions[n] = regions[n]
+        ok = self.thisptr.VoxelizeRegions(_regions, N/6)
+        free(_regions)
+        return ok
+
+    def VoxelizeDirtyRegions(self):
+        """ VoxelizeDirtyRegions()
+
+        Rasterize again all regions changed by an update of the structure
+        since its dirty regions were cleared.
+        """
+        return self.thisptr.VoxelizeDirtyRegions()
+
+    def GetSamplePositions(self, ny):
+        """ GetSamplePositions(ny)
+
+        :param ny: int or str -- direction definition
+        :returns: array -- sample positions in the given direction
+        """
+        ny = CheckNyDir(ny)
+        N = self.thisptr.GetNumSamples(ny)
+        cdef const double* pos = self.thisptr.GetSamplePositions(ny)
+        return np.array([pos[n] for n in range(N)])
+
+    def GetPropertyIndices(self):
+        """ GetPropertyIndices()
+
+        Get the property index (see ContinuousStructure.GetProperty) of all
+        sample points, -1 if no property was found.
+
+        :returns: (Nx,Ny,Nz) int array
+        """
+        shape = [self.thisptr.GetNumSamples(n) for n in range(3)]
+        N = shape[0]*shape[1]*shape[2]
+        cdef const int* idx = self.thisptr.GetPropertyIndexArray()
+        out = np.zeros(N, dtype=int)
+        for n in range(N):
+            out[n] = idx[n]
+        # the x-index is running fastest
+        return out.reshape(shape[::-1]).transpose()
+
+    def GetNumInsideTests(self):
+        """
+        Get the number of inside tests done by the last voxelization.
+        """
+        return self.thisptr.GetNumInsideTests()
@@ -214,6 +214,9 @@ cdef extern from "CSXCAD/CSPrimPolyhedron.h":
             void AddFace(int numVertex, int* vertices)
             int* GetFace(unsigned int n, unsigned int &numVertices)
             unsigned int GetNumFaces()
+            void SetLazyBuild(bool val)
+            bool GetLazyBuild()
+            bool IsTreeValid()
 
 cdef class CSPrimPolyhedron(CSPrimitives):
     pass
@@ -224,12 +227,15 @@ cdef extern from "CSXCAD/CSPrimPolyhedronReader.h":
         UNKNOWN "CSPrimPolyhedronReader::UNKNOWN"
         STL_FILE "CSPrimPolyhedronReader::STL_FILE"
         PLY_FILE "CSPrimPolyhedronReader::PLY_FILE"
+        OBJ_FILE "CSPrimPolyhedronReader::OBJ_FILE"
     cdef cppclass _CSPrimPolyhedronReader "CSPrimPolyhedronReader" (_CSPrimPolyhedron):
         _CSPrimPolyhedronReader(_ParameterSet*, _CSProperties*) except +
         void SetFilename(string name)
         string GetFilename()
         void SetFileType(FileType ft)
         FileType GetFileType()
+        void SetCacheDirectory(string dir)
+        string GetCacheDirectory()
         bool ReadFile()
 
 cdef class CSPrimPolyhedronReader(CSPrimPolyhedron):
@@ -1104,6 +1104,35 @@ cdef class CSPrimPolyhedron(CSPrimitives):
         ptr = <_CSPrimPolyhedron*>self.thisptr
         ptr.Reset()
 
+    def SetLazyBuild(self, val):
+        """ SetLazyBuild(val)
+
+        Defer building the polyhedron tree from the update until the first
+        inside test, e.g. for imported parts that may never be used.
+
+        :param val: bool -- Enable or disable the lazy build
+        """
+        ptr = <_CSPrimPolyhedron*>self.thisptr
+        ptr.SetLazyBuild(val)
+
+    def GetLazyBuild(self):
+        """
+        Get the lazy build setting.
+
+        :returns val: bool -- Lazy build enabled
+        """
+        ptr = <_CSPrimPolyhedron*>self.thisptr
+        return ptr.GetLazyBuild()
+
+    def IsTreeValid(self):
+        """
+        Check if the polyhedron tree is build and up to date with the mesh.
+
+        :returns val: bool -- Tree is valid
+        """
+        ptr = <_CSPrimPolyhedron*>self.thisptr
+        return ptr.IsTreeValid()
+
     def AddVertex(self, x, y, z):
         """ AddVertex(x, y, z)
 
@@ -1189,12 +1218,14 @@ cdef class CSPrimPolyhedron(CSPrimitives):
 cdef class CSPrimPolyhedronReader(CSPrimPolyhedron):
     """ Polyhedron Reader
 
-    This primives creates a polyhedron by reading a STL or PLY file.
+    This primives creates a polyhedron by reading a STL, PLY or OBJ file.
 
     Parameters
     ----------
     filename : str
         File name to read
+    cache_dir : str
+        Directory to cache the processed geometry (optional)
     """
     def __init__(self, ParameterSet pset, CSProperties prop, *args, no_init=False, **kw):
         if no_init:
@@ -1205,6 +1236,9 @@ cdef class CSPrimPolyhedronReader(CSPrimPolyhedron):
         if 'filename' in kw:
             self.SetFilename(kw['filename'])
             del kw['filename']
+        if 'cache_dir' in kw:
+            self.SetCacheDirectory(kw['cache_dir'])
+            del kw['cache_dir']
         super(CSPrimPolyhedronReader, self).__init__(pset, prop, *args, **kw)
 
     def SetFilename(self, fn):
@@ -1219,6 +1253,8 @@ cdef class CSPrimPolyhedronReader(CSPrimPolyhedron):
             self.SetFileType(1)
         elif fn.endswith('.ply'):
             self.SetFileType(2)
+        elif fn.endswith('.obj'):
+            self.SetFileType(3)
         else:
             self.SetFileType(0)
         ptr.SetFilename(fn.encode('UTF-8'))
@@ -1235,7 +1271,7 @@ cdef class CSPrimPolyhedronReader(CSPrimPolyhedron):
     def SetFileType(self, t):
         """ SetFileType(t)
 
-        Set the file type. 1 --> STL-File, 2 --> PLY, 0 --> other/unknown
+        Set the file type. 1 --> STL-File, 2 --> PLY, 3 --> OBJ, 0 --> other/unknown
 
         :param t: int -- File type (see above)
         """
@@ -1244,13 +1280,34 @@ cdef class CSPrimPolyhedronReader(CSPrimPolyhedron):
 
     def GetFileType(self):
         """
-        Get the file type. 1 --> STL-File, 2 --> PLY, 0 --> other/unknown
+        Get the file type. 1 --> STL-File, 2 --> PLY, 3 --> OBJ, 0 --> other/unknown
 
         :return t: int -- File type (see above)
         """
         ptr = <_CSPrimPolyhedronReader*>self.thisptr
         return ptr.GetFileType()
 
+    def SetCacheDirectory(self, cache_dir):
+        """ SetCacheDirectory(cache_dir)
+
+        Set a directory to cache the processed geometry. A file read again
+        (e.g. during a parameter sweep) is loaded from the cache.
+        An empty string disables the cache (default).
+
+        :param cache_dir: str -- Cache directory
+        """
+        ptr = <_CSPrimPolyhedronReader*>self.thisptr
+        ptr.SetCacheDirectory(cache_dir.encode('UTF-8'))
+
+    def GetCacheDirectory(self):
+        """
+        Get the cache directory.
+
+        :returns cache_dir: str -- Cache directory
+        """
+        ptr = <_CSPrimPolyhedronReader*>self.thisptr
+        return ptr.GetCacheDirectory()
+
     def ReadFile(self):
         """
         Issue to read the file.
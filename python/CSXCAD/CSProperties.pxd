@@ -102,9 +102,28 @@ cdef extern from "CSXCAD/CSPropMaterial.h":
             void SetIsotropy(bool val)
             bool GetIsotropy()
 
+            void GetEpsilonWeighted(int ny, const double* coords, size_t n, double* out) nogil
+            void GetMueWeighted(int ny, const double* coords, size_t n, double* out) nogil
+            void GetKappaWeighted(int ny, const double* coords, size_t n, double* out) nogil
+            void GetSigmaWeighted(int ny, const double* coords, size_t n, double* out) nogil
+            void GetDensityWeighted(const double* coords, size_t n, double* out) nogil
+
 cdef class CSPropMaterial(CSProperties):
     pass
 
+##############################################################################
+cdef extern from "CSXCAD/CSPropDiscMaterial.h":
+    cdef cppclass _CSPropDiscMaterial "CSPropDiscMaterial" (_CSPropMaterial):
+            _CSPropDiscMaterial(_ParameterSet*) except +
+            bool ReadHDF5(string filename)
+            void SetLazyLoading(bool val)
+            bool GetLazyLoading()
+            void SetCacheMemoryBudget(size_t bytes)
+            size_t GetCacheMemoryBudget()
+
+cdef class CSPropDiscMaterial(CSPropMaterial):
+    pass
+
 ##############################################################################
 cdef extern from "CSXCAD/CSPropLumpedElement.h":
     cdef cppclass _CSPropLumpedElement "CSPropLumpedElement" (_CSProperties):
@@ -35,6 +35,7 @@ Create a metal property:
 """
 
 import numpy as np
+from libc.stdlib cimport malloc, free
 from ParameterObjects cimport _ParameterSet, ParameterSet
 cimport CSProperties
 cimport CSPrimitives as c_CSPrimitives
@@ -72,6 +73,8 @@ cdef class CSProperties:
             prop = CSPropMetal(pset, no_init=no_init, **kw)
         elif p_type == MATERIAL:
             prop = CSPropMaterial(pset, no_init=no_init, **kw)
+        elif p_type == DISCRETE_MATERIAL + MATERIAL:
+            prop = CSPropDiscMaterial(pset, no_init=no_init, **kw)
         elif p_type == LUMPED_ELEMENT:
             prop = CSPropLumpedElement(pset, no_init=no_init, **kw)
         elif p_type == EXCITATION:
@@ -96,6 +99,8 @@ cdef class CSProperties:
         prop = None
         if type_str=='Material':
             prop = CSPropMaterial(pset, no_init=no_init, **kw)
+        elif type_str=='DiscMaterial':
+            prop = CSPropDiscMaterial(pset, no_init=no_init, **kw)
         elif type_str=='LumpedElement':
             prop = CSPropLumpedElement(pset, no_init=no_init, **kw)
         elif type_str=='Metal':
@@ -588,6 +593,114 @@ cdef class CSPropMaterial(CSProperties):
         else:
             raise Exception('GetMaterialWeightDir: Error, unknown material property')
 
+    def GetMaterialPropertyWeighted(self, prop_name, coords, ny=0):
+        """ GetMaterialPropertyWeighted(prop_name, coords, ny=0)
+        Get the weighted material property at the given coordinates.
+
+        The evaluation does not hold the GIL, several threads may query the
+        same material at once.
+
+        :params prop_name: str -- material property type
+        :params coords: (N,3) array -- coordinates
+        :params ny: int or str -- direction (ignored for `density`)
+        :returns: (N,) array
+        """
+        coords = np.asarray(coords, dtype=float).reshape(-1, 3)
+        ny = CheckNyDir(ny)
+        cdef size_t N = coords.shape[0]
+        cdef int _ny = ny
+        cdef double* _coords = <double*>malloc(max(3*N,1)*sizeof(double))
+        cdef double* _out = <double*>malloc(max(N,1)*sizeof(double))
+        cdef _CSPropMaterial* mat = <_CSPropMaterial*>self.thisptr
+        # the coordinates are passed as x-, y- and z-array one after another
+        for n in range(N):
+            for d in range(3):
+                _coords[d*N+n] = coords[n,d]
+        if prop_name=='epsilon':
+            with nogil:
+                mat.GetEpsilonWeighted(_ny, _coords, N, _out)
+        elif prop_name=='mue':
+            with nogil:
+                mat.GetMueWeighted(_ny, _coords, N, _out)
+        elif prop_name=='kappa':
+            with nogil:
+                mat.GetKappaWeighted(_ny, _coords, N, _out)
+        elif prop_name=='sigma':
+            with nogil:
+                mat.GetSigmaWeighted(_ny, _coords, N, _out)
+        elif prop_name=='density':
+            with nogil:
+                mat.GetDensityWeighted(_coords, N, _out)
+        else:
+            free(_coords)
+            free(_out)
+            raise Exception('GetMaterialPropertyWeighted: Error, unknown material property')
+        out = np.array([_out[n] for n in range(N)])
+        free(_coords)
+        free(_out)
+        return out
+
+###############################################################################
+cdef class CSPropDiscMaterial(CSPropMaterial):
+    """ Discrete material property
+
+    The material values are read from a database (HDF5 file), which holds a
+    material index for every cell of a rectilinear mesh.
+
+    :params lazy_loading: bool -- keep the indizies on disk and load them on demand
+    :params cache_memory_budget: int -- memory budget in bytes for lazy loading
+    """
+    def __init__(self, ParameterSet pset, *args, no_init=False, **kw):
+        if no_init:
+            self.thisptr = NULL
+            return
+        if not self.thisptr:
+            self.thisptr = <_CSProperties*> new _CSPropDiscMaterial(pset.thisptr)
+
+        if 'lazy_loading' in kw:
+            self.SetLazyLoading(kw['lazy_loading'])
+            del kw['lazy_loading']
+        if 'cache_memory_budget' in kw:
+            self.SetCacheMemoryBudget(kw['cache_memory_budget'])
+            del kw['cache_memory_budget']
+
+        super(CSPropDiscMaterial, self).__init__(pset, *args, **kw)
+
+    def ReadHDF5(self, filename):
+        """ ReadHDF5(filename)
+
+        Read the discrete material database.
+
+        :param filename: str -- HDF5 file name
+        :returns: bool -- True on success
+        """
+        return (<_CSPropDiscMaterial*>self.thisptr).ReadHDF5(filename.encode('UTF-8'))
+
+    def SetLazyLoading(self, val):
+        """ SetLazyLoading(val)
+
+        Keep the database indizies on disk and load them on demand, must be
+        set before reading the file.
+
+        :param val: bool -- enable/disable lazy loading
+        """
+        (<_CSPropDiscMaterial*>self.thisptr).SetLazyLoading(val)
+
+    def GetLazyLoading(self):
+        return (<_CSPropDiscMaterial*>self.thisptr).GetLazyLoading()
+
+    def SetCacheMemoryBudget(self, val):
+        """ SetCacheMemoryBudget(val)
+
+        Set the memory budget for lazy loaded database indizies.
+
+        :param val: int -- memory budget in bytes
+        """
+        (<_CSPropDiscMaterial*>self.thisptr).SetCacheMemoryBudget(val)
+
+    def GetCacheMemoryBudget(self):
+        return (<_CSPropDiscMaterial*>self.thisptr).GetCacheMemoryBudget()
+
 
 ###############################################################################
 cdef class CSPropLumpedElement(CSProperties):
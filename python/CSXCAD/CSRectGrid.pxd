@@ -18,6 +18,7 @@
 
 from libcpp.string cimport string
 from libcpp cimport bool
+from libcpp.vector cimport vector
 
 cdef extern from "CSXCAD/CSXCAD_Global.h":
     cpdef enum CoordinateSystem "CoordinateSystem":
@@ -26,9 +27,21 @@ cdef extern from "CSXCAD/CSXCAD_Global.h":
         UNDEFINED_CS "UNDEFINED_CS"
 
 cdef extern from "CSXCAD/CSRectGrid.h":
+        cdef cppclass _MeshQuality "CSRectGrid::MeshQuality":
+            unsigned int numLines
+            double minRes
+            double maxRes
+            double maxRatio
+            unsigned int maxRatioLine
+            bool homogeneous
+            bool symmetric
+            vector[unsigned int] violationLines
+            vector[int] violationTypes
+
         cdef cppclass _CSRectGrid "CSRectGrid":
             _CSRectGrid() except +
             void AddDiscLine(int direct, double val)
+            size_t MergeLines(int direct, const double* vals, size_t numLines, double tol)
 
             void clear()
             void ClearLines(int direct)
@@ -42,12 +55,16 @@ cdef extern from "CSXCAD/CSRectGrid.h":
             double GetLine(int direct, size_t Index)
 
             unsigned int Snap2LineNumber(int ny, double value, bool &inside)
+            bool Snap2LineNumbers(int ny, const double* vals, size_t n, unsigned int* out, bool* inside)
 
             int GetDimension()
             void SetMeshType(CoordinateSystem cs_type)
             CoordinateSystem GetMeshType()
 
             void IncreaseResolution(int nu, int factor)
+            bool SmoothMeshLines(int direct, double max_res, double ratio)
+            bool AnalyseMesh(int direct, _MeshQuality &quality, double min_res, double max_res, double ratio)
+            double GetTimestepCFL()
             double* GetSimArea()
             bool isValid()
 
@@ -22,8 +22,8 @@ Rectilinear Grid Class for CSXCAD
 
 import numpy as np
 cimport CSRectGrid
+from libc.stdlib cimport malloc, free
 from Utilities import CheckNyDir
-from SmoothMeshLines import SmoothMeshLines
 
 cdef class CSRectGrid:
     """
@@ -78,8 +78,7 @@ cdef class CSRectGrid:
 
         assert len(lines)>0, 'SetLines: "lines" must be an array or list'
         self.thisptr.ClearLines(ny)
-        for n in range(len(lines)):
-            self.thisptr.AddDiscLine(ny, lines[n])
+        self.MergeLines(ny, lines)
 
     def AddLine(self, ny, line):
         """ AddLine(ny, lines)
@@ -95,8 +94,28 @@ cdef class CSRectGrid:
             self.thisptr.AddDiscLine(ny, line)
             return
         assert len(line)>0, 'AddLine: "lines" must be a float, array or list'
-        for n in range(len(line)):
-            self.thisptr.AddDiscLine(ny, line[n])
+        self.MergeLines(ny, line)
+
+    def MergeLines(self, ny, lines, tol=0):
+        """ MergeLines(ny, lines, tol=0)
+
+        Merge an array of lines into the sorted lines of the given direction.
+        New lines closer than `tol` to any other line are dropped.
+
+        :param ny: int or str -- direction definition
+        :param lines: array -- list of lines to be merged
+        :param tol: float -- merge tolerance
+        :returns: int -- number of lines added
+        """
+        ny = CheckNyDir(ny)
+        lines = np.asarray(lines, dtype=float).ravel()
+        cdef size_t N = len(lines)
+        cdef double* vals = <double*>malloc(N*sizeof(double))
+        for n in range(N):
+            vals[n] = lines[n]
+        added = self.thisptr.MergeLines(ny, vals, N, tol)
+        free(vals)
+        return added
 
     def GetQtyLines(self, ny):
         """ GetQtyLines(ny)
@@ -157,9 +176,46 @@ cdef class CSRectGrid:
             for n in range(3):
                 self.SmoothMeshLines(n, max_res, ratio)
         else:
-            lines = self.GetLines(ny)
-            lines = SmoothMeshLines(lines, max_res, ratio)
-            self.SetLines(ny, lines)
+            ny = CheckNyDir(ny)
+            self.thisptr.SmoothMeshLines(ny, max_res, ratio)
+
+    def AnalyseMesh(self, ny, min_res=0, max_res=0, ratio=0):
+        """ AnalyseMesh(ny, min_res=0, max_res=0, ratio=0)
+
+        Analyse the mesh lines in the given direction and check them for
+        violations of the given limits. A limit of 0 disables the check.
+
+        Violation types: 1: cell larger than max_res, 2: cell smaller than min_res,
+        3/4: increase/decrease of neighboring cells larger than ratio.
+
+        :param ny: int or str -- direction definition
+        :param min_res: float -- min. allowed resolution
+        :param max_res: float -- max. allowed resolution
+        :param ratio:   float -- max. allowed ratio of neighboring cells
+        :returns: dict -- numLines, min_res, max_res, max_ratio, max_ratio_line, homogeneous, symmetric, violation_lines and violation_types
+        """
+        ny = CheckNyDir(ny)
+        cdef _MeshQuality q
+        self.thisptr.AnalyseMesh(ny, q, min_res, max_res, ratio)
+        results = {}
+        results['numLines']        = q.numLines
+        results['min_res']         = q.minRes
+        results['max_res']         = q.maxRes
+        results['max_ratio']       = q.maxRatio
+        results['max_ratio_line']  = q.maxRatioLine
+        results['homogeneous']     = q.homogeneous
+        results['symmetric']       = q.symmetric
+        results['violation_lines'] = np.array(q.violationLines, dtype=int)
+        results['violation_types'] = np.array(q.violationTypes, dtype=int)
+        return results
+
+    def GetTimestepCFL(self):
+        """ GetTimestepCFL()
+
+        Estimate the max. stable FDTD timestep (in seconds) of this mesh, based on
+        the smallest cell size in each direction and the drawing unit.
+        """
+        return self.thisptr.GetTimestepCFL()
 
     def Clear(self):
         """
@@ -202,6 +258,36 @@ cdef class CSRectGrid:
         pos = self.thisptr.Snap2LineNumber(ny, value, inside)
         return pos, inside>0
 
+    def Snap2LineNumbers(self, ny, values):
+        """ Snap2LineNumbers(ny, values)
+
+        Find the fitting mesh line indices for the given direction and an array of values.
+        Sorted values are snapped in a single pass over the mesh lines.
+
+        :param ny: int or str -- direction definition
+        :param values: array -- values to snap
+        :returns: (indices, inside) -- int and bool arrays
+        """
+        ny = CheckNyDir(ny)
+        values = np.asarray(values, dtype=float).ravel()
+        cdef size_t N = len(values)
+        cdef double* vals = <double*>malloc(N*sizeof(double))
+        cdef unsigned int* out = <unsigned int*>malloc(N*sizeof(unsigned int))
+        cdef bool* inside = <bool*>malloc(N*sizeof(bool))
+        for n in range(N):
+            vals[n] = values[n]
+        ok = self.thisptr.Snap2LineNumbers(ny, vals, N, out, inside)
+        pos = np.zeros(N, dtype=int)
+        ins = np.zeros(N, dtype=np.bool_)
+        for n in range(N):
+            pos[n] = out[n]
+            ins[n] = inside[n]
+        free(vals)
+        free(out)
+        free(inside)
+        assert ok, 'Snap2LineNumbers: no mesh lines in the given direction'
+        return pos, ins
+
     def GetSimArea(self):
         """
         Get the simulation area as defined by the mesh.
@@ -40,6 +40,10 @@ cdef extern from "CSXCAD/ContinuousStructure.h":
             void SetCoordInputType(CoordinateSystem cs_type)
 
             void AddProperty(_CSProperties* prop)
+            void DeleteProperty(_CSProperties* prop)
+            void BeginTransaction()
+            void CommitTransaction()
+            bool InTransaction()
             _CSProperties* GetProperty(int index)
             int GetQtyPrimitives(PropertyType prop_type)
             int  GetQtyProperties()
@@ -53,11 +57,21 @@ cdef extern from "CSXCAD/ContinuousStructure.h":
 
             string Update()
 
+            void SetUseCompiledScene(bool val)
+            bool GetUseCompiledScene()
+            void SetTrackDirtyRegions(bool val)
+            bool GetTrackDirtyRegions()
+            void ClearDirtyRegions()
+
+            void SetNumberOfThreads(unsigned int val)
+            unsigned int GetNumberOfThreads()
+
 cdef class ContinuousStructure:
     cdef _ContinuousStructure *thisptr      # hold a C++ instance which we're wrapping
     cdef readonly ParameterSet __paraset
     cdef readonly CSRectGrid   __grid
     cdef _AddProperty(self, CSProperties prop)
+    cdef _DeleteProperty(self, CSProperties prop)
     cdef _GetProperty(self, int index)
     cdef __GetPropertyByCoordPriority(self, double* coord, PropertyType prop_type, bool markFoundAsUsed)
     cdef __GetAllPrimitives(self, bool sort, PropertyType prop_type)
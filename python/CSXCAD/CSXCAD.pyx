@@ -95,6 +95,70 @@ cdef class ContinuousStructure:
     def Update(self):
         return self.thisptr.Update().decode('UTF-8')
 
+    def SetUseCompiledScene(self, val):
+        """ SetUseCompiledScene(val)
+
+        Enable or disable the use of a compiled snapshot of all primitives
+        for all coordinate queries. The snapshot is (re-)compiled by Update().
+
+        :param val: bool -- Enable or disable the compiled snapshot
+        """
+        self.thisptr.SetUseCompiledScene(val)
+
+    def GetUseCompiledScene(self):
+        return self.thisptr.GetUseCompiledScene()
+
+    def SetTrackDirtyRegions(self, val):
+        """ SetTrackDirtyRegions(val)
+
+        Enable or disable the tracking of regions changed by Update(),
+        e.g. to rasterize only the changed regions again.
+
+        See Also
+        --------
+        CSXCAD.CSGridVoxelizer.CSGridVoxelizer.VoxelizeDirtyRegions
+        """
+        self.thisptr.SetTrackDirtyRegions(val)
+
+    def GetTrackDirtyRegions(self):
+        return self.thisptr.GetTrackDirtyRegions()
+
+    def ClearDirtyRegions(self):
+        """ ClearDirtyRegions()
+
+        Clear all regions changed by Update() so far.
+        """
+        self.thisptr.ClearDirtyRegions()
+
+    def SetNumberOfThreads(self, val):
+        """ SetNumberOfThreads(val)
+
+        Set the number of threads used for parallel tasks, 0 (default) will
+        use all available cores.
+        """
+        self.thisptr.SetNumberOfThreads(val)
+
+    def GetNumberOfThreads(self):
+        return self.thisptr.GetNumberOfThreads()
+
+    def BeginTransaction(self):
+        """ BeginTransaction()
+
+        Start adding many properties at once. The properties are not updated
+        and the property IDs are not renumbered until CommitTransaction().
+        """
+        self.thisptr.BeginTransaction()
+
+    def CommitTransaction(self):
+        """ CommitTransaction()
+
+        Renumber the property IDs and update all properties added since BeginTransaction().
+        """
+        self.thisptr.CommitTransaction()
+
+    def InTransaction(self):
+        return self.thisptr.InTransaction()
+
     def Write2XML(self, fn):
         """ Write2XML(fn)
 
@@ -176,6 +240,17 @@ cdef class ContinuousStructure:
         """
         return self.__CreateProperty('Material', name, **kw)
 
+    def AddDiscMaterial(self, name, **kw):
+        """ AddDiscMaterial(name, **kw)
+
+        Add a discrete material property with name `name`.
+
+        See Also
+        --------
+        CSXCAD.CSProperties.CSPropDiscMaterial
+        """
+        return self.__CreateProperty('DiscMaterial', name, **kw)
+
     def AddLumpedElement(self, name, **kw):
         """ AddLumpedElement(name, **kw)
 
@@ -266,6 +341,22 @@ cdef class ContinuousStructure:
         prop.__CSX = self
         self.thisptr.AddProperty(prop.thisptr)
 
+    def DeleteProperty(self, prop):
+        """ DeleteProperty(prop)
+
+        Delete the property including all its primitives. The IDs of all
+        following properties are renumbered.
+
+        Notes
+        -----
+        The given property must not be used afterwards.
+        """
+        self._DeleteProperty(prop)
+
+    cdef _DeleteProperty(self, CSProperties prop):
+        self.thisptr.DeleteProperty(prop.thisptr)
+        prop.thisptr = NULL
+
     def GetProperty(self, index):
         """ GetProperty(index)
 
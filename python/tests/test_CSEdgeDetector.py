@@ -0,0 +1,67 @@
+# -*- coding: utf-8 -*-
+"""
+Created on Sat Apr  9 15:02:31 2016
+
+@author: thorsten
+"""
+
+import numpy as np
+
+from CSXCAD.CSXCAD import ContinuousStructure
+from CSXCAD.CSEdgeDetector import CSEdgeDetector
+
+import unittest
+
+class Test_CSEdgeDetector(unittest.TestCase):
+    def setUp(self):
+        self.csx = ContinuousStructure()
+        self.metal = self.csx.AddMetal('metal')
+
+    def test_boxes(self):
+        for n in range(8):
+            self.metal.AddBox([n, 0, 0], [n+0.5, 1, 2])
+        self.csx.Update()
+
+        # the result must not depend on the number of threads
+        for num in [1, 3, 0, 100]:
+            self.csx.SetNumberOfThreads(num)
+            ed = CSEdgeDetector(self.csx)
+            self.assertTrue( ed.Detect() )
+            self.assertEqual( ed.GetNumPrimitives(), 8 )
+            self.assertEqual( ed.GetNumSkipped(), 0 )
+            self.assertTrue( np.allclose(ed.GetLines('x'), np.sort(np.r_[np.arange(8), np.arange(8)+0.5])) )
+            self.assertTrue( np.allclose(ed.GetLines('y'), [0, 1]) )
+            self.assertTrue( np.allclose(ed.GetLines('z'), [0, 2]) )
+
+    def test_polyhedron(self):
+        # flat closed bipyramid, the rim edges are knife edges with (almost) opposite face normals
+        ph = self.metal.AddPolyhedron()
+        ph.AddVertex(-10, -10, 0)
+        ph.AddVertex( 10, -10, 0)
+        ph.AddVertex( 10,  10, 0)
+        ph.AddVertex(-10,  10, 0)
+        ph.AddVertex(  0,   0, 0.1)  # top center
+        ph.AddVertex(  0,   0,-0.1)  # bottom center
+        for n in range(4):
+            ph.AddFace([4, n, (n+1)%4])
+            ph.AddFace([5, (n+1)%4, n])
+        # invalid faces must be ignored
+        ph.AddFace([0, 1, 99])
+        ph.AddFace([-1, 2, 3])
+        self.csx.Update()
+
+        ed = CSEdgeDetector(self.csx)
+        self.assertTrue( ed.Detect() )
+        self.assertEqual( ed.GetNumSkipped(), 0 )
+        self.assertTrue( np.allclose(ed.GetLines('x'), [-10, 10]) )
+        self.assertTrue( np.allclose(ed.GetLines('y'), [-10, 10]) )
+        self.assertTrue( np.allclose(ed.GetLines('z'), [0]) )
+
+    def test_empty(self):
+        ed = CSEdgeDetector(self.csx)
+        self.assertTrue( ed.Detect() )
+        self.assertEqual( ed.GetNumPrimitives(), 0 )
+        self.assertEqual( len(ed.GetLines('x')), 0 )
+
+if __name__ == '__main__':
+    unittest.main()
@@ -0,0 +1,77 @@
+# -*- coding: utf-8 -*-
+"""
+Created on Sun Apr  3 12:41:07 2016
+
+@author: thorsten
+"""
+
+import numpy as np
+
+from CSXCAD.CSXCAD import ContinuousStructure
+from CSXCAD.CSGridVoxelizer import CSGridVoxelizer
+
+import unittest
+
+class Test_CSGridVoxelizer(unittest.TestCase):
+    def setUp(self):
+        self.csx = ContinuousStructure()
+        grid = self.csx.GetGrid()
+        grid.SetLines('x', np.linspace(-10, 10, 11))
+        grid.SetLines('y', np.linspace(-10, 10, 11))
+        grid.SetLines('z', np.linspace(-10, 10, 5))
+
+        self.props = []
+        for n in range(4):
+            metal = self.csx.AddMetal('metal_{}'.format(n))
+            metal.AddBox([-8+4*n, -8, -10], [-2+4*n, 8, 10], priority=n)
+            self.props.append(metal)
+        self.csx.Update()
+
+    def check_voxelizer(self, vox):
+        ref = CSGridVoxelizer(self.csx)
+        self.assertTrue( ref.Voxelize() )
+        self.assertTrue( (vox.GetPropertyIndices()==ref.GetPropertyIndices()).all() )
+
+        # compare the property names with a direct lookup at all sample points
+        idx = vox.GetPropertyIndices()
+        pos = [vox.GetSamplePositions(n) for n in range(3)]
+        for i, x in enumerate(pos[0]):
+            for j, y in enumerate(pos[1]):
+                for k, z in enumerate(pos[2]):
+                    prop = self.csx.GetPropertyByCoordPriority([x, y, z])
+                    if prop is None:
+                        self.assertEqual( idx[i,j,k], -1 )
+                    else:
+                        self.assertEqual( self.csx.GetProperty(idx[i,j,k]).GetName(), prop.GetName() )
+
+    def test_voxelize(self):
+        vox = CSGridVoxelizer(self.csx)
+        self.assertTrue( vox.Voxelize() )
+        self.assertEqual( vox.GetPropertyIndices().shape, (10, 10, 4) )
+        self.assertTrue( (vox.GetPropertyIndices()>=0).any() )
+        self.assertTrue( (vox.GetPropertyIndices()==-1).any() )
+        self.check_voxelizer(vox)
+
+    def test_delete_property(self):
+        vox = CSGridVoxelizer(self.csx)
+        self.assertTrue( vox.Voxelize() )
+
+        self.csx.SetTrackDirtyRegions(True)
+        self.csx.ClearDirtyRegions()
+        self.csx.DeleteProperty(self.props[1])
+        self.csx.Update()
+
+        # all following properties were renumbered, the incremental update must not use stale indices
+        self.assertTrue( vox.VoxelizeDirtyRegions() )
+        self.check_voxelizer(vox)
+
+        # adding a property keeps all IDs valid
+        self.csx.ClearDirtyRegions()
+        metal = self.csx.AddMetal('metal_new')
+        metal.AddBox([-4, -4, -10], [4, 4, 10], priority=10)
+        self.csx.Update()
+        self.assertTrue( vox.VoxelizeDirtyRegions() )
+        self.check_voxelizer(vox)
+
+if __name__ == '__main__':
+    unittest.main()
@@ -164,6 +164,19 @@ class Test_CSPrimMethods(unittest.TestCase):
         poly.SetElevation(0.123)
         self.assertTrue( poly.GetElevation()==0.123 )
 
+        # regular 64-gon, the inside test after Update() only checks the edges of one band
+        phi = np.linspace(0, 2*np.pi, 64, endpoint=False)
+        poly.SetCoords(np.cos(phi), np.sin(phi))
+        self.assertTrue( poly.Update() )
+        for a in np.linspace(0, 2*np.pi, 37):
+            self.assertTrue ( poly.IsInside([0.95*np.cos(a), 0.95*np.sin(a), 0.123]) )
+            self.assertFalse( poly.IsInside([1.05*np.cos(a), 1.05*np.sin(a), 0.123]) )
+        self.assertFalse( poly.IsInside([0.9, 0.9, 0.123]) )
+        self.assertFalse( poly.IsInside([0, np.nan, 0.123]) )
+        self.assertFalse( poly.IsInside([np.nan, 0, 0.123]) )
+        self.assertFalse( poly.IsInside([0, 0, np.nan]) )
+        self.assertFalse( poly.IsInside([0, np.inf, 0.123]) )
+
     def test_lin_poly(self):
         # Test Lin-Polygon
         linpoly = CSPrimitives.CSPrimLinPoly(self.pset, self.metal)
@@ -287,9 +300,25 @@ class Test_CSPrimMethods(unittest.TestCase):
         self.assertEqual(ph.GetNumFaces()   , 6)
 
         ph.Update()
+        self.assertTrue (ph.IsTreeValid())
         self.assertTrue (ph.IsInside([x0+width/4, y0+width/4, z0+height/2]))
         self.assertFalse(ph.IsInside([x0        , y0        , z0+height/2]))
 
+        # lazy build, the tree is build by the first inside test
+        self.assertFalse(ph.GetLazyBuild())
+        ph_lazy = CSPrimitives.CSPrimPolyhedron(self.pset, self.metal)
+        ph_lazy.SetLazyBuild(True)
+        self.assertTrue (ph_lazy.GetLazyBuild())
+        for n in range(ph.GetNumVertices()):
+            ph_lazy.AddVertex(*ph.GetVertex(n))
+        for n in range(ph.GetNumFaces()):
+            ph_lazy.AddFace(ph.GetFace(n))
+        ph_lazy.Update()
+        self.assertFalse(ph_lazy.IsTreeValid())
+        self.assertTrue (ph_lazy.IsInside([x0+width/4, y0+width/4, z0+height/2]))
+        self.assertTrue (ph_lazy.IsTreeValid())
+        self.assertFalse(ph_lazy.IsInside([x0        , y0        , z0+height/2]))
+
     def test_polyhedron_reader(self):
         ## Test CSPrimPolyhedronReader
         phr = CSPrimitives.CSPrimPolyhedronReader(self.pset, self.metal)
@@ -0,0 +1,71 @@
+# -*- coding: utf-8 -*-
+
+import os
+import tempfile
+import threading
+import numpy as np
+
+from CSXCAD.CSXCAD import ContinuousStructure
+
+import unittest
+
+try:
+    import h5py
+except ImportError:
+    h5py = None
+
+@unittest.skipIf(h5py is None, 'h5py is required to write the material database')
+class Test_CSPropDiscMaterial(unittest.TestCase):
+    def setUp(self):
+        self.shape = (33, 45, 70) # z, y, x
+        self.index = (np.arange(np.prod(self.shape))*7 % 5).astype(np.uint8).reshape(self.shape)
+        self.epsR = np.array([1, 2, 3, 4, 5], dtype=np.float32)
+
+        fd, self.fn = tempfile.mkstemp(suffix='.h5')
+        os.close(fd)
+        with h5py.File(self.fn, 'w') as f:
+            f.attrs['Version'] = 2.0
+            # a chunked dataset is read brick-wise, a contiguous one would be memory mapped
+            ds = f.create_dataset('DiscData', data=self.index, chunks=(8, 16, 32))
+            ds.attrs['DB_Size'] = np.int32(len(self.epsR))
+            ds.attrs['epsR'] = self.epsR
+            for n, name in enumerate(['x', 'y', 'z']):
+                f.create_dataset('mesh/'+name, data=np.arange(self.shape[2-n]+1, dtype=np.float32)*0.1)
+
+    def tearDown(self):
+        os.remove(self.fn)
+
+    def test_lazy_loading_threaded(self):
+        csx = ContinuousStructure()
+        eager = csx.AddDiscMaterial('eager')
+        self.assertTrue( eager.ReadHDF5(self.fn) )
+        lazy = csx.AddDiscMaterial('lazy', lazy_loading=True, cache_memory_budget=5000)
+        self.assertTrue( lazy.GetLazyLoading() )
+        self.assertEqual( lazy.GetCacheMemoryBudget(), 5000 )
+        self.assertTrue( lazy.ReadHDF5(self.fn) )
+
+        # the cell centers of a few cells
+        ijk = np.array([[0, 0, 0], [69, 44, 32], [35, 20, 10], [5, 40, 30]])
+        ref = self.epsR[self.index[ijk[:,2], ijk[:,1], ijk[:,0]]]
+        coords = (ijk+0.5)*0.1
+        self.assertTrue( (eager.GetMaterialPropertyWeighted('epsilon', coords)==ref).all() )
+        self.assertTrue( (lazy.GetMaterialPropertyWeighted('epsilon', coords)==ref).all() )
+
+        # several threads reading all over the volume, the small budget evicts bricks all the time
+        num_threads = 8
+        results = [None]*num_threads
+        def worker(t):
+            rng = np.random.RandomState(t)
+            coords = rng.uniform([-0.1, -0.1, -0.1], [7.1, 4.6, 3.4], size=(20000, 3))
+            results[t] = (eager.GetMaterialPropertyWeighted('epsilon', coords),
+                          lazy.GetMaterialPropertyWeighted('epsilon', coords))
+        threads = [threading.Thread(target=worker, args=(t,)) for t in range(num_threads)]
+        for t in threads:
+            t.start()
+        for t in threads:
+            t.join()
+        for t in range(num_threads):
+            self.assertTrue( (results[t][0]==results[t][1]).all() )
+
+if __name__ == '__main__':
+    unittest.main()
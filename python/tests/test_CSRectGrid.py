@@ -27,8 +27,8 @@ class Test_CSRectGrid(unittest.TestCase):
         grid.AddLine('y',4)
         self.assertEqual( grid.GetQtyLines('y'), 4 )
         grid.AddLine('y',[4, 2, 5])
-        self.assertEqual( grid.GetQtyLines('y'), 7 )
-        self.assertTrue( (grid.GetLines('y')==np.array([-2.,  0.,  1.,  4.,  4., 2.,  5.])).all() )  # check unsorted lines
+        self.assertEqual( grid.GetQtyLines('y'), 6 )
+        self.assertTrue( (grid.GetLines('y')==np.array([-2.,  0.,  1.,  2.,  4.,  5.])).all() )  # lines are always sorted
         grid.Sort('y')
         self.assertTrue( (grid.GetLines('y')==np.array([-2.,  0.,  1.,  2.,  4.,  5.])).all() )
         self.assertEqual( grid.GetQtyLines('y'), 6 )
@@ -55,8 +55,41 @@ class Test_CSRectGrid(unittest.TestCase):
         self.assertEqual(  grid.Snap2LineNumber('y', -2.0), (0,True) )
         self.assertEqual(  grid.Snap2LineNumber('y', -2.01), (0,False) )
 
+        pos, inside = grid.Snap2LineNumbers('y', [-2.01, -2.0, 1, 1.1, 1.5, 1.6, 5.0, 5.01, 1])
+        self.assertTrue( (pos==np.array([0, 0, 2, 2, 3, 3, 5, 5, 2])).all() )
+        self.assertTrue( (inside==np.array([False, True, True, True, True, True, True, False, True])).all() )
+        pos, inside = grid.Snap2LineNumbers('y', [1.1, np.nan, 1.6, -np.inf, np.nan])
+        self.assertTrue( (pos==np.array([2, 5, 3, 0, 5])).all() )
+        self.assertTrue( (inside==np.array([True, False, True, False, False])).all() )
+        self.assertEqual( grid.Snap2LineNumber('y', np.nan), (5, False) )
+
+        self.assertEqual( grid.MergeLines('y', [np.nan, 3, np.inf, 3, -np.inf], tol=0), 1 )
+        grid.AddLine('y', np.nan)
+        self.assertTrue( (grid.GetLines('y')==np.array([-2, 0, 1, 2, 3, 4, 5])).all() )
+        grid.SetLines('y', [-2, 0, 1, 2, 4, 5])
+        self.assertEqual( grid.MergeLines('y', [0.5, 2.05, 5.2], tol=0.1), 2 )
+        self.assertTrue( (grid.GetLines('y')==np.array([-2.,  0.,  0.5,  1.,  2.,  4.,  5.,  5.2])).all() )
+        grid.SetLines('y', [-2, 0, 1, 2, 4, 5])
+
         self.assertTrue( (grid.GetSimArea() == np.array([[0, -2, 10],[2, 5, 12]])).all() )
 
+        # check mesh analysis
+        grid.SetLines('z', [0, 1, 2, 3, 5, 5.5, 6, 7, 8])
+        res = grid.AnalyseMesh('z', min_res=0.6, max_res=1.5, ratio=1.5)
+        self.assertEqual( res['numLines'], 9 )
+        self.assertEqual( res['min_res'], 0.5 )
+        self.assertEqual( res['max_res'], 2 )
+        self.assertEqual( res['max_ratio'], 4 )
+        self.assertEqual( res['max_ratio_line'], 4 )
+        self.assertFalse( res['homogeneous'] )
+        self.assertTrue( (res['violation_lines']==np.array([3, 3, 4, 4, 5, 6])).all() )
+        self.assertTrue( (res['violation_types']==np.array([1, 3, 2, 4, 2, 3])).all() )
+        grid.SetLines('z', [10, 11, 12])
+        res = grid.AnalyseMesh('z')
+        self.assertTrue( res['homogeneous'] and res['symmetric'] )
+        self.assertEqual( len(res['violation_lines']), 0 )
+        self.assertAlmostEqual( grid.GetTimestepCFL()/(1e-3/299792458/np.sqrt(3)), 1 )  # cylindrical mesh, smallest radius 1
+
         grid.ClearLines('x')
         self.assertEqual( grid.GetQtyLines('x'), 0 )
         self.assertEqual( grid.GetQtyLines('y'), 6 )
@@ -69,5 +102,52 @@ class Test_CSRectGrid(unittest.TestCase):
 
         self.assertFalse( grid.IsValid() )
 
+    def test_smooth_mesh_lines(self):
+        grid = CSRectGrid.CSRectGrid(CoordSystem=0)
+        max_res = 2.0
+        ratio   = 1.4
+
+        # max. resolution, graded neighbors and all original lines kept (gaps below max_res are not refined)
+        org = np.array([0, 0.5, 10, 30])
+        grid.SetLines('x', org)
+        grid.SmoothMeshLines('x', max_res, ratio)
+        lines = grid.GetLines('x')
+        d = np.diff(lines)
+        self.assertTrue( (d>0).all() )
+        self.assertTrue( d.max()<=max_res*(1+1e-9) )
+        self.assertTrue( (np.maximum(d[1:]/d[:-1], d[:-1]/d[1:])<=ratio*(1+1e-9)).all() )
+        for l in org:
+            self.assertTrue( np.isclose(lines, l, rtol=0, atol=1e-12).any() )
+
+        # a symmetric mesh stays symmetric
+        org = np.array([-10, -3, -0.5, 0.5, 3, 10])
+        grid.SetLines('y', org)
+        grid.SmoothMeshLines('y', max_res, ratio)
+        lines = grid.GetLines('y')
+        self.assertTrue( np.allclose(lines, -lines[::-1], rtol=0, atol=1e-12) )
+        d = np.diff(lines)
+        self.assertTrue( d.max()<=max_res*(1+1e-9) )
+        self.assertTrue( (np.maximum(d[1:]/d[:-1], d[:-1]/d[1:])<=ratio*(1+1e-9)).all() )
+        for l in org:
+            self.assertTrue( np.isclose(lines, l, rtol=0, atol=1e-12).any() )
+
+        # symmetric without a center line, the small middle cell limits the resolution next to it
+        for org in [np.array([-100, -1, 1, 100]), np.array([-100, -0.5, 0.5, 100])]:
+            grid.SetLines('y', org)
+            grid.SmoothMeshLines('y', 10, 1.5)
+            lines = grid.GetLines('y')
+            self.assertTrue( np.allclose(lines, -lines[::-1], rtol=0, atol=1e-12) )
+            d = np.diff(lines)
+            self.assertTrue( d.max()<=10*(1+1e-9) )
+            self.assertTrue( (np.maximum(d[1:]/d[:-1], d[:-1]/d[1:])<=1.5*(1+1e-9)).all() )
+
+        # symmetric with a center line
+        grid.SetLines('z', [-5, 0, 0.5, 5])
+        grid.AddLine('z', -0.5)
+        grid.SmoothMeshLines('z', max_res, ratio)
+        lines = grid.GetLines('z')
+        self.assertTrue( np.allclose(lines, -lines[::-1], rtol=0, atol=1e-12) )
+        self.assertTrue( np.diff(lines).max()<=max_res*(1+1e-9) )
+
 if __name__ == '__main__':
     unittest.main()
\ No newline at end of file
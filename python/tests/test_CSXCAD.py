@@ -42,6 +42,49 @@ assert exc.GetName()=='excite'
 assert exc.GetExcitType() == 0
 assert (exc.GetExcitation()==exc_val).all()
 
+##### Test adding many properties at once
+csx.BeginTransaction()
+assert csx.InTransaction()
+for n in range(10):
+    bulk = csx.AddMetal('bulk')
+    bulk.AddBox([n,0,0], [n+1,1,1])
+csx.CommitTransaction()
+assert not csx.InTransaction()
+assert len(csx.GetPropertiesByName('bulk'))==10
+
+##### Test the compiled scene against the inside tests of the primitives
+scene = ContinuousStructure()
+box = scene.AddMetal('box')
+box.AddBox([-5,-5,-5], [5,5,5], priority=0)
+sphere = scene.AddMetal('sphere')
+sphere.AddSphere([1,0,0], 3, priority=5)
+sphere.AddSphericalShell([-2,-2,0], 2, 1, priority=12)
+cyl = scene.AddMetal('cylinder')
+cyl.AddCylinder([0,-4,0], [0,4,0], 1.5, priority=10)
+cyl.AddCylindricalShell([-3,0,-4], [-3,0,4], 1, 0.5, priority=5)
+rot = scene.AddMetal('rot_box')
+rot_box = rot.AddBox([-1,-1,-1], [1,1,1], priority=7)
+rot_box.AddTransform('RotateAxis', 'z', 30)
+rot_box.AddTransform('Translate', [2,2,0])
+scene.Update()
+
+def coord_props(scene):
+    names = []
+    for x in np.linspace(-6, 6, 13):
+        for y in np.linspace(-6, 6, 13):
+            for z in np.linspace(-6, 6, 7):
+                prop = scene.GetPropertyByCoordPriority([x+0.01, y-0.02, z+0.03])
+                names.append(None if prop is None else prop.GetName())
+    return names
+
+ref = coord_props(scene)
+assert not scene.GetUseCompiledScene()
+scene.SetUseCompiledScene(True)
+assert scene.GetUseCompiledScene()
+scene.Update()
+assert coord_props(scene)==ref
+assert len(set(ref))==5  # all properties and the background
+
 csx.Write2XML('test_CSXCAD.xml')
 
 del metal
@@ -0,0 +1,59 @@
+/*
+*	Copyright (C) 2016 Thorsten Liebig (Thorsten.Liebig@gmx.de)
+*
+*	This program is free software: you can redistribute it and/or modify
+*	it under the terms of the GNU Lesser General Public License as published
+*	by the Free Software Foundation, either version 3 of the License, or
+*	(at your option) any later version.
+*
+*	This program is distributed in the hope that it will be useful,
+*	but WITHOUT ANY WARRANTY; without even the implied warranty of
+*	MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+*	GNU Lesser General Public License for more details.
+*
+*	You should have received a copy of the GNU Lesser General Public License
+*	along with this program.  If not, see <http://www.gnu.org/licenses/>.
+*/
+
+#ifndef CSATOMIC_P_H
+#define CSATOMIC_P_H
+
+// Acquire/release access to flags for double-checked locking, the minimum Boost version has no boost::atomic.
+// The GCC/Clang atomic builtins are used if available, with barrier based fallbacks for MSVC and older compilers.
+
+#if defined(_MSC_VER) && !defined(__ATOMIC_ACQUIRE)
+#include <intrin.h>
+#endif
+
+//! Read a flag with acquire semantics, all writes before the matching StoreRelease are visible afterwards
+inline bool LoadAcquire(const bool &flag)
+{
+#if defined(__ATOMIC_ACQUIRE)
+	return __atomic_load_n(&flag, __ATOMIC_ACQUIRE);
+#elif defined(_MSC_VER)
+	// volatile reads have acquire semantics with MSVC
+	bool val = *(const volatile bool*)&flag;
+	_ReadWriteBarrier();
+	return val;
+#else
+	bool val = *(const volatile bool*)&flag;
+	__sync_synchronize();
+	return val;
+#endif
+}
+
+//! Write a flag with release semantics \sa LoadAcquire
+inline void StoreRelease(bool &flag, bool val)
+{
+#if defined(__ATOMIC_RELEASE)
+	__atomic_store_n(&flag, val, __ATOMIC_RELEASE);
+#elif defined(_MSC_VER)
+	_ReadWriteBarrier();
+	*(volatile bool*)&flag = val;
+#else
+	__sync_synchronize();
+	*(volatile bool*)&flag = val;
+#endif
+}
+
+#endif // CSATOMIC_P_H
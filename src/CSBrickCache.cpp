@@ -0,0 +1,365 @@
+/*
+*	Copyright (C) 2016 Thorsten Liebig (Thorsten.Liebig@gmx.de)
+*
+*	This program is free software: you can redistribute it and/or modify
+*	it under the terms of the GNU Lesser General Public License as published
+*	by the Free Software Foundation, either version 3 of the License, or
+*	(at your option) any later version.
+*
+*	This program is distributed in the hope that it will be useful,
+*	but WITHOUT ANY WARRANTY; without even the implied warranty of
+*	MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+*	GNU Lesser General Public License for more details.
+*
+*	You should have received a copy of the GNU Lesser General Public License
+*	along with this program.  If not, see <http://www.gnu.org/licenses/>.
+*/
+
+#include <iostream>
+#include <algorithm>
+#include <list>
+#include <map>
+#include <hdf5.h>
+#include <boost/shared_ptr.hpp>
+#include <boost/thread/mutex.hpp>
+#include <boost/thread/tss.hpp>
+
+#if !defined(WIN32)
+#include <sys/mman.h>
+#include <sys/stat.h>
+#include <fcntl.h>
+#include <unistd.h>
+#endif
+
+#include "CSBrickCache.h"
+
+// default brick edge length for datasets without chunks
+#define BRICK_DEFAULT_SIZE 64
+
+typedef boost::shared_ptr<std::vector<unsigned char> > BrickData;
+
+//! the last brick used by a thread, a reference keeps the brick data valid after an eviction
+struct BrickHandle
+{
+	size_t generation;
+	size_t id;
+	BrickData data;
+};
+
+struct CSBrickCachePrivate
+{
+	struct Brick
+	{
+		BrickData data;
+		std::list<size_t>::iterator lru;
+	};
+	//! guards the bricks, the LRU list, the counters and the HDF5 access
+	boost::mutex m_Mutex;
+	std::map<size_t, Brick> m_Bricks;
+	//! brick ids, most recently used first
+	std::list<size_t> m_LRU;
+	boost::thread_specific_ptr<BrickHandle> m_LastBrick;
+};
+
+// the generation is unique for all caches, a handle left over from a deleted cache can never match a new one
+static boost::mutex g_GenerationMutex;
+static size_t g_Generation = 0;
+
+CSBrickCache::CSBrickCache()
+{
+	m_IsOpen = false;
+	m_File = -1;
+	m_Dataset = -1;
+	for (int n=0;n<3;++n)
+	{
+		m_Size[n] = 0;
+		m_BrickSize[n] = 0;
+		m_NumBricks[n] = 0;
+	}
+	m_MemoryBudget = 256*1024*1024;
+	m_MemoryUsage = 0;
+	m_BrickReads = 0;
+	m_Generation = 0;
+	m_MappedData = NULL;
+	m_MappedBase = NULL;
+	m_MappedLength = 0;
+	d_ptr = new CSBrickCachePrivate;
+}
+
+CSBrickCache::~CSBrickCache()
+{
+	Close();
+	delete d_ptr;
+	d_ptr = NULL;
+}
+
+unsigned int CSBrickCache::GetSize(int ny) const
+{
+	if ((ny<0) || (ny>2))
+		return 0;
+	return m_Size[ny];
+}
+
+void CSBrickCache::SetMemoryBudget(size_t bytes)
+{
+	boost::mutex::scoped_lock lock(d_ptr->m_Mutex);
+	m_MemoryBudget = bytes;
+	EvictBricks(0);
+}
+
+bool CSBrickCache::Open(std::string filename, std::string dataset)
+{
+	Close();
+
+	hid_t file_id = H5Fopen(filename.c_str(), H5F_ACC_RDONLY, H5P_DEFAULT);
+	if (file_id<0)
+	{
+		std::cerr << __func__ << ": Error, failed to open file \"" << filename << "\"" << std::endl;
+		return false;
+	}
+	hid_t dataset_id = H5Dopen2(file_id, dataset.c_str(), H5P_DEFAULT);
+	if (dataset_id<0)
+	{
+		std::cerr << __func__ << ": Error, failed to open dataset \"" << dataset << "\"" << std::endl;
+		H5Fclose(file_id);
+		return false;
+	}
+
+	hid_t space = H5Dget_space(dataset_id);
+	hsize_t dims[3];
+	if (H5Sget_simple_extent_ndims(space)!=3)
+	{
+		std::cerr << __func__ << ": Error, dataset \"" << dataset << "\" has to be three dimensional" << std::endl;
+		H5Sclose(space);
+		H5Dclose(dataset_id);
+		H5Fclose(file_id);
+		return false;
+	}
+	H5Sget_simple_extent_dims(space, dims, NULL);
+	H5Sclose(space);
+	// HDF5 dimensions are stored in z,y,x order (x fastest)
+	for (int n=0;n<3;++n)
+	{
+		m_Size[n] = dims[2-n];
+		m_BrickSize[n] = std::min((unsigned int)BRICK_DEFAULT_SIZE, m_Size[n]);
+	}
+
+	hid_t dcpl = H5Dget_create_plist(dataset_id);
+	H5D_layout_t layout = H5Pget_layout(dcpl);
+	if (layout==H5D_CHUNKED)
+	{
+		hsize_t chunk[3];
+		if (H5Pget_chunk(dcpl, 3, chunk)==3)
+			for (int n=0;n<3;++n)
+				m_BrickSize[n] = std::min((unsigned int)chunk[2-n], m_Size[n]);
+	}
+	H5Pclose(dcpl);
+
+	for (int n=0;n<3;++n)
+	{
+		if (m_BrickSize[n]==0)
+			m_BrickSize[n] = 1;
+		m_NumBricks[n] = (m_Size[n]+m_BrickSize[n]-1)/m_BrickSize[n];
+	}
+
+	m_File = file_id;
+	m_Dataset = dataset_id;
+	m_IsOpen = true;
+	{
+		boost::mutex::scoped_lock lock(g_GenerationMutex);
+		m_Generation = ++g_Generation;
+	}
+
+	// contiguous raw bytes can be used directly from the file
+	if ((layout==H5D_CONTIGUOUS) && MapDataset(filename))
+	{
+		H5Dclose(dataset_id);
+		H5Fclose(file_id);
+		m_File = -1;
+		m_Dataset = -1;
+	}
+	return true;
+}
+
+bool CSBrickCache::MapDataset(std::string filename)
+{
+#if defined(WIN32)
+	UNUSED(filename);
+	return false;
+#else
+	// only a plain 8bit unsigned integer type can be used without conversion
+	hid_t type = H5Dget_type((hid_t)m_Dataset);
+	bool plain = (H5Tget_class(type)==H5T_INTEGER) && (H5Tget_size(type)==1) && (H5Tget_sign(type)==H5T_SGN_NONE);
+	H5Tclose(type);
+	if (plain==false)
+		return false;
+
+	haddr_t addr = H5Dget_offset((hid_t)m_Dataset);
+	if (addr==HADDR_UNDEF)
+		return false;
+
+	// the dataset address is relative to the end of a possible user block
+	hsize_t userblock = 0;
+	hid_t fcpl = H5Fget_create_plist((hid_t)m_File);
+	H5Pget_userblock(fcpl, &userblock);
+	H5Pclose(fcpl);
+
+	size_t offset = (size_t)(addr + userblock);
+	size_t length = GetNumElements();
+
+	int fd = open(filename.c_str(), O_RDONLY);
+	if (fd<0)
+		return false;
+	struct stat st;
+	if ((fstat(fd, &st)!=0) || ((size_t)st.st_size < offset+length))
+	{
+		close(fd);
+		return false;
+	}
+
+	size_t page = sysconf(_SC_PAGESIZE);
+	size_t aligned = offset - offset%page;
+	m_MappedLength = length + (offset-aligned);
+	m_MappedBase = mmap(NULL, m_MappedLength, PROT_READ, MAP_SHARED, fd, aligned);
+	close(fd);
+	if (m_MappedBase==MAP_FAILED)
+	{
+		m_MappedBase = NULL;
+		m_MappedLength = 0;
+		return false;
+	}
+	m_MappedData = (unsigned char*)m_MappedBase + (offset-aligned);
+	return true;
+#endif
+}
+
+void CSBrickCache::Close()
+{
+	// handles of other threads still referencing a brick are released on their next read or at thread exit
+	d_ptr->m_Bricks.clear();
+	d_ptr->m_LRU.clear();
+	d_ptr->m_LastBrick.reset();
+	m_MemoryUsage = 0;
+	m_BrickReads = 0;
+	m_Generation = 0;
+
+#if !defined(WIN32)
+	if (m_MappedBase)
+		munmap(m_MappedBase, m_MappedLength);
+#endif
+	m_MappedBase = NULL;
+	m_MappedData = NULL;
+	m_MappedLength = 0;
+
+	if (m_Dataset>=0)
+		H5Dclose((hid_t)m_Dataset);
+	if (m_File>=0)
+		H5Fclose((hid_t)m_File);
+	m_Dataset = -1;
+	m_File = -1;
+	m_IsOpen = false;
+}
+
+unsigned char CSBrickCache::GetFromBrick(size_t pos)
+{
+	if (m_IsOpen==false)
+		return 0;
+	unsigned int x = pos % m_Size[0];
+	pos /= m_Size[0];
+	unsigned int y = pos % m_Size[1];
+	unsigned int z = pos / m_Size[1];
+
+	unsigned int b[3] = {x/m_BrickSize[0], y/m_BrickSize[1], z/m_BrickSize[2]};
+	size_t id = b[0] + (size_t)m_NumBricks[0]*(b[1] + (size_t)m_NumBricks[1]*b[2]);
+
+	// the last brick of this thread is used without locking
+	BrickHandle* handle = d_ptr->m_LastBrick.get();
+	if ((handle==NULL) || (handle->generation!=m_Generation) || (handle->id!=id))
+	{
+		boost::mutex::scoped_lock lock(d_ptr->m_Mutex);
+		BrickData data;
+		std::map<size_t, CSBrickCachePrivate::Brick>::iterator it = d_ptr->m_Bricks.find(id);
+		if (it==d_ptr->m_Bricks.end())
+		{
+			data.reset(new std::vector<unsigned char>());
+			if (LoadBrick(id, *data)==false)
+				return 0;
+			d_ptr->m_LRU.push_front(id);
+			CSBrickCachePrivate::Brick &brick = d_ptr->m_Bricks[id];
+			brick.data = data;
+			brick.lru = d_ptr->m_LRU.begin();
+			m_MemoryUsage += data->size();
+		}
+		else
+		{
+			data = it->second.data;
+			// move to front of the LRU list
+			d_ptr->m_LRU.splice(d_ptr->m_LRU.begin(), d_ptr->m_LRU, it->second.lru);
+		}
+		if (handle==NULL)
+		{
+			handle = new BrickHandle;
+			d_ptr->m_LastBrick.reset(handle);
+		}
+		handle->generation = m_Generation;
+		handle->id = id;
+		handle->data = data;
+	}
+
+	// local position inside the brick, bricks at the upper boundary may be smaller
+	unsigned int lx = x - b[0]*m_BrickSize[0];
+	unsigned int ly = y - b[1]*m_BrickSize[1];
+	unsigned int lz = z - b[2]*m_BrickSize[2];
+	unsigned int nx = std::min(m_BrickSize[0], m_Size[0]-b[0]*m_BrickSize[0]);
+	unsigned int ny = std::min(m_BrickSize[1], m_Size[1]-b[1]*m_BrickSize[1]);
+	return (*handle->data)[lx + (size_t)nx*(ly + (size_t)ny*lz)];
+}
+
+bool CSBrickCache::LoadBrick(size_t id, std::vector<unsigned char> &data)
+{
+	unsigned int b[3];
+	b[0] = id % m_NumBricks[0];
+	b[1] = (id / m_NumBricks[0]) % m_NumBricks[1];
+	b[2] = id / ((size_t)m_NumBricks[0]*m_NumBricks[1]);
+
+	hsize_t start[3];
+	hsize_t count[3];
+	size_t size = 1;
+	for (int n=0;n<3;++n)
+	{
+		start[2-n] = (hsize_t)b[n]*m_BrickSize[n];
+		count[2-n] = std::min(m_BrickSize[n], m_Size[n]-b[n]*m_BrickSize[n]);
+		size *= count[2-n];
+	}
+
+	EvictBricks(size);
+
+	data.resize(size);
+
+	hid_t filespace = H5Dget_space((hid_t)m_Dataset);
+	H5Sselect_hyperslab(filespace, H5S_SELECT_SET, start, NULL, count, NULL);
+	hid_t memspace = H5Screate_simple(3, count, NULL);
+	herr_t status = H5Dread((hid_t)m_Dataset, H5T_NATIVE_UCHAR, memspace, filespace, H5P_DEFAULT, &data[0]);
+	H5Sclose(memspace);
+	H5Sclose(filespace);
+	if (status<0)
+	{
+		std::cerr << __func__ << ": Error, failed to read brick #" << id << std::endl;
+		return false;
+	}
+	++m_BrickReads;
+	return true;
+}
+
+void CSBrickCache::EvictBricks(size_t required)
+{
+	while ((d_ptr->m_LRU.size()>0) && (m_MemoryUsage+required>m_MemoryBudget))
+	{
+		size_t id = d_ptr->m_LRU.back();
+		d_ptr->m_LRU.pop_back();
+		std::map<size_t, CSBrickCachePrivate::Brick>::iterator it = d_ptr->m_Bricks.find(id);
+		m_MemoryUsage -= it->second.data->size();
+		// the data is deleted with the last handle referencing it
+		d_ptr->m_Bricks.erase(it);
+	}
+}
@@ -0,0 +1,105 @@
+/*
+*	Copyright (C) 2016 Thorsten Liebig (Thorsten.Liebig@gmx.de)
+*
+*	This program is free software: you can redistribute it and/or modify
+*	it under the terms of the GNU Lesser General Public License as published
+*	by the Free Software Foundation, either version 3 of the License, or
+*	(at your option) any later version.
+*
+*	This program is distributed in the hope that it will be useful,
+*	but WITHOUT ANY WARRANTY; without even the implied warranty of
+*	MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+*	GNU Lesser General Public License for more details.
+*
+*	You should have received a copy of the GNU Lesser General Public License
+*	along with this program.  If not, see <http://www.gnu.org/licenses/>.
+*/
+
+#pragma once
+
+#include <string>
+#include <vector>
+#include "stdint.h"
+#include "CSXCAD_Global.h"
+
+//! Lazy, brick-wise read access to a 3D 8bit unsigned integer HDF5 dataset.
+/*!
+ The dataset is accessed by a linear position (x + Nx*(y + Ny*z)), with x being the last (fastest) HDF5 dimension.
+ Bricks are loaded on demand and kept in a least recently used (LRU) cache limited by a memory budget.
+ The brick size is the chunk size for a chunked dataset.
+ A contiguous, uncompressed dataset is memory mapped instead (not on Windows), which does not need any copy at all.
+ Get() may be used by several threads at once: each thread keeps a reference counted handle to its last used brick, thus repeated reads of the same brick don't lock.
+ Only loading or switching a brick locks the cache, an evicted brick stays valid as long as a thread still holds it.
+ Open, Close and SetMemoryBudget must not be called while other threads read from the cache.
+ */
+struct CSBrickCachePrivate;
+
+class CSXCAD_EXPORT CSBrickCache
+{
+public:
+	CSBrickCache();
+	virtual ~CSBrickCache();
+
+	//! Open the 3D dataset in the given file. \return false on error
+	bool Open(std::string filename, std::string dataset);
+	//! Close the file and release all cached bricks
+	void Close();
+	bool IsOpen() const {return m_IsOpen;}
+	//! Check if the dataset is memory mapped (zero-copy access)
+	bool IsMapped() const {return m_MappedData!=NULL;}
+
+	//! Set the memory budget for all cached bricks in bytes, a single brick exceeding the budget is loaded nevertheless
+	void SetMemoryBudget(size_t bytes);
+	size_t GetMemoryBudget() const {return m_MemoryBudget;}
+	//! Get the memory currently used by the cached bricks in bytes
+	size_t GetMemoryUsage() const {return m_MemoryUsage;}
+	//! Get the number of brick reads since opening the dataset
+	size_t GetQtyBrickReads() const {return m_BrickReads;}
+
+	//! Get the number of elements in x (0), y (1) or z (2) direction
+	unsigned int GetSize(int ny) const;
+	size_t GetNumElements() const {return (size_t)m_Size[0]*m_Size[1]*m_Size[2];}
+
+	//! Get the value at the given linear position
+	unsigned char Get(size_t pos)
+	{
+		if (m_MappedData)
+			return m_MappedData[pos];
+		return GetFromBrick(pos);
+	}
+
+protected:
+	bool m_IsOpen;
+	// HDF5 handles (hid_t)
+	int64_t m_File;
+	int64_t m_Dataset;
+
+	unsigned int m_Size[3];
+	unsigned int m_BrickSize[3];
+	unsigned int m_NumBricks[3];
+
+	size_t m_MemoryBudget;
+	size_t m_MemoryUsage;
+	size_t m_BrickReads;
+
+	//! unique id of the opened dataset, to invalidate the brick handles of all threads
+	size_t m_Generation;
+
+	unsigned char* m_MappedData;
+	void* m_MappedBase;
+	size_t m_MappedLength;
+
+	unsigned char GetFromBrick(size_t pos);
+	//! Read a brick from the dataset into the given buffer, the cache has to be locked. \return false on error
+	bool LoadBrick(size_t id, std::vector<unsigned char> &data);
+	//! Evict least recently used bricks until the required memory fits into the budget, the cache has to be locked
+	void EvictBricks(size_t required);
+	bool MapDataset(std::string filename);
+
+	CSBrickCachePrivate* d_ptr; //!< pointer to private data structure, to hide the boost dependency from applications
+
+private:
+	//! the cache can not be copied
+	CSBrickCache(const CSBrickCache&);
+	CSBrickCache& operator=(const CSBrickCache&);
+};
@@ -0,0 +1,271 @@
+/*
+*	Copyright (C) 2016 Thorsten Liebig (Thorsten.Liebig@gmx.de)
+*
+*	This program is free software: you can redistribute it and/or modify
+*	it under the terms of the GNU Lesser General Public License as published
+*	by the Free Software Foundation, either version 3 of the License, or
+*	(at your option) any later version.
+*
+*	This program is distributed in the hope that it will be useful,
+*	but WITHOUT ANY WARRANTY; without even the implied warranty of
+*	MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+*	GNU Lesser General Public License for more details.
+*
+*	You should have received a copy of the GNU Lesser General Public License
+*	along with this program.  If not, see <http://www.gnu.org/licenses/>.
+*/
+
+#include "CSCompiledScene.h"
+
+#include <algorithm>
+#include <math.h>
+
+#include "CSPrimitives.h"
+#include "CSPrimBox.h"
+#include "CSPrimSphere.h"
+#include "CSPrimSphericalShell.h"
+#include "CSPrimCylinder.h"
+#include "CSPrimCylindricalShell.h"
+#include "CSTransform.h"
+
+CSCompiledScene::CSCompiledScene()
+{
+	m_Valid = false;
+	m_MeshType = CARTESIAN;
+	m_Tol = 0;
+}
+
+CSCompiledScene::~CSCompiledScene()
+{
+}
+
+void CSCompiledScene::Clear()
+{
+	m_Valid = false;
+	m_Prims.clear();
+	m_PropTypes.clear();
+	m_Shapes.clear();
+	m_Slots.clear();
+	m_RankMap.clear();
+	m_InvMatrices.clear();
+	for (int s=0;s<NUM_SHAPES;++s)
+	{
+		m_Groups[s].ranks.clear();
+		m_Groups[s].transforms.clear();
+		for (int n=0;n<15;++n)
+			m_Groups[s].params[n].clear();
+	}
+}
+
+void CSCompiledScene::Compile(const std::vector<CSPrimitives*> &prims, CoordinateSystem meshType, double tol)
+{
+	Clear();
+	m_MeshType = meshType;
+	m_Tol = tol;
+	m_Prims = prims;
+	m_PropTypes.resize(prims.size(), 0);
+	m_Shapes.resize(prims.size(), GENERIC);
+	m_Slots.resize(prims.size(), 0);
+	for (unsigned int rank=0;rank<prims.size();++rank)
+	{
+		CSPrimitives* prim = prims.at(rank);
+		m_RankMap[prim] = rank;
+		if (prim->GetProperty())
+			m_PropTypes[rank] = prim->GetProperty()->GetType();
+		AddPrimitive(rank, prim, GetShapeType(prim));
+	}
+	m_Valid = true;
+}
+
+int CSCompiledScene::GetRank(CSPrimitives* prim) const
+{
+	std::map<CSPrimitives*,unsigned int>::const_iterator it = m_RankMap.find(prim);
+	if (it==m_RankMap.end())
+		return -1;
+	return (int)it->second;
+}
+
+CSCompiledScene::ShapeType CSCompiledScene::GetShapeType(CSPrimitives* prim) const
+{
+	switch (prim->GetType())
+	{
+	case CSPrimitives::BOX:
+		// boxes are tested in their own coordinate system, only Cartesian boxes in a Cartesian mesh are compiled
+		if (m_MeshType!=CARTESIAN)
+			return GENERIC;
+		if ((prim->GetCoordinateSystem()!=UNDEFINED_CS) && (prim->GetCoordinateSystem()!=CARTESIAN))
+			return GENERIC;
+		return BOX;
+	case CSPrimitives::SPHERE:
+		return SPHERE;
+	case CSPrimitives::SPHERICALSHELL:
+		return SPHERICALSHELL;
+	case CSPrimitives::CYLINDER:
+		return CYLINDER;
+	case CSPrimitives::CYLINDRICALSHELL:
+		return CYLINDRICALSHELL;
+	default:
+		return GENERIC;
+	}
+}
+
+void CSCompiledScene::AddPrimitive(unsigned int rank, CSPrimitives* prim, ShapeType shape)
+{
+	ShapeGroup &group = m_Groups[shape];
+	m_Shapes[rank] = (unsigned char)shape;
+	m_Slots[rank] = group.ranks.size();
+	group.ranks.push_back(rank);
+
+	int transform = -1;
+	if ((shape!=GENERIC) && prim->HasTransform())
+	{
+		transform = m_InvMatrices.size()/12;
+		const double* inv = prim->GetTransform()->GetInverseMatrix();
+		m_InvMatrices.insert(m_InvMatrices.end(), inv, inv+12);
+	}
+	group.transforms.push_back(transform);
+
+	double p[15] = {0,0,0,0,0,0,0,0,0,0,0,0,0,0,0};
+	switch (shape)
+	{
+	case GENERIC:
+		return;
+	case BOX:
+	{
+		CSPrimBox* box = static_cast<CSPrimBox*>(prim);
+		const double* start = box->GetStartCoord()->GetCoords(prim->GetCoordinateSystem());
+		const double* stop = box->GetStopCoord()->GetCoords(prim->GetCoordinateSystem());
+		for (int n=0;n<3;++n)
+		{
+			p[2*n] = std::min(start[n],stop[n]);
+			p[2*n+1] = std::max(start[n],stop[n]);
+		}
+		break;
+	}
+	case SPHERE:
+	case SPHERICALSHELL:
+	{
+		CSPrimSphere* sphere = static_cast<CSPrimSphere*>(prim);
+		const double* center = sphere->GetCenter()->GetCartesianCoords();
+		for (int n=0;n<3;++n)
+			p[n] = center[n];
+		p[3] = sphere->GetRadius();
+		if (shape==SPHERICALSHELL)
+			p[4] = static_cast<CSPrimSphericalShell*>(prim)->GetShellWidth()/2.0;
+		break;
+	}
+	case CYLINDER:
+	case CYLINDRICALSHELL:
+	{
+		CSPrimCylinder* cyl = static_cast<CSPrimCylinder*>(prim);
+		const double* start = cyl->GetAxisStartCoord()->GetCartesianCoords();
+		const double* stop = cyl->GetAxisStopCoord()->GetCartesianCoords();
+		for (int n=0;n<3;++n)
+		{
+			p[n] = start[n];
+			p[3+n] = stop[n]-start[n];
+		}
+		p[6] = pow(p[3],2)+pow(p[4],2)+pow(p[5],2);
+		p[7] = cyl->GetRadius();
+		cyl->GetBoundBox(&p[8]);
+		if (shape==CYLINDRICALSHELL)
+			p[14] = static_cast<CSPrimCylindricalShell*>(prim)->GetShellWidth()/2.0;
+		break;
+	}
+	default:
+		break;
+	}
+	for (int n=0;n<15;++n)
+		group.params[n].push_back(p[n]);
+}
+
+bool CSCompiledScene::IsInside(unsigned int rank, const double* coord) const
+{
+	return IsInside((ShapeType)m_Shapes[rank], m_Slots[rank], coord);
+}
+
+bool CSCompiledScene::IsInside(ShapeType shape, unsigned int slot, const double* coord) const
+{
+	const ShapeGroup &group = m_Groups[shape];
+	if (shape==GENERIC)
+		return m_Prims[group.ranks[slot]]->IsInside(coord, m_Tol);
+
+	// Cartesian position in the untransformed primitive
+	double pos[3];
+	TransformCoordSystem(coord, pos, m_MeshType, CARTESIAN);
+	if (group.transforms[slot]>=0)
+	{
+		const double* inv = &m_InvMatrices[12*group.transforms[slot]];
+		double in[4] = {pos[0],pos[1],pos[2],1};
+		for (int m=0;m<3;++m)
+		{
+			pos[m] = 0;
+			for (int n=0;n<4;++n)
+				pos[m] += inv[4*m+n]*in[n];
+		}
+	}
+
+	const std::vector<double>* p = group.params;
+	switch (shape)
+	{
+	case BOX:
+		for (int n=0;n<3;++n)
+			if ((pos[n]<p[2*n][slot]) || (pos[n]>p[2*n+1][slot]))
+				return false;
+		return true;
+	case SPHERE:
+	case SPHERICALSHELL:
+	{
+		double dist = sqrt(pow(pos[0]-p[0][slot],2)+pow(pos[1]-p[1][slot],2)+pow(pos[2]-p[2][slot],2));
+		if (shape==SPHERE)
+			return dist<p[3][slot];
+		return fabs(dist-p[3][slot])<p[4][slot];
+	}
+	case CYLINDER:
+	case CYLINDRICALSHELL:
+	{
+		for (int n=0;n<3;++n)
+			if ((pos[n]<p[8+2*n][slot]) || (pos[n]>p[9+2*n][slot]))
+				return false;
+		const double start[3] = {p[0][slot],p[1][slot],p[2][slot]};
+		const double dir[3] = {p[3][slot],p[4][slot],p[5][slot]};
+		double foot = (pos[0]-start[0])*dir[0] + (pos[1]-start[1])*dir[1] + (pos[2]-start[2])*dir[2];
+		foot /= p[6][slot];
+		if ((foot<0) || (foot>1)) //the foot point is not on the axis
+			return false;
+		double footP[3] = {start[0] + foot*dir[0], start[1] + foot*dir[1], start[2] + foot*dir[2]};
+		double dist = sqrt(pow(pos[0]-footP[0],2)+pow(pos[1]-footP[1],2)+pow(pos[2]-footP[2],2));
+		if (shape==CYLINDER)
+			return dist<=p[7][slot];
+		return fabs(dist-p[7][slot])<=p[14][slot];
+	}
+	default:
+		return false;
+	}
+}
+
+int CSCompiledScene::FindPrimitive(const double* coord, CSProperties::PropertyType type) const
+{
+	unsigned int best = m_Prims.size();
+	// scan the generic group last, its inside tests are the most expensive
+	for (int s=NUM_SHAPES-1;s>=0;--s)
+	{
+		const std::vector<unsigned int> &ranks = m_Groups[s].ranks;
+		for (unsigned int slot=0;slot<ranks.size();++slot)
+		{
+			unsigned int rank = ranks[slot];
+			if (rank>=best)
+				break; // the ranks of a group are sorted, no better primitive left in this group
+			if ((type!=CSProperties::ANY) && ((m_PropTypes[rank] & type)==0))
+				continue;
+			if (IsInside((ShapeType)s, slot, coord))
+			{
+				best = rank;
+				break;
+			}
+		}
+	}
+	if (best==m_Prims.size())
+		return -1;
+	return (int)best;
+}
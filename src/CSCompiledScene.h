@@ -0,0 +1,110 @@
+/*
+*	Copyright (C) 2016 Thorsten Liebig (Thorsten.Liebig@gmx.de)
+*
+*	This program is free software: you can redistribute it and/or modify
+*	it under the terms of the GNU Lesser General Public License as published
+*	by the Free Software Foundation, either version 3 of the License, or
+*	(at your option) any later version.
+*
+*	This program is distributed in the hope that it will be useful,
+*	but WITHOUT ANY WARRANTY; without even the implied warranty of
+*	MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+*	GNU Lesser General Public License for more details.
+*
+*	You should have received a copy of the GNU Lesser General Public License
+*	along with this program.  If not, see <http://www.gnu.org/licenses/>.
+*/
+
+#pragma once
+
+#include <vector>
+#include <map>
+#include "CSXCAD_Global.h"
+#include "CSProperties.h"
+
+class CSPrimitives;
+
+//! Immutable, flattened snapshot of a list of primitives for fast coordinate queries
+/*!
+ All boxes, spheres, spherical shells, cylinders and cylindrical shells are compiled into plain arrays (one array per parameter and shape type),
+ including the inverse transformation matrix and the bounding box. Their inside test is done without any virtual call and does not touch the primitive itself.
+ All other primitives (e.g. polygons, polyhedra or curves) are tested using their own inside test.
+ The inside tests of the compiled shapes are identical to the tests of the primitives.
+
+ The primitives are identified by their rank, the position in the list given to Compile().
+ This list is expected to be sorted in the order primitives win a coordinate (highest priority first). \sa CSSpatialIndex
+
+ A snapshot is only valid until any primitive is modified, it has to be compiled again afterwards (e.g. by ContinuousStructure::Update()).
+ All queries are const and thread-safe, as long as the inside tests of the primitives not compiled are thread-safe.
+ */
+class CSXCAD_EXPORT CSCompiledScene
+{
+public:
+	CSCompiledScene();
+	virtual ~CSCompiledScene();
+
+	//! Compile the given (priority sorted) primitives, all coordinates are given in the mesh type meshType. The tolerance is passed to the inside test of all primitives not compiled.
+	void Compile(const std::vector<CSPrimitives*> &prims, CoordinateSystem meshType, double tol=0);
+
+	//! Remove all primitives, the snapshot will be invalid afterwards.
+	void Clear();
+
+	//! Check if the snapshot was compiled and is usable
+	bool IsValid() const {return m_Valid;}
+
+	//! Get the number of primitives in this snapshot
+	size_t GetQtyPrimitives() const {return m_Prims.size();}
+	//! Get the number of primitives compiled to a native inside test, all others use the inside test of the primitive.
+	size_t GetQtyCompiled() const {return m_Prims.size()-m_Groups[GENERIC].ranks.size();}
+
+	//! Get the primitive with the given rank
+	CSPrimitives* GetPrimitive(unsigned int rank) const {return m_Prims[rank];}
+	//! Get the rank of the given primitive, -1 if it is not part of this snapshot
+	int GetRank(CSPrimitives* prim) const;
+
+	//! Check if the coordinate (in mesh coordinates) is inside the primitive with the given rank
+	bool IsInside(unsigned int rank, const double* coord) const;
+
+	//! Find the primitive with the highest priority including the given coordinate (in mesh coordinates) and a property of the given type.
+	/*!
+	 Each shape type is scanned separately, only primitives with a better rank than the best one found so far are tested.
+	 \return The rank of the found primitive or -1 if no primitive was found.
+	 */
+	int FindPrimitive(const double* coord, CSProperties::PropertyType type=CSProperties::ANY) const;
+
+protected:
+	enum ShapeType
+	{
+		GENERIC, BOX, SPHERE, SPHERICALSHELL, CYLINDER, CYLINDRICALSHELL, NUM_SHAPES
+	};
+
+	//! Parameters of all primitives of a shape type, one array per parameter
+	struct ShapeGroup
+	{
+		//! ranks of all primitives in this group (increasing)
+		std::vector<unsigned int> ranks;
+		//! index into m_InvMatrices or -1 without transformation
+		std::vector<int> transforms;
+		std::vector<double> params[15];
+	};
+
+	bool m_Valid;
+	CoordinateSystem m_MeshType;
+	double m_Tol;
+	std::vector<CSPrimitives*> m_Prims;
+	//! property type, shape type and position in its shape group for each rank
+	std::vector<int> m_PropTypes;
+	std::vector<unsigned char> m_Shapes;
+	std::vector<unsigned int> m_Slots;
+	std::map<CSPrimitives*,unsigned int> m_RankMap;
+
+	ShapeGroup m_Groups[NUM_SHAPES];
+	//! the first three rows of all inverse transformation matrices (12 values each)
+	std::vector<double> m_InvMatrices;
+
+	//! Get the shape type this primitive can be compiled to
+	ShapeType GetShapeType(CSPrimitives* prim) const;
+	void AddPrimitive(unsigned int rank, CSPrimitives* prim, ShapeType shape);
+	//! Check the primitive in the given slot of a shape group
+	bool IsInside(ShapeType shape, unsigned int slot, const double* coord) const;
+};
@@ -0,0 +1,564 @@
+/*
+*	Copyright (C) 2016 Thorsten Liebig (Thorsten.Liebig@gmx.de)
+*
+*	This program is free software: you can redistribute it and/or modify
+*	it under the terms of the GNU Lesser General Public License as published
+*	by the Free Software Foundation, either version 3 of the License, or
+*	(at your option) any later version.
+*
+*	This program is distributed in the hope that it will be useful,
+*	but WITHOUT ANY WARRANTY; without even the implied warranty of
+*	MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+*	GNU Lesser General Public License for more details.
+*
+*	You should have received a copy of the GNU Lesser General Public License
+*	along with this program.  If not, see <http://www.gnu.org/licenses/>.
+*/
+
+#include <algorithm>
+#include <map>
+#include <math.h>
+#include <boost/thread.hpp>
+
+#include "CSEdgeDetector.h"
+#include "ContinuousStructure.h"
+#include "CSRectGrid.h"
+#include "CSTransform.h"
+#include "CSPrimPoint.h"
+#include "CSPrimBox.h"
+#include "CSPrimMultiBox.h"
+#include "CSPrimSphere.h"
+#include "CSPrimSphericalShell.h"
+#include "CSPrimCylinder.h"
+#include "CSPrimCylindricalShell.h"
+#include "CSPrimPolygon.h"
+#include "CSPrimLinPoly.h"
+#include "CSPrimRotPoly.h"
+#include "CSPrimPolyhedron.h"
+#include "CSPrimCurve.h"
+
+//! Sort the lines and merge all lines closer than tol times the range of all lines
+static void MergeLines(std::vector<double> &lines, double tol)
+{
+	std::sort(lines.begin(),lines.end());
+	lines.erase(std::unique(lines.begin(),lines.end()),lines.end());
+	if (lines.size()<2)
+		return;
+	double min_dist = (lines.back()-lines.front())*tol;
+	size_t num = 1;
+	for (size_t n=1;n<lines.size();++n)
+		if (lines[n]-lines[num-1]>min_dist)
+			lines[num++] = lines[n];
+	lines.resize(num);
+}
+
+CSEdgeDetector::CSEdgeDetector(ContinuousStructure* CSX)
+{
+	m_CSX = CSX;
+	m_Type = CSProperties::METAL | CSProperties::MATERIAL | CSProperties::EXCITATION | CSProperties::LUMPED_ELEMENT | CSProperties::CONDUCTINGSHEET;
+	m_MetalEdgeRes = 0;
+	m_FeatureAngle = 30;
+	m_Tolerance = 1e-10;
+	m_UseRegion = false;
+	for (int n=0;n<6;++n)
+		m_Region[n] = 0;
+	m_MeshType = CARTESIAN;
+	m_NumPrims = 0;
+	m_NumSkipped = 0;
+}
+
+CSEdgeDetector::~CSEdgeDetector()
+{
+}
+
+void CSEdgeDetector::SetRegion(const double* box)
+{
+	m_UseRegion = (box!=NULL);
+	for (int n=0;n<6 && m_UseRegion;++n)
+		m_Region[n] = box[n];
+}
+
+bool CSEdgeDetector::Detect()
+{
+	for (int n=0;n<3;++n)
+		m_Lines[n].clear();
+	m_NumPrims = 0;
+	m_NumSkipped = 0;
+	m_MeshType = m_CSX->GetCoordInputType();
+	if ((m_MeshType!=CARTESIAN) && (m_MeshType!=CYLINDRICAL))
+		return false;
+
+	std::vector<CSPrimitives*> all = m_CSX->GetAllPrimitives(false, (CSProperties::PropertyType)m_Type);
+	m_Index.Build(all);
+	m_Prims.clear();
+	if (m_UseRegion)
+	{
+		std::vector<unsigned int> found;
+		m_Index.FindCandidatesInBox(m_Region, found);
+		for (size_t i=0;i<found.size();++i)
+			m_Prims.push_back(m_Index.GetPrimitive(found.at(i)));
+	}
+	else
+		m_Prims = all;
+	m_NumPrims = m_Prims.size();
+
+	unsigned int numThreads = m_CSX->GetNumberOfThreads(m_Prims.size());
+	if (numThreads<1)
+		numThreads = 1;
+
+	std::vector<Seeds> seeds(numThreads);
+	if (numThreads==1)
+		DetectWorker(&seeds[0], 0, 1);
+	else
+	{
+		boost::thread_group threads;
+		for (unsigned int t=0;t<numThreads;++t)
+			threads.add_thread(new boost::thread(&CSEdgeDetector::DetectWorker, this, &seeds[t], t, numThreads));
+		threads.join_all();
+	}
+
+	for (unsigned int t=0;t<numThreads;++t)
+	{
+		m_NumSkipped += seeds[t].numSkipped;
+		for (int n=0;n<3;++n)
+			m_Lines[n].insert(m_Lines[n].end(), seeds[t].lines[n].begin(), seeds[t].lines[n].end());
+	}
+	for (int n=0;n<3;++n)
+		MergeLines(m_Lines[n], m_Tolerance);
+	m_Prims.clear();
+	return true;
+}
+
+bool CSEdgeDetector::AddToGrid(CSRectGrid* grid) const
+{
+	if (grid==NULL)
+		grid = m_CSX->GetGrid();
+	for (int n=0;n<3;++n)
+		if (m_Lines[n].size()>0)
+			grid->MergeLines(n, &m_Lines[n][0], m_Lines[n].size());
+	return true;
+}
+
+void CSEdgeDetector::DetectWorker(Seeds* seeds, size_t start, size_t step) const
+{
+	seeds->numSkipped = 0;
+	for (size_t i=start;i<m_Prims.size();i+=step)
+		if (AddPrimitive(m_Prims.at(i), *seeds)==false)
+			++seeds->numSkipped;
+}
+
+bool CSEdgeDetector::IsMetalSheet(CSPrimitives* prim) const
+{
+	if ((m_MetalEdgeRes<=0) || (m_MeshType!=CARTESIAN))
+		return false;
+	if ((prim->GetProperty()->GetType() & CSProperties::METAL)==0)
+		return false;
+	return prim->GetDimension()==2;
+}
+
+bool CSEdgeDetector::AddPrimitive(CSPrimitives* prim, Seeds &seeds) const
+{
+	CoordinateSystem cs = prim->GetCoordinateSystem();
+	if (cs==UNDEFINED_CS)
+		cs = m_MeshType;
+	double pnt[3];
+	double box[6];
+
+	switch (prim->GetType())
+	{
+	case CSPrimitives::POINT:
+	{
+		if (cs!=m_MeshType)
+			return false;
+		CSPrimPoint* point = prim->ToPoint();
+		for (int n=0;n<3;++n)
+			pnt[n] = point->GetCoord(n);
+		AddPoint(prim, pnt, cs, seeds);
+		return true;
+	}
+	case CSPrimitives::BOX:
+	{
+		if (cs!=m_MeshType)
+			return false;
+		CSPrimBox* b = prim->ToBox();
+		for (int n=0;n<6;++n)
+			box[n] = b->GetCoord(n);
+		if (IsMetalSheet(prim)==false)
+		{
+			AddBox(prim, box, cs, seeds);
+			return true;
+		}
+		// metal sheet: thirds rule at the in-plane edges, a plain line in normal direction
+		for (int n=0;n<3;++n)
+			pnt[n] = 0.5*(box[2*n]+box[2*n+1]);
+		for (int ny=0;ny<3;++ny)
+		{
+			double edge[3] = {pnt[0],pnt[1],pnt[2]};
+			if (box[2*ny]==box[2*ny+1])
+			{
+				AddAxisLine(prim, edge, ny, false, seeds);
+				continue;
+			}
+			for (int m=0;m<2;++m)
+			{
+				edge[ny] = box[2*ny+m];
+				AddAxisLine(prim, edge, ny, true, seeds);
+			}
+		}
+		return true;
+	}
+	case CSPrimitives::MULTIBOX:
+	{
+		if (cs!=m_MeshType)
+			return false;
+		CSPrimMultiBox* mbox = prim->ToMultiBox();
+		for (unsigned int i=0;i<mbox->GetQtyBoxes();++i)
+		{
+			for (int n=0;n<6;++n)
+				box[n] = mbox->GetCoord(6*i+n);
+			AddBox(prim, box, cs, seeds);
+		}
+		return true;
+	}
+	case CSPrimitives::SPHERE:
+	case CSPrimitives::SPHERICALSHELL:
+	{
+		CSPrimSphere* sphere = static_cast<CSPrimSphere*>(prim);
+		double center[3];
+		// sphere coordinates are always given in Cartesian coordinates
+		for (int n=0;n<3;++n)
+			center[n] = sphere->GetCenter()->GetCoordValue(n, CARTESIAN);
+		std::vector<double> radii(1, sphere->GetRadius());
+		if (prim->GetType()==CSPrimitives::SPHERICALSHELL)
+		{
+			double w = static_cast<CSPrimSphericalShell*>(prim)->GetShellWidth();
+			radii.assign(1, radii[0]-0.5*w);
+			radii.push_back(radii[0]+w);
+		}
+		AddPoint(prim, center, CARTESIAN, seeds);
+		for (size_t r=0;r<radii.size();++r)
+			for (int n=0;n<3;++n)
+				for (int s=-1;s<=1;s+=2)
+				{
+					for (int m=0;m<3;++m)
+						pnt[m] = center[m];
+					pnt[n] += s*radii[r];
+					AddPoint(prim, pnt, CARTESIAN, seeds);
+				}
+		return true;
+	}
+	case CSPrimitives::CYLINDER:
+	case CSPrimitives::CYLINDRICALSHELL:
+	{
+		if (cs!=m_MeshType)
+			return false;
+		CSPrimCylinder* cyl = static_cast<CSPrimCylinder*>(prim);
+		double axis[2][3];
+		for (int m=0;m<2;++m)
+			for (int n=0;n<3;++n)
+				axis[m][n] = cyl->GetCoord(2*n+m);
+		std::vector<double> radii(1, cyl->GetRadius());
+		if (prim->GetType()==CSPrimitives::CYLINDRICALSHELL)
+		{
+			double w = static_cast<CSPrimCylindricalShell*>(prim)->GetShellWidth();
+			radii.assign(1, radii[0]-0.5*w);
+			radii.push_back(radii[0]+w);
+		}
+		AddPoint(prim, axis[0], cs, seeds);
+		AddPoint(prim, axis[1], cs, seeds);
+		// the radii in the directions normal to an axis parallel (Cartesian) cylinder
+		int dir = -1;
+		for (int n=0;n<3;++n)
+			if (axis[0][n]!=axis[1][n])
+				dir = (dir==-1) ? n : 3;
+		if ((cs!=CARTESIAN) || (dir<0) || (dir>2))
+			return true;
+		for (size_t r=0;r<radii.size();++r)
+			for (int n=0;n<3;++n)
+				for (int s=-1;s<=1 && n!=dir;s+=2)
+				{
+					for (int m=0;m<3;++m)
+						pnt[m] = axis[0][m];
+					pnt[n] += s*radii[r];
+					AddPoint(prim, pnt, cs, seeds);
+				}
+		return true;
+	}
+	case CSPrimitives::POLYGON:
+	case CSPrimitives::LINPOLY:
+	{
+		// polygon coordinates are always Cartesian
+		CSPrimPolygon* poly = static_cast<CSPrimPolygon*>(prim);
+		int nd = poly->GetNormDir();
+		int nP = (nd+1)%3;
+		int nPP = (nd+2)%3;
+		double length = 0;
+		if (prim->GetType()==CSPrimitives::LINPOLY)
+			length = static_cast<CSPrimLinPoly*>(prim)->GetLength();
+		size_t np = poly->GetQtyCoords();
+		if ((np>0) && IsMetalSheet(prim))
+		{
+			// metal sheet: thirds rule at the axis parallel polygon edges, plain lines at all other vertex coordinates
+			pnt[nd] = poly->GetElevation();
+			AddAxisLine(prim, pnt, nd, false, seeds);
+			for (size_t i=0;i<np;++i)
+			{
+				size_t prev = (i+np-1)%np;
+				size_t next = (i+1)%np;
+				pnt[nP] = poly->GetCoord(2*i);
+				pnt[nPP] = poly->GetCoord(2*i+1);
+				for (int m=0;m<2;++m)
+				{
+					int ny = (m==0) ? nP : nPP;
+					double val = poly->GetCoord(2*i+m);
+					if (val==poly->GetCoord(2*next+m))
+					{
+						// edge to the next vertex is normal to ny
+						double edge[3] = {pnt[0],pnt[1],pnt[2]};
+						int nOther = (m==0) ? nPP : nP;
+						edge[nOther] = 0.5*(pnt[nOther]+poly->GetCoord(2*next+1-m));
+						AddAxisLine(prim, edge, ny, true, seeds);
+					}
+					else if (val!=poly->GetCoord(2*prev+m))
+						AddAxisLine(prim, pnt, ny, false, seeds);
+				}
+			}
+			return true;
+		}
+		for (size_t i=0;i<np;++i)
+		{
+			pnt[nd] = poly->GetElevation();
+			pnt[nP] = poly->GetCoord(2*i);
+			pnt[nPP] = poly->GetCoord(2*i+1);
+			AddPoint(prim, pnt, CARTESIAN, seeds);
+			if (length!=0)
+			{
+				pnt[nd] += length;
+				AddPoint(prim, pnt, CARTESIAN, seeds);
+			}
+		}
+		return true;
+	}
+	case CSPrimitives::ROTPOLY:
+	{
+		// only the axis coordinate of the vertices is invariant to the rotation, all others are represented by the bounding box
+		CSPrimRotPoly* poly = prim->ToRotPoly();
+		int nd = poly->GetNormDir();
+		int rot = poly->GetRotAxisDir();
+		if (prim->GetBoundBox(box)==false)
+			return false;
+		if ((prim->HasTransform()==false) || (prim->GetTransform()->HasTransform()==false))
+		{
+			int nV = (rot==(nd+1)%3) ? 0 : 1;
+			for (size_t i=0;i<poly->GetQtyCoords();++i)
+			{
+				double val = poly->GetCoord(2*i+nV);
+				if (m_MeshType==CARTESIAN)
+					seeds.lines[rot].push_back(val);
+				else if ((m_MeshType==CYLINDRICAL) && (rot==2))
+					seeds.lines[2].push_back(val);
+			}
+		}
+		AddBox(prim, box, prim->GetBoundBoxCoordSystem(), seeds);
+		return true;
+	}
+	case CSPrimitives::POLYHEDRON:
+	case CSPrimitives::POLYHEDRONREADER:
+		AddPolyhedron(prim, seeds);
+		return true;
+	case CSPrimitives::CURVE:
+	case CSPrimitives::WIRE:
+	{
+		CSPrimCurve* curve = static_cast<CSPrimCurve*>(prim);
+		for (size_t i=0;i<curve->GetNumberOfPoints();++i)
+		{
+			curve->GetPoint(i, pnt, CARTESIAN, false);
+			AddPoint(prim, pnt, CARTESIAN, seeds);
+		}
+		return true;
+	}
+	default:
+		break;
+	}
+
+	// all other primitives (e.g. user defined): use the bounding box if known
+	if (prim->GetBoundBox(box)==false)
+		return false;
+	cs = prim->GetBoundBoxCoordSystem();
+	if (cs==UNDEFINED_CS)
+		cs = m_MeshType;
+	if (cs!=m_MeshType)
+		return false;
+	AddBox(prim, box, cs, seeds);
+	return true;
+}
+
+void CSEdgeDetector::AddPoint(CSPrimitives* prim, const double* point, CoordinateSystem cs, Seeds &seeds) const
+{
+	double pnt[3] = {point[0],point[1],point[2]};
+	if (prim->HasTransform() && prim->GetTransform()->HasTransform())
+	{
+		TransformCoordSystem(pnt, pnt, cs, CARTESIAN);
+		prim->GetTransform()->Transform(pnt, pnt);
+		cs = CARTESIAN;
+	}
+	TransformCoordSystem(pnt, pnt, cs, m_MeshType);
+	for (int n=0;n<3;++n)
+		seeds.lines[n].push_back(pnt[n]);
+}
+
+void CSEdgeDetector::AddBox(CSPrimitives* prim, const double* box, CoordinateSystem cs, Seeds &seeds) const
+{
+	double pnt[3];
+	bool transform = prim->HasTransform() && prim->GetTransform()->HasTransform();
+	if ((transform==false) && (cs==m_MeshType))
+	{
+		// the two opposite corners define all lines
+		for (int n=0;n<3;++n)
+		{
+			seeds.lines[n].push_back(box[2*n]);
+			seeds.lines[n].push_back(box[2*n+1]);
+		}
+		return;
+	}
+	for (int c=0;c<8;++c)
+	{
+		for (int n=0;n<3;++n)
+			pnt[n] = box[2*n+((c>>n)&1)];
+		AddPoint(prim, pnt, cs, seeds);
+	}
+}
+
+void CSEdgeDetector::AddAxisLine(CSPrimitives* prim, const double* point, int ny, bool metalEdge, Seeds &seeds) const
+{
+	double pnt[3] = {point[0],point[1],point[2]};
+	if (prim->HasTransform() && prim->GetTransform()->HasTransform())
+	{
+		// the direction has to stay axis parallel
+		double ref[3] = {point[0],point[1],point[2]};
+		ref[ny] += 1;
+		prim->GetTransform()->Transform(pnt, pnt);
+		prim->GetTransform()->Transform(ref, ref);
+		double dir[3];
+		double len = 0;
+		for (int n=0;n<3;++n)
+		{
+			dir[n] = ref[n]-pnt[n];
+			len += dir[n]*dir[n];
+		}
+		len = sqrt(len);
+		ny = -1;
+		for (int n=0;n<3;++n)
+			if (fabs(fabs(dir[n])-len) <= 1e-12*len)
+				ny = n;
+		if (ny<0)
+		{
+			AddPoint(prim, point, CARTESIAN, seeds);
+			return;
+		}
+	}
+	seeds.lines[ny].push_back(pnt[ny]);
+	if (metalEdge==false)
+		return;
+
+	// find the metal side of the edge
+	double delta = 1e-3*m_MetalEdgeRes;
+	double probe[3] = {pnt[0],pnt[1],pnt[2]};
+	probe[ny] = pnt[ny]+delta;
+	bool upper = IsInsideMetal(probe);
+	probe[ny] = pnt[ny]-delta;
+	bool lower = IsInsideMetal(probe);
+	if (upper==lower)
+		return;
+
+	// replace the line on the edge by a line 1/3 inside and 2/3 outside the metal
+	double s = upper ? 1 : -1;
+	seeds.lines[ny].back() = pnt[ny] + s*m_MetalEdgeRes/3;
+	seeds.lines[ny].push_back(pnt[ny] - s*2*m_MetalEdgeRes/3);
+}
+
+bool CSEdgeDetector::IsInsideMetal(const double* coord) const
+{
+	std::vector<unsigned int> found;
+	m_Index.FindCandidates(coord, found);
+	for (size_t i=0;i<found.size();++i)
+	{
+		CSPrimitives* prim = m_Index.GetPrimitive(found.at(i));
+		if ((prim->GetProperty()->GetType() & CSProperties::METAL) && prim->IsInside(coord))
+			return true;
+	}
+	return false;
+}
+
+void CSEdgeDetector::AddPolyhedron(CSPrimitives* prim, Seeds &seeds) const
+{
+	CSPrimPolyhedron* poly = static_cast<CSPrimPolyhedron*>(prim);
+	unsigned int numFaces = poly->GetNumFaces();
+
+	unsigned int numVertices = poly->GetNumVertices();
+
+	// normal of each face (Newell's method) and all faces of each edge
+	std::vector<double> normals(3*numFaces, 0.0);
+	std::map< std::pair<int,int>, std::vector<unsigned int> > edges;
+	for (unsigned int f=0;f<numFaces;++f)
+	{
+		unsigned int numV = 0;
+		int* face = poly->GetFace(f, numV);
+		if ((face==NULL) || (numV<3))
+			continue;
+		// skip faces with invalid vertex indices, as the inside test does
+		bool valid = true;
+		for (unsigned int v=0;v<numV;++v)
+			if ((face[v]<0) || ((unsigned int)face[v]>=numVertices))
+				valid = false;
+		if (valid==false)
+			continue;
+		double* nf = &normals[3*f];
+		for (unsigned int v=0;v<numV;++v)
+		{
+			int a = face[v];
+			int b = face[(v+1)%numV];
+			const float* pa = poly->GetVertex(a);
+			const float* pb = poly->GetVertex(b);
+			nf[0] += ((double)pa[1]-pb[1])*((double)pa[2]+pb[2]);
+			nf[1] += ((double)pa[2]-pb[2])*((double)pa[0]+pb[0]);
+			nf[2] += ((double)pa[0]-pb[0])*((double)pa[1]+pb[1]);
+			edges[std::make_pair(std::min(a,b),std::max(a,b))].push_back(f);
+		}
+		double len = sqrt(nf[0]*nf[0]+nf[1]*nf[1]+nf[2]*nf[2]);
+		for (int n=0;len>0 && n<3;++n)
+			nf[n] /= len;
+	}
+
+	// boundary, non-manifold and sharp edges are feature edges
+	double cos_limit = cos(m_FeatureAngle*M_PI/180.0);
+	std::vector<bool> feature(numVertices, false);
+	std::map< std::pair<int,int>, std::vector<unsigned int> >::const_iterator it;
+	for (it=edges.begin();it!=edges.end();++it)
+	{
+		const std::vector<unsigned int> &faces = it->second;
+		bool sharp = (faces.size()!=2);
+		if (sharp==false)
+		{
+			const double* n1 = &normals[3*faces[0]];
+			const double* n2 = &normals[3*faces[1]];
+			// signed, a fold back onto itself (opposite normals) is a sharp edge
+			sharp = (n1[0]*n2[0]+n1[1]*n2[1]+n1[2]*n2[2] < cos_limit);
+		}
+		if (sharp)
+			feature[it->first.first] = feature[it->first.second] = true;
+	}
+
+	double pnt[3];
+	for (unsigned int v=0;v<feature.size();++v)
+	{
+		if (feature[v]==false)
+			continue;
+		const float* vertex = poly->GetVertex(v);
+		if (vertex==NULL)
+			continue;
+		for (int n=0;n<3;++n)
+			pnt[n] = vertex[n];
+		AddPoint(prim, pnt, CARTESIAN, seeds);
+	}
+}
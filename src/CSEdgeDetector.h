@@ -0,0 +1,127 @@
+/*
+*	Copyright (C) 2016 Thorsten Liebig (Thorsten.Liebig@gmx.de)
+*
+*	This program is free software: you can redistribute it and/or modify
+*	it under the terms of the GNU Lesser General Public License as published
+*	by the Free Software Foundation, either version 3 of the License, or
+*	(at your option) any later version.
+*
+*	This program is distributed in the hope that it will be useful,
+*	but WITHOUT ANY WARRANTY; without even the implied warranty of
+*	MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+*	GNU Lesser General Public License for more details.
+*
+*	You should have received a copy of the GNU Lesser General Public License
+*	along with this program.  If not, see <http://www.gnu.org/licenses/>.
+*/
+
+#pragma once
+
+#include <vector>
+#include "CSXCAD_Global.h"
+#include "CSProperties.h"
+#include "CSSpatialIndex.h"
+
+class ContinuousStructure;
+class CSRectGrid;
+class CSPrimitives;
+
+//! Detect the edges of all primitives of a structure and collect them as mesh seed lines for each direction.
+/*!
+ The seed lines are taken from the feature points of each primitive type: box and multi-box corners, polygon vertices (and their extrusion),
+ the axis coordinates of rotated polygons, cylinder axes and radii, sphere centers and radii, curve points and the vertices of polyhedron feature edges
+ (boundary edges and edges between faces with a normal angle larger than the feature angle). All other primitives are represented by their bounding box.
+ Points are transformed by the primitive's transformation and converted to the mesh type of the structure.
+ Primitives defined in a coordinate system different to the mesh type are skipped, as they have no straight edges in the mesh.
+
+ If a metal edge resolution is set, the "thirds rule" is applied to the axis parallel edges of all 2D metal primitives (Cartesian mesh only):
+ instead of a line on the edge, a line is placed one third of the resolution inside the metal and one two-thirds outside.
+ Edges with metal on both sides (found by a spatial index over all detected primitives) are not metal edges and are seeded by a line on the edge.
+
+ The primitives are processed by all threads of the structure in a single pass. \sa ContinuousStructure::SetNumberOfThreads
+ Lines closer than the tolerance (relative to the range of all lines in a direction) are merged.
+ */
+class CSXCAD_EXPORT CSEdgeDetector
+{
+public:
+	CSEdgeDetector(ContinuousStructure* CSX);
+	virtual ~CSEdgeDetector();
+
+	//! Set the property types to detect, the default are metals, materials, excitations and lumped elements.
+	void SetPropertyType(int type) {m_Type=type;}
+	int GetPropertyType() const {return m_Type;}
+
+	//! Set the resolution for the thirds rule at 2D metal edges, 0 (default) disables the rule.
+	void SetMetalEdgeResolution(double res) {m_MetalEdgeRes=res;}
+	double GetMetalEdgeResolution() const {return m_MetalEdgeRes;}
+
+	//! Set the min. angle (in degree) between the normals of two faces of a polyhedron to detect their common edge (default is 30)
+	void SetFeatureAngle(double angle) {m_FeatureAngle=angle;}
+	double GetFeatureAngle() const {return m_FeatureAngle;}
+
+	//! Set the relative tolerance to merge lines (default is 1e-10)
+	void SetTolerance(double tol) {m_Tolerance=tol;}
+	double GetTolerance() const {return m_Tolerance;}
+
+	//! Restrict the detection to the primitives with a bounding box intersecting the given Cartesian box (xmin,xmax,ymin,...), NULL removes the restriction.
+	void SetRegion(const double* box);
+
+	//! Detect the edges of all primitives. \return false if the structure has no usable mesh type
+	bool Detect();
+
+	//! Get the sorted seed lines in direction ny found by the last Detect()
+	const std::vector<double>& GetLines(int ny) const {return m_Lines[ny];}
+	//! Get the number of primitives processed by the last Detect()
+	size_t GetNumPrimitives() const {return m_NumPrims;}
+	//! Get the number of primitives skipped by the last Detect() (unsupported coordinate system)
+	size_t GetNumSkipped() const {return m_NumSkipped;}
+
+	//! Add the seed lines to the given grid, the grid of the structure if grid is NULL.
+	bool AddToGrid(CSRectGrid* grid=NULL) const;
+
+protected:
+	ContinuousStructure* m_CSX;
+	int m_Type;
+	double m_MetalEdgeRes;
+	double m_FeatureAngle;
+	double m_Tolerance;
+	bool m_UseRegion;
+	double m_Region[6];
+	CoordinateSystem m_MeshType;
+
+	std::vector<CSPrimitives*> m_Prims;
+	CSSpatialIndex m_Index;
+	std::vector<double> m_Lines[3];
+	size_t m_NumPrims;
+	size_t m_NumSkipped;
+
+	//! Seed lines found for a number of primitives, one instance per thread
+	struct Seeds
+	{
+		std::vector<double> lines[3];
+		size_t numSkipped;
+	};
+
+	//! Process the primitives start, start+step, start+2*step, ... (one thread each)
+	void DetectWorker(Seeds* seeds, size_t start, size_t step) const;
+
+	//! Add the seed lines of a primitive. \return false if the primitive was skipped
+	bool AddPrimitive(CSPrimitives* prim, Seeds &seeds) const;
+	//! Add a point given in the coordinate system cs, after applying the primitive's transformation.
+	void AddPoint(CSPrimitives* prim, const double* point, CoordinateSystem cs, Seeds &seeds) const;
+	//! Add the corners of a box given in the coordinate system cs. \sa AddPoint
+	void AddBox(CSPrimitives* prim, const double* box, CoordinateSystem cs, Seeds &seeds) const;
+	//! Add the line in direction ny through a point given in Cartesian primitive coordinates, or the thirds rule lines if it is on the edge of a 2D metal primitive.
+	/*!
+	 All coordinates of the point are added, if the direction ny is not axis parallel after the primitive's transformation.
+	 \param metalEdge The point is on an edge (normal to ny) of the metal primitive.
+	 */
+	void AddAxisLine(CSPrimitives* prim, const double* point, int ny, bool metalEdge, Seeds &seeds) const;
+	//! Check if the coordinate is inside any detected metal primitive
+	bool IsInsideMetal(const double* coord) const;
+	//! Add the vertices of all feature edges of a polyhedron
+	void AddPolyhedron(CSPrimitives* prim, Seeds &seeds) const;
+
+	//! Check if the primitive is a 2D primitive of a metal property and the thirds rule has to be applied
+	bool IsMetalSheet(CSPrimitives* prim) const;
+};
@@ -18,6 +18,13 @@
 #include "CSFunctionParser.h"
 #include <math.h>
 #include <iostream>
+#include <boost/thread/mutex.hpp>
+#include <boost/thread/tss.hpp>
+#include "CSAtomic_p.h"
+
+// number of threads with an own copy in each parser pool, all further threads share the copies of the pool
+#define PARSER_POOL_THREAD_SLOTS 64
+#define PARSER_POOL_CACHE_LINE 64
 
 double bessel_first_kind_0(const double* p)
 {
@@ -74,3 +81,173 @@ CSFunctionParser::CSFunctionParser()
 	AddFunction("y1",bessel_second_kind_1,1);
 	AddFunction("yn",bessel_second_kind_n,2);
 }
+
+//! small index of a thread, reused by a new thread after the thread has finished
+struct ThreadSlot
+{
+	unsigned int index;
+	~ThreadSlot();
+};
+
+static boost::mutex g_ThreadSlotMutex;
+static std::vector<unsigned int> g_FreeThreadSlots;
+static unsigned int g_NumThreadSlots = 0;
+static boost::thread_specific_ptr<ThreadSlot> g_ThreadSlot;
+
+ThreadSlot::~ThreadSlot()
+{
+	boost::mutex::scoped_lock lock(g_ThreadSlotMutex);
+	g_FreeThreadSlots.push_back(index);
+}
+
+//! Get the slot index of the calling thread, only locks on the first call of a thread
+static unsigned int GetThreadSlot()
+{
+	ThreadSlot* slot = g_ThreadSlot.get();
+	if (slot)
+		return slot->index;
+	slot = new ThreadSlot;
+	{
+		boost::mutex::scoped_lock lock(g_ThreadSlotMutex);
+		if (g_FreeThreadSlots.empty())
+			slot->index = g_NumThreadSlots++;
+		else
+		{
+			slot->index = g_FreeThreadSlots.back();
+			g_FreeThreadSlots.pop_back();
+		}
+	}
+	g_ThreadSlot.reset(slot);
+	return slot->index;
+}
+
+//! copy of a thread slot, only accessed by the thread holding the slot (one cache line each to avoid false sharing)
+struct ParserSlot
+{
+	CSFunctionParser* copy;
+	bool inUse;
+	char padding[PARSER_POOL_CACHE_LINE-sizeof(CSFunctionParser*)-sizeof(bool)];
+};
+
+struct CSFunctionParserPoolPrivate
+{
+	boost::mutex m_Mutex;
+	//! the thread slots are allocated by the first Acquire()
+	bool m_SlotsReady;
+	ParserSlot* m_Slots;
+};
+
+CSFunctionParserPool::CSFunctionParserPool()
+{
+	m_Parser = NULL;
+	d_ptr = new CSFunctionParserPoolPrivate;
+	d_ptr->m_SlotsReady = false;
+	d_ptr->m_Slots = NULL;
+}
+
+CSFunctionParserPool::~CSFunctionParserPool()
+{
+	Clear();
+	delete d_ptr;
+	d_ptr = NULL;
+}
+
+void CSFunctionParserPool::SetParser(const CSFunctionParser* parser)
+{
+	Clear();
+	m_Parser = parser;
+}
+
+void CSFunctionParserPool::Clear()
+{
+	boost::mutex::scoped_lock lock(d_ptr->m_Mutex);
+	for (size_t n=0;n<m_Copies.size();++n)
+		delete m_Copies.at(n);
+	m_Copies.clear();
+	if (d_ptr->m_Slots)
+		for (unsigned int n=0;n<PARSER_POOL_THREAD_SLOTS;++n)
+			delete d_ptr->m_Slots[n].copy;
+	delete[] d_ptr->m_Slots;
+	d_ptr->m_Slots = NULL;
+	d_ptr->m_SlotsReady = false;
+}
+
+CSFunctionParser* CSFunctionParserPool::NewCopy() const
+{
+	// the copy shares the (reference counted) data of the original until the deep copy, thus this has to be done while locked
+	CSFunctionParser* parser = new CSFunctionParser(*m_Parser);
+	parser->ForceDeepCopy();
+	return parser;
+}
+
+CSFunctionParser* CSFunctionParserPool::Acquire()
+{
+	if (m_Parser==NULL)
+		return NULL;
+	unsigned int index = GetThreadSlot();
+	if (index<PARSER_POOL_THREAD_SLOTS)
+	{
+		if (LoadAcquire(d_ptr->m_SlotsReady)==false)
+		{
+			boost::mutex::scoped_lock lock(d_ptr->m_Mutex);
+			if (d_ptr->m_SlotsReady==false)
+			{
+				d_ptr->m_Slots = new ParserSlot[PARSER_POOL_THREAD_SLOTS];
+				for (unsigned int n=0;n<PARSER_POOL_THREAD_SLOTS;++n)
+				{
+					d_ptr->m_Slots[n].copy = NULL;
+					d_ptr->m_Slots[n].inUse = false;
+				}
+				StoreRelease(d_ptr->m_SlotsReady, true);
+			}
+		}
+		// the own copy of this thread without locking, unless it is already in use by a nested Acquire()
+		ParserSlot &slot = d_ptr->m_Slots[index];
+		if (slot.inUse==false)
+		{
+			if (slot.copy==NULL)
+			{
+				boost::mutex::scoped_lock lock(d_ptr->m_Mutex);
+				slot.copy = NewCopy();
+			}
+			slot.inUse = true;
+			return slot.copy;
+		}
+	}
+	boost::mutex::scoped_lock lock(d_ptr->m_Mutex);
+	if (m_Copies.size()>0)
+	{
+		CSFunctionParser* parser = m_Copies.back();
+		m_Copies.pop_back();
+		return parser;
+	}
+	return NewCopy();
+}
+
+void CSFunctionParserPool::Release(CSFunctionParser* parser)
+{
+	if (parser==NULL)
+		return;
+	unsigned int index = GetThreadSlot();
+	if ((index<PARSER_POOL_THREAD_SLOTS) && LoadAcquire(d_ptr->m_SlotsReady) && (d_ptr->m_Slots[index].copy==parser))
+	{
+		d_ptr->m_Slots[index].inUse = false;
+		return;
+	}
+	boost::mutex::scoped_lock lock(d_ptr->m_Mutex);
+	m_Copies.push_back(parser);
+}
+
+double CSFunctionParserPool::Eval(const double* vars, int &EC)
+{
+	CSFunctionParser* parser = Acquire();
+	if (parser==NULL)
+	{
+		EC = -1;
+		return 0;
+	}
+	double value = parser->Eval(vars);
+	EC = parser->EvalError();
+	Release(parser);
+	return value;
+}
@@ -18,6 +18,7 @@
 #ifndef CSFUNCTIONPARSER_H
 #define CSFUNCTIONPARSER_H
 
+#include <vector>
 #include "CSXCAD_Global.h"
 #include "fparser.hh"
 
@@ -31,4 +32,47 @@ public:
     CSFunctionParser();
 };
 
+struct CSFunctionParserPoolPrivate;
+
+//! Pool of independent copies of a parsed function, used for concurrent evaluations
+/*!
+ FunctionParser::Eval is not reentrant, every thread has to evaluate its own (deep) copy of the parsed function.
+ A copy is taken from the pool for the time of an evaluation (or a batch of evaluations) and returned afterwards.
+ Each thread gets its own copy, which is taken and returned without locking, only further threads (or nested evaluations) share the locked list of copies.
+ All methods except SetParser and Clear are thread-safe.
+*/
+class CSXCAD_EXPORT CSFunctionParserPool
+{
+public:
+	CSFunctionParserPool();
+	virtual ~CSFunctionParserPool();
+
+	//! Set the parsed function to evaluate, all existing copies are deleted. The pool does not take ownership of the parser.
+	void SetParser(const CSFunctionParser* parser);
+	const CSFunctionParser* GetParser() const {return m_Parser;}
+
+	//! Take a copy of the parsed function, it has to be returned using Release(). \return NULL if no parser is set
+	CSFunctionParser* Acquire();
+	//! Return a copy taken by Acquire()
+	void Release(CSFunctionParser* parser);
+
+	//! Evaluate the function for the given variables using a copy of the pool, the evaluation error code is returned in EC.
+	double Eval(const double* vars, int &EC);
+
+	//! Delete all copies
+	void Clear();
+
+protected:
+	const CSFunctionParser* m_Parser;
+	//! copies not in use, shared by all threads without an own copy
+	std::vector<CSFunctionParser*> m_Copies;
+	//! Create a deep copy of the parser, the pool has to be locked
+	CSFunctionParser* NewCopy() const;
+	CSFunctionParserPoolPrivate* d_ptr; //!< pointer to private data structure, to hide the boost dependency from applications
+
+private:
+	CSFunctionParserPool(const CSFunctionParserPool&);
+	CSFunctionParserPool& operator=(const CSFunctionParserPool&);
+};
+
 #endif // CSFUNCTIONPARSER_H
@@ -0,0 +1,399 @@
+/*
+*	Copyright (C) 2016 Thorsten Liebig (Thorsten.Liebig@gmx.de)
+*
+*	This program is free software: you can redistribute it and/or modify
+*	it under the terms of the GNU Lesser General Public License as published
+*	by the Free Software Foundation, either version 3 of the License, or
+*	(at your option) any later version.
+*
+*	This program is distributed in the hope that it will be useful,
+*	but WITHOUT ANY WARRANTY; without even the implied warranty of
+*	MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+*	GNU Lesser General Public License for more details.
+*
+*	You should have received a copy of the GNU Lesser General Public License
+*	along with this program.  If not, see <http://www.gnu.org/licenses/>.
+*/
+
+#include <algorithm>
+#include <iostream>
+#include <math.h>
+
+#include "CSGridVoxelizer.h"
+#include "ContinuousStructure.h"
+#include "CSRectGrid.h"
+#include "CSPrimitives.h"
+#include "CSPrimPolyhedron.h"
+
+CSGridVoxelizer::CSGridVoxelizer(ContinuousStructure* CSX, CSRectGrid* grid)
+{
+	m_CSX = CSX;
+	m_Grid = grid;
+	if ((m_Grid==NULL) && (m_CSX!=NULL))
+		m_Grid = m_CSX->GetGrid();
+	for (int n=0;n<3;++n)
+	{
+		m_CellCenter[n] = true;
+		m_NumSamples[n] = 0;
+	}
+	m_MarkUsed = false;
+	m_NumTests = 0;
+	m_Type = CSProperties::ANY;
+}
+
+CSGridVoxelizer::~CSGridVoxelizer()
+{
+}
+
+void CSGridVoxelizer::SetSampleAtCellCenter(int ny, bool val)
+{
+	if ((ny<0) || (ny>2))
+		return;
+	m_CellCenter[ny] = val;
+}
+
+void CSGridVoxelizer::SetSampleAtCellCenter(bool val)
+{
+	for (int n=0;n<3;++n)
+		m_CellCenter[n] = val;
+}
+
+bool CSGridVoxelizer::GetSampleAtCellCenter(int ny) const
+{
+	if ((ny<0) || (ny>2))
+		return false;
+	return m_CellCenter[ny];
+}
+
+unsigned int CSGridVoxelizer::GetNumSamples(int ny) const
+{
+	if ((ny<0) || (ny>2))
+		return 0;
+	return m_NumSamples[ny];
+}
+
+const double* CSGridVoxelizer::GetSamplePositions(int ny) const
+{
+	if ((ny<0) || (ny>2) || (m_Samples[ny].empty()))
+		return NULL;
+	return &m_Samples[ny][0];
+}
+
+CSProperties* CSGridVoxelizer::GetProperty(unsigned int i, unsigned int j, unsigned int k) const
+{
+	if ((i>=m_NumSamples[0]) || (j>=m_NumSamples[1]) || (k>=m_NumSamples[2]))
+		return NULL;
+	int idx = m_PropIndex[GetIndex(i,j,k)];
+	if (idx<0)
+		return NULL;
+	return m_CSX->GetProperty(idx);
+}
+
+bool CSGridVoxelizer::SetupSamples()
+{
+	for (int n=0;n<3;++n)
+	{
+		m_Samples[n].clear();
+		m_NumSamples[n] = 0;
+		size_t qty = m_Grid->GetQtyLines(n);
+		if (qty==0)
+			return false;
+		std::vector<double> lines(qty);
+		for (size_t i=0;i<qty;++i)
+			lines[i] = m_Grid->GetLine(n,i);
+		std::sort(lines.begin(),lines.end());
+		if (m_CellCenter[n] && (qty>1))
+		{
+			for (size_t i=0;i<qty-1;++i)
+				m_Samples[n].push_back(0.5*(lines[i]+lines[i+1]));
+		}
+		else
+			m_Samples[n] = lines;
+		m_NumSamples[n] = m_Samples[n].size();
+	}
+	return true;
+}
+
+bool CSGridVoxelizer::Voxelize(CSProperties::PropertyType type)
+{
+	m_Type = type;
+	m_NumTests = 0;
+	m_PropIndex.clear();
+	m_Priority.clear();
+	m_PrimID.clear();
+	if ((m_CSX==NULL) || (m_Grid==NULL))
+		return false;
+	if (SetupSamples()==false)
+		return false;
+
+	size_t numSamples = (size_t)m_NumSamples[0]*m_NumSamples[1]*m_NumSamples[2];
+	m_PropIndex.resize(numSamples,-1);
+	m_Priority.resize(numSamples,0);
+	m_PrimID.resize(numSamples,(unsigned int)-1);
+	StoreProperties();
+
+	// highest priority first, a sample point claimed by a primitive can not be taken by any later one
+	std::vector<CSPrimitives*> vPrimitives = m_CSX->GetPrimitivesByPriority(type);
+	double tol = m_CSX->GetDrawingTolerance();
+	unsigned int range[6];
+	for (size_t p=0;p<vPrimitives.size();++p)
+	{
+		if (GetSampleRange(vPrimitives.at(p), range, tol))
+			VoxelizePrimitive(vPrimitives.at(p), range);
+	}
+	return true;
+}
+
+bool CSGridVoxelizer::VoxelizeRegions(const double* regions, size_t numRegions)
+{
+	if (m_PropIndex.empty())
+		return Voxelize(m_Type);
+	// the grid must not have changed since the last voxelization
+	std::vector<double> samples[3];
+	for (int n=0;n<3;++n)
+		samples[n].swap(m_Samples[n]);
+	if (SetupSamples()==false)
+		return Voxelize(m_Type);
+	for (int n=0;n<3;++n)
+		if (samples[n]!=m_Samples[n])
+			return Voxelize(m_Type);
+	// the stored property indices are invalid if any property was renumbered, e.g. by deleting a property
+	if (HasPropertyIDs()==false)
+		return Voxelize(m_Type);
+	StoreProperties();
+
+	m_NumTests = 0;
+	std::vector<CSPrimitives*> vPrimitives = m_CSX->GetPrimitivesByPriority(m_Type);
+	double tol = m_CSX->GetDrawingTolerance();
+	unsigned int region[6];
+	unsigned int range[6];
+	for (size_t r=0;r<numRegions;++r)
+	{
+		if (GetSampleRange(&regions[6*r], region, tol)==false)
+			continue;
+		// reset all samples of the region and rasterize all primitives into it again
+		for (unsigned int k=region[4];k<region[5];++k)
+			for (unsigned int j=region[2];j<region[3];++j)
+			{
+				size_t idx = GetIndex(region[0],j,k);
+				for (unsigned int i=region[0];i<region[1];++i,++idx)
+				{
+					m_PropIndex[idx] = -1;
+					m_Priority[idx] = 0;
+					m_PrimID[idx] = (unsigned int)-1;
+				}
+			}
+		for (size_t p=0;p<vPrimitives.size();++p)
+		{
+			if (GetSampleRange(vPrimitives.at(p), range, tol)==false)
+				continue;
+			// intersection with the region
+			bool empty = false;
+			for (int n=0;n<3;++n)
+			{
+				range[2*n] = std::max(range[2*n], region[2*n]);
+				range[2*n+1] = std::min(range[2*n+1], region[2*n+1]);
+				empty = empty || (range[2*n]>=range[2*n+1]);
+			}
+			if (!empty)
+				VoxelizePrimitive(vPrimitives.at(p), range);
+		}
+	}
+	return true;
+}
+
+void CSGridVoxelizer::StoreProperties()
+{
+	m_Properties.resize(m_CSX->GetQtyProperties());
+	m_PropertyIDs.resize(m_Properties.size());
+	for (size_t n=0;n<m_Properties.size();++n)
+	{
+		m_Properties[n] = m_CSX->GetProperty(n);
+		m_PropertyIDs[n] = m_Properties[n]->GetID();
+	}
+}
+
+bool CSGridVoxelizer::HasPropertyIDs() const
+{
+	// properties added since have a new ID, the samples of removed properties are within the changed regions
+	size_t num = std::min(m_Properties.size(), (size_t)m_CSX->GetQtyProperties());
+	for (size_t n=0;n<num;++n)
+	{
+		CSProperties* prop = m_CSX->GetProperty(n);
+		if ((prop!=m_Properties[n]) || (prop->GetID()!=m_PropertyIDs[n]))
+			return false;
+	}
+	return true;
+}
+
+bool CSGridVoxelizer::VoxelizeDirtyRegions()
+{
+	if (m_CSX==NULL)
+		return false;
+	if (m_CSX->GetDirtyRegionsUnbounded())
+		return Voxelize(m_Type);
+	const std::vector<double> &regions = m_CSX->GetDirtyRegions();
+	if (regions.empty())
+		return VoxelizeRegions(NULL, 0);
+	return VoxelizeRegions(&regions[0], regions.size()/6);
+}
+
+bool CSGridVoxelizer::GetSampleRange(CSPrimitives* prim, unsigned int range[6], double tol) const
+{
+	double box[6];
+	if (prim->GetCartesianBoundBox(box)==false)
+		return GetSampleRange((const double*)NULL, range, tol);
+	return GetSampleRange(box, range, tol);
+}
+
+bool CSGridVoxelizer::GetSampleRange(const double* cartBox, unsigned int range[6], double tol) const
+{
+	// default: all sample points
+	for (int n=0;n<3;++n)
+	{
+		range[2*n] = 0;
+		range[2*n+1] = m_NumSamples[n];
+	}
+
+	if (cartBox==NULL)
+		return true;
+	double box[6];
+	for (int n=0;n<6;++n)
+		box[n] = cartBox[n];
+	for (int n=0;n<3;++n)
+	{
+		double eps = tol + 1e-12*(fabs(box[2*n])+fabs(box[2*n+1]));
+		box[2*n] -= eps;
+		box[2*n+1] += eps;
+	}
+
+	CoordinateSystem meshType = m_Grid->GetMeshType();
+	double limits[6];
+	bool limited[3] = {true, true, true};
+	if (meshType==CARTESIAN)
+	{
+		for (int n=0;n<6;++n)
+			limits[n] = box[n];
+	}
+	else if (meshType==CYLINDRICAL)
+	{
+		// radial range of the Cartesian box, the angle is not limited
+		double dx = std::max(0.0, std::max(box[0], -box[1]));
+		double dy = std::max(0.0, std::max(box[2], -box[3]));
+		double mx = std::max(fabs(box[0]), fabs(box[1]));
+		double my = std::max(fabs(box[2]), fabs(box[3]));
+		limits[0] = sqrt(dx*dx+dy*dy);
+		limits[1] = sqrt(mx*mx+my*my);
+		limited[1] = false;
+		limits[4] = box[4];
+		limits[5] = box[5];
+	}
+	else
+		return true;
+
+	for (int n=0;n<3;++n)
+	{
+		if (limited[n]==false)
+			continue;
+		const std::vector<double> &samples = m_Samples[n];
+		range[2*n] = std::lower_bound(samples.begin(), samples.end(), limits[2*n]) - samples.begin();
+		range[2*n+1] = std::upper_bound(samples.begin(), samples.end(), limits[2*n+1]) - samples.begin();
+		if (range[2*n]>=range[2*n+1])
+			return false;
+	}
+	return true;
+}
+
+void CSGridVoxelizer::VoxelizePrimitive(CSPrimitives* prim, const unsigned int range[6])
+{
+	if ((prim->GetType()==CSPrimitives::POLYHEDRON) || (prim->GetType()==CSPrimitives::POLYHEDRONREADER))
+	{
+		if (VoxelizePolyhedron(static_cast<CSPrimPolyhedron*>(prim), range))
+			return;
+	}
+
+	// use the compiled snapshot of the structure if available
+	const CSCompiledScene* scene = m_CSX->GetCompiledScene();
+	int rank = scene->IsValid() ? scene->GetRank(prim) : -1;
+
+	CSProperties* prop = prim->GetProperty();
+	int propIdx = (int)prop->GetID();
+	int prio = prim->GetPriority();
+	unsigned int primID = prim->GetID();
+	// same tolerance as used by ContinuousStructure::GetPropertyByCoordPriority
+	double tol = m_CSX->GetDrawingTolerance();
+	bool found = false;
+	double coord[3];
+	for (unsigned int k=range[4];k<range[5];++k)
+	{
+		coord[2] = m_Samples[2][k];
+		for (unsigned int j=range[2];j<range[3];++j)
+		{
+			coord[1] = m_Samples[1][j];
+			size_t idx = GetIndex(range[0],j,k);
+			for (unsigned int i=range[0];i<range[1];++i,++idx)
+			{
+				if (m_PropIndex[idx]>=0)
+					continue; // already claimed by a primitive with higher or equal priority
+				coord[0] = m_Samples[0][i];
+				++m_NumTests;
+				if ((rank>=0) ? scene->IsInside(rank, coord) : prim->IsInside(coord, tol))
+				{
+					m_PropIndex[idx] = propIdx;
+					m_Priority[idx] = prio;
+					m_PrimID[idx] = primID;
+					found = true;
+				}
+			}
+		}
+	}
+	if (found && m_MarkUsed)
+		prim->SetPrimitiveUsed(true);
+}
+
+bool CSGridVoxelizer::VoxelizePolyhedron(CSPrimPolyhedron* prim, const unsigned int range[6])
+{
+	if (m_Grid->GetMeshType()!=CARTESIAN)
+		return false;
+	// cast a single line in x-direction for each (y,z) sample
+	std::vector<unsigned int> lineOffsets;
+	std::vector<double> intervals;
+	if (prim->GetInsideIntervals(0, &m_Samples[1][range[2]], range[3]-range[2], &m_Samples[2][range[4]], range[5]-range[4], lineOffsets, intervals)==false)
+		return false;
+
+	CSProperties* prop = prim->GetProperty();
+	int propIdx = (int)prop->GetID();
+	int prio = prim->GetPriority();
+	unsigned int primID = prim->GetID();
+	bool found = false;
+	std::vector<double>::const_iterator first = m_Samples[0].begin()+range[0];
+	std::vector<double>::const_iterator last = m_Samples[0].begin()+range[1];
+	size_t line = 0;
+	for (unsigned int k=range[4];k<range[5];++k)
+	{
+		for (unsigned int j=range[2];j<range[3];++j,++line)
+		{
+			++m_NumTests;
+			size_t idx0 = GetIndex(0,j,k);
+			for (unsigned int n=lineOffsets[line];n<lineOffsets[line+1];++n)
+			{
+				// all samples inside the interval, including samples on its boundary
+				unsigned int start = std::lower_bound(first, last, intervals[2*n]) - m_Samples[0].begin();
+				unsigned int stop = std::upper_bound(first, last, intervals[2*n+1]) - m_Samples[0].begin();
+				for (unsigned int i=start;i<stop;++i)
+				{
+					size_t idx = idx0+i;
+					if (m_PropIndex[idx]>=0)
+						continue; // already claimed by a primitive with higher or equal priority
+					m_PropIndex[idx] = propIdx;
+					m_Priority[idx] = prio;
+					m_PrimID[idx] = primID;
+					found = true;
+				}
+			}
+		}
+	}
+	if (found && m_MarkUsed)
+		prim->SetPrimitiveUsed(true);
+	return true;
+}
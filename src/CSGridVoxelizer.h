@@ -0,0 +1,124 @@
+/*
+*	Copyright (C) 2016 Thorsten Liebig (Thorsten.Liebig@gmx.de)
+*
+*	This program is free software: you can redistribute it and/or modify
+*	it under the terms of the GNU Lesser General Public License as published
+*	by the Free Software Foundation, either version 3 of the License, or
+*	(at your option) any later version.
+*
+*	This program is distributed in the hope that it will be useful,
+*	but WITHOUT ANY WARRANTY; without even the implied warranty of
+*	MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+*	GNU Lesser General Public License for more details.
+*
+*	You should have received a copy of the GNU Lesser General Public License
+*	along with this program.  If not, see <http://www.gnu.org/licenses/>.
+*/
+
+#pragma once
+
+#include <vector>
+#include "CSXCAD_Global.h"
+#include "CSProperties.h"
+
+class ContinuousStructure;
+class CSRectGrid;
+class CSPrimitives;
+class CSPrimPolyhedron;
+
+//! Rasterize all primitives of a structure onto the sample points of a rectilinear grid.
+/*!
+ The sample points are either the cell centers or, separately for each direction, the grid lines themselves (e.g. for staggered positions).
+ Each primitive only visits the sample points inside its bounding box. Polyhedra are rasterized line by line along the x-direction (Cartesian grids only). Primitives are processed with decreasing priority and a sample point
+ is only tested if no primitive has claimed it before, thus the result is identical to ContinuousStructure::GetPropertyByCoordPriority for each point.
+
+ If the structure has a valid compiled snapshot, its inside tests are used. \sa ContinuousStructure::SetUseCompiledScene
+
+ The results are stored as dense arrays with the x-index running fastest. \sa GetIndex
+ */
+class CSXCAD_EXPORT CSGridVoxelizer
+{
+public:
+	//! Create a voxelizer for the given structure and grid. If no grid is given, the grid of the structure is used.
+	CSGridVoxelizer(ContinuousStructure* CSX, CSRectGrid* grid=NULL);
+	virtual ~CSGridVoxelizer();
+
+	//! Sample at the center between two grid lines (default) or at the grid lines itself in the given direction.
+	void SetSampleAtCellCenter(int ny, bool val);
+	//! Sample at the cell centers in all directions (true) or at the grid lines (false).
+	void SetSampleAtCellCenter(bool val);
+	bool GetSampleAtCellCenter(int ny) const;
+
+	//! Mark all primitives found at any sample point as used. \sa CSPrimitives::SetPrimitiveUsed
+	void SetMarkFoundAsUsed(bool val) {m_MarkUsed=val;}
+
+	//! Rasterize all primitives with properties of the given type. \return false if the grid is invalid.
+	bool Voxelize(CSProperties::PropertyType type=CSProperties::ANY);
+
+	//! Rasterize again only the sample points inside the given Cartesian boxes (6 values each), using the property type of the last Voxelize() call.
+	/*!
+	 The result is patched in place and identical to a full voxelization, if all changes of the structure since the last voxelization are within the boxes.
+	 A full voxelization is done if there is no previous result, the grid has changed or any property ID has changed (e.g. by deleting a property). \return false if the grid is invalid.
+	 */
+	bool VoxelizeRegions(const double* regions, size_t numRegions);
+	//! Rasterize again all regions changed by ContinuousStructure::Update since the structure's dirty regions were cleared. \sa ContinuousStructure::SetTrackDirtyRegions, VoxelizeRegions
+	/*!
+	 The dirty regions are not cleared, use ContinuousStructure::ClearDirtyRegions once all consumers have processed them.
+	 */
+	bool VoxelizeDirtyRegions();
+
+	//! Get the number of sample points in the given direction
+	unsigned int GetNumSamples(int ny) const;
+	//! Get the total number of sample points
+	size_t GetNumSamples() const {return m_PropIndex.size();}
+	//! Get the sample positions in the given direction
+	const double* GetSamplePositions(int ny) const;
+
+	//! Get the linear index for the sample position (i,j,k)
+	size_t GetIndex(unsigned int i, unsigned int j, unsigned int k) const {return i + (size_t)m_NumSamples[0]*(j + (size_t)m_NumSamples[1]*k);}
+
+	//! Get the property index (\sa ContinuousStructure::GetProperty) for all sample points, -1 if no property was found
+	const int* GetPropertyIndexArray() const {return m_PropIndex.empty() ? NULL : &m_PropIndex[0];}
+	//! Get the priority of the found primitives for all sample points (undefined if no property was found)
+	const int* GetPriorityArray() const {return m_Priority.empty() ? NULL : &m_Priority[0];}
+	//! Get the unique ID of the found primitives for all sample points, (unsigned int)-1 if no primitive was found
+	const unsigned int* GetPrimitiveIDArray() const {return m_PrimID.empty() ? NULL : &m_PrimID[0];}
+
+	//! Get the property found at the given sample position, NULL if none was found
+	CSProperties* GetProperty(unsigned int i, unsigned int j, unsigned int k) const;
+
+	//! Get the number of inside tests done by the last Voxelize() or VoxelizeRegions() call
+	size_t GetNumInsideTests() const {return m_NumTests;}
+
+protected:
+	ContinuousStructure* m_CSX;
+	CSRectGrid* m_Grid;
+	bool m_CellCenter[3];
+	bool m_MarkUsed;
+	CSProperties::PropertyType m_Type;
+
+	unsigned int m_NumSamples[3];
+	std::vector<double> m_Samples[3];
+
+	std::vector<int> m_PropIndex;
+	std::vector<int> m_Priority;
+	std::vector<unsigned int> m_PrimID;
+	size_t m_NumTests;
+
+	//! all properties of the structure and their IDs at the last voxelization \sa GetPropertyIndexArray
+	std::vector<CSProperties*> m_Properties;
+	std::vector<unsigned int> m_PropertyIDs;
+	void StoreProperties();
+	//! Check if all properties of the last voxelization still have the same ID
+	bool HasPropertyIDs() const;
+
+	bool SetupSamples();
+	//! Get the range of sample points a primitive can cover, in sample index (start,stop) pairs for each direction. \return false if no sample can be covered
+	bool GetSampleRange(CSPrimitives* prim, unsigned int range[6], double tol) const;
+	//! Get the range of sample points inside a Cartesian box, all sample points if the box is NULL
+	bool GetSampleRange(const double* cartBox, unsigned int range[6], double tol) const;
+	//! Rasterize the given primitive into all sample points inside the given range not claimed by any other primitive yet.
+	void VoxelizePrimitive(CSPrimitives* prim, const unsigned int range[6]);
+	//! Rasterize a polyhedron by its inside intervals along lines in x-direction (one inside test per line). \return false if not possible
+	bool VoxelizePolyhedron(CSPrimPolyhedron* prim, const unsigned int range[6]);
+};
@@ -0,0 +1,193 @@
+/*
+*	Copyright (C) 2016 Thorsten Liebig (Thorsten.Liebig@gmx.de)
+*
+*	This program is free software: you can redistribute it and/or modify
+*	it under the terms of the GNU Lesser General Public License as published
+*	by the Free Software Foundation, either version 3 of the License, or
+*	(at your option) any later version.
+*
+*	This program is distributed in the hope that it will be useful,
+*	but WITHOUT ANY WARRANTY; without even the implied warranty of
+*	MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+*	GNU Lesser General Public License for more details.
+*
+*	You should have received a copy of the GNU Lesser General Public License
+*	along with this program.  If not, see <http://www.gnu.org/licenses/>.
+*/
+
+#include <algorithm>
+
+#include "CSIndexVolume.h"
+
+// the brick edge length is fixed to 8 cells (shift by 3, 512 cells per brick)
+#define INDEX_BRICK_SIZE 8
+#define INDEX_BRICK_CELLS 512
+
+CSIndexVolume::CSIndexVolume()
+{
+	m_Type = EMPTY;
+	for (int n=0;n<3;++n)
+	{
+		m_Size[n] = 0;
+		m_NumBricks[n] = 0;
+	}
+}
+
+CSIndexVolume::~CSIndexVolume()
+{
+}
+
+void CSIndexVolume::Clear()
+{
+	m_Type = EMPTY;
+	for (int n=0;n<3;++n)
+	{
+		m_Size[n] = 0;
+		m_NumBricks[n] = 0;
+	}
+	// release the memory, clear() is not required to do so
+	std::vector<uint8_t>().swap(m_Dense8);
+	std::vector<uint16_t>().swap(m_Dense16);
+	std::vector<uint32_t>().swap(m_BrickTable);
+}
+
+size_t CSIndexVolume::GetMemoryUsage() const
+{
+	return m_Dense8.size()*sizeof(uint8_t) + m_Dense16.size()*sizeof(uint16_t) + m_BrickTable.size()*sizeof(uint32_t);
+}
+
+bool CSIndexVolume::SetData(const uint8_t* data, const unsigned int size[3], bool allowSparse)
+{
+	return SetDataT(data, size, allowSparse);
+}
+
+bool CSIndexVolume::SetData(const uint16_t* data, const unsigned int size[3], bool allowSparse)
+{
+	return SetDataT(data, size, allowSparse);
+}
+
+template <typename T> bool CSIndexVolume::SetDataT(const T* data, const unsigned int size[3], bool allowSparse)
+{
+	Clear();
+	if ((data==NULL) || (size[0]==0) || (size[1]==0) || (size[2]==0))
+		return false;
+
+	size_t numCells = 1;
+	for (int n=0;n<3;++n)
+	{
+		m_Size[n] = size[n];
+		m_NumBricks[n] = (size[n]+INDEX_BRICK_SIZE-1)/INDEX_BRICK_SIZE;
+		numCells *= size[n];
+	}
+
+	// narrow to the smallest width able to store the largest index
+	T maxValue = *std::max_element(data, data+numCells);
+	bool wide = (maxValue>0xFF);
+
+	if (allowSparse)
+	{
+		// count the bricks with a single index to estimate the sparse memory usage
+		size_t numBricks = (size_t)m_NumBricks[0]*m_NumBricks[1]*m_NumBricks[2];
+		size_t nonUniform = 0;
+		for (unsigned int bz=0;bz<m_NumBricks[2];++bz)
+			for (unsigned int by=0;by<m_NumBricks[1];++by)
+				for (unsigned int bx=0;bx<m_NumBricks[0];++bx)
+				{
+					unsigned int start[3] = {bx*INDEX_BRICK_SIZE, by*INDEX_BRICK_SIZE, bz*INDEX_BRICK_SIZE};
+					unsigned int stop[3];
+					for (int n=0;n<3;++n)
+						stop[n] = std::min(start[n]+INDEX_BRICK_SIZE, m_Size[n]);
+					T first = data[start[0] + (size_t)m_Size[0]*(start[1] + (size_t)m_Size[1]*start[2])];
+					bool uniform = true;
+					for (unsigned int k=start[2];(k<stop[2]) && uniform;++k)
+						for (unsigned int j=start[1];(j<stop[1]) && uniform;++j)
+						{
+							const T* line = data + (size_t)m_Size[0]*(j + (size_t)m_Size[1]*k);
+							for (unsigned int i=start[0];i<stop[0];++i)
+								if (line[i]!=first)
+								{
+									uniform = false;
+									break;
+								}
+						}
+					if (uniform==false)
+						++nonUniform;
+				}
+		size_t sparseMem = numBricks*sizeof(uint32_t) + nonUniform*INDEX_BRICK_CELLS*(wide ? 2 : 1);
+		size_t denseMem = numCells*(wide ? 2 : 1);
+		if (sparseMem<denseMem)
+		{
+			if (wide)
+			{
+				StoreSparse(data, m_Dense16);
+				m_Type = SPARSE16;
+			}
+			else
+			{
+				StoreSparse(data, m_Dense8);
+				m_Type = SPARSE8;
+			}
+			return true;
+		}
+	}
+
+	if (wide)
+	{
+		StoreDense(data, m_Dense16);
+		m_Type = DENSE16;
+	}
+	else
+	{
+		StoreDense(data, m_Dense8);
+		m_Type = DENSE8;
+	}
+	return true;
+}
+
+template <typename T, typename S> void CSIndexVolume::StoreDense(const T* data, std::vector<S> &dense)
+{
+	size_t numCells = (size_t)m_Size[0]*m_Size[1]*m_Size[2];
+	dense.resize(numCells);
+	for (size_t n=0;n<numCells;++n)
+		dense[n] = (S)data[n];
+}
+
+template <typename T, typename S> void CSIndexVolume::StoreSparse(const T* data, std::vector<S> &pool)
+{
+	size_t numBricks = (size_t)m_NumBricks[0]*m_NumBricks[1]*m_NumBricks[2];
+	m_BrickTable.resize(numBricks);
+	S brick[INDEX_BRICK_CELLS];
+	size_t id = 0;
+	for (unsigned int bz=0;bz<m_NumBricks[2];++bz)
+		for (unsigned int by=0;by<m_NumBricks[1];++by)
+			for (unsigned int bx=0;bx<m_NumBricks[0];++bx,++id)
+			{
+				unsigned int start[3] = {bx*INDEX_BRICK_SIZE, by*INDEX_BRICK_SIZE, bz*INDEX_BRICK_SIZE};
+				unsigned int stop[3];
+				for (int n=0;n<3;++n)
+					stop[n] = std::min(start[n]+INDEX_BRICK_SIZE, m_Size[n]);
+				// cells outside the volume (bricks at the upper boundary) repeat the first value
+				S first = (S)data[start[0] + (size_t)m_Size[0]*(start[1] + (size_t)m_Size[1]*start[2])];
+				std::fill(brick, brick+INDEX_BRICK_CELLS, first);
+				bool uniform = true;
+				for (unsigned int k=start[2];k<stop[2];++k)
+					for (unsigned int j=start[1];j<stop[1];++j)
+					{
+						const T* line = data + (size_t)m_Size[0]*(j + (size_t)m_Size[1]*k);
+						S* local = brick + ((j-start[1])<<3) + ((k-start[2])<<6);
+						for (unsigned int i=start[0];i<stop[0];++i)
+						{
+							local[i-start[0]] = (S)line[i];
+							if ((S)line[i]!=first)
+								uniform = false;
+						}
+					}
+				if (uniform)
+					m_BrickTable[id] = UNIFORM_BRICK | (uint32_t)first;
+				else
+				{
+					m_BrickTable[id] = (uint32_t)(pool.size()/INDEX_BRICK_CELLS);
+					pool.insert(pool.end(), brick, brick+INDEX_BRICK_CELLS);
+				}
+			}
+}
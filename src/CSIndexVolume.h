@@ -0,0 +1,110 @@
+/*
+*	Copyright (C) 2016 Thorsten Liebig (Thorsten.Liebig@gmx.de)
+*
+*	This program is free software: you can redistribute it and/or modify
+*	it under the terms of the GNU Lesser General Public License as published
+*	by the Free Software Foundation, either version 3 of the License, or
+*	(at your option) any later version.
+*
+*	This program is distributed in the hope that it will be useful,
+*	but WITHOUT ANY WARRANTY; without even the implied warranty of
+*	MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+*	GNU Lesser General Public License for more details.
+*
+*	You should have received a copy of the GNU Lesser General Public License
+*	along with this program.  If not, see <http://www.gnu.org/licenses/>.
+*/
+
+#pragma once
+
+#include <vector>
+#include "stdint.h"
+#include "CSXCAD_Global.h"
+
+//! Compact storage of a 3D volume of (material) indices with fast random access.
+/*!
+ The indices are stored with the smallest width (8 or 16bit) for the largest index.
+ Optionally the volume is split into bricks of 8x8x8 cells and bricks with a single index are stored as this index only (sparse bricks).
+ The sparse brick storage is only used if it needs less memory than the dense storage.
+ The linear position is x + Nx*(y + Ny*z).
+ */
+class CSXCAD_EXPORT CSIndexVolume
+{
+public:
+	enum StorageType
+	{
+		EMPTY, DENSE8, DENSE16, SPARSE8, SPARSE16
+	};
+
+	CSIndexVolume();
+	virtual ~CSIndexVolume();
+
+	//! Remove all data
+	void Clear();
+
+	//! Store a copy of the given data with the given size (x,y,z). \return false on invalid arguments
+	bool SetData(const uint8_t* data, const unsigned int size[3], bool allowSparse=true);
+	//! Store a copy of the given data with the given size (x,y,z). \return false on invalid arguments
+	bool SetData(const uint16_t* data, const unsigned int size[3], bool allowSparse=true);
+
+	bool IsValid() const {return m_Type!=EMPTY;}
+	StorageType GetStorageType() const {return m_Type;}
+	unsigned int GetSize(int ny) const {if ((ny>=0) && (ny<3)) return m_Size[ny]; return 0;}
+
+	//! Get the memory used for the index storage in bytes
+	size_t GetMemoryUsage() const;
+
+	//! Get the index at the given cell
+	unsigned int Get(unsigned int i, unsigned int j, unsigned int k) const
+	{
+		switch (m_Type)
+		{
+		case DENSE8:
+			return m_Dense8[i + (size_t)m_Size[0]*(j + (size_t)m_Size[1]*k)];
+		case DENSE16:
+			return m_Dense16[i + (size_t)m_Size[0]*(j + (size_t)m_Size[1]*k)];
+		case SPARSE8:
+		case SPARSE16:
+			{
+				uint32_t entry = m_BrickTable[(i>>3) + (size_t)m_NumBricks[0]*((j>>3) + (size_t)m_NumBricks[1]*(k>>3))];
+				if (entry & UNIFORM_BRICK)
+					return entry & ~UNIFORM_BRICK;
+				size_t pos = ((size_t)entry<<9) + (i&7) + ((j&7)<<3) + ((k&7)<<6);
+				if (m_Type==SPARSE8)
+					return m_Dense8[pos];
+				return m_Dense16[pos];
+			}
+		default:
+			return 0;
+		}
+	}
+
+	//! Get the index at the given linear position
+	unsigned int Get(size_t pos) const
+	{
+		if (m_Type==DENSE8)
+			return m_Dense8[pos];
+		if (m_Type==DENSE16)
+			return m_Dense16[pos];
+		unsigned int i = pos % m_Size[0];
+		pos /= m_Size[0];
+		return Get(i, (unsigned int)(pos % m_Size[1]), (unsigned int)(pos / m_Size[1]));
+	}
+
+protected:
+	static const uint32_t UNIFORM_BRICK = 0x80000000;
+
+	StorageType m_Type;
+	unsigned int m_Size[3];
+	unsigned int m_NumBricks[3];
+
+	//! dense data or data of all non-uniform bricks
+	std::vector<uint8_t> m_Dense8;
+	std::vector<uint16_t> m_Dense16;
+	//! index of a non-uniform brick or the index of a uniform brick flagged with UNIFORM_BRICK
+	std::vector<uint32_t> m_BrickTable;
+
+	template <typename T> bool SetDataT(const T* data, const unsigned int size[3], bool allowSparse);
+	template <typename T, typename S> void StoreDense(const T* data, std::vector<S> &dense);
+	template <typename T, typename S> void StoreSparse(const T* data, std::vector<S> &pool);
+};
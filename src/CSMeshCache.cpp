@@ -0,0 +1,184 @@
+/*
+*	Copyright (C) 2016 Thorsten Liebig (Thorsten.Liebig@gmx.de)
+*
+*	This program is free software: you can redistribute it and/or modify
+*	it under the terms of the GNU Lesser General Public License as published
+*	by the Free Software Foundation, either version 3 of the License, or
+*	(at your option) any later version.
+*
+*	This program is distributed in the hope that it will be useful,
+*	but WITHOUT ANY WARRANTY; without even the implied warranty of
+*	MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+*	GNU Lesser General Public License for more details.
+*
+*	You should have received a copy of the GNU Lesser General Public License
+*	along with this program.  If not, see <http://www.gnu.org/licenses/>.
+*/
+
+#include <cstring>
+#include <cstdio>
+#include <sstream>
+#include <iomanip>
+
+#if defined(WIN32)
+#include <process.h>
+#define getpid _getpid
+#else
+#include <unistd.h>
+#endif
+
+#include "CSMeshCache.h"
+
+// increase if the layout of any cached data changes
+#define MESH_CACHE_VERSION 1
+#define MESH_CACHE_MAGIC "CSXMESH"
+#define MESH_CACHE_HASH_BUFFER (1<<20)
+
+#define FNV_OFFSET_BASIS 14695981039346656037ULL
+#define FNV_PRIME 1099511628211ULL
+
+CSMeshCache::CSMeshCache()
+{
+	m_File = NULL;
+	m_Write = false;
+	m_Failed = false;
+	m_Remaining = 0;
+}
+
+CSMeshCache::~CSMeshCache()
+{
+	if (m_Write)
+		Abort();
+	else
+		Close();
+}
+
+bool CSMeshCache::HashFile(std::string filename, uint64_t &hash)
+{
+	FILE* file = fopen(filename.c_str(), "rb");
+	if (file==NULL)
+		return false;
+	std::vector<unsigned char> buffer(MESH_CACHE_HASH_BUFFER);
+	hash = FNV_OFFSET_BASIS;
+	size_t num;
+	while ((num=fread(&buffer[0], 1, buffer.size(), file))>0)
+		for (size_t n=0;n<num;++n)
+			hash = (hash^buffer[n])*FNV_PRIME;
+	bool ok = (ferror(file)==0);
+	fclose(file);
+	return ok;
+}
+
+uint64_t CSMeshCache::HashCombine(uint64_t hash, uint64_t val)
+{
+	for (int n=0;n<8;++n)
+		hash = (hash^((val>>(8*n))&0xff))*FNV_PRIME;
+	return hash;
+}
+
+std::string CSMeshCache::GetCacheFilename(std::string dir, uint64_t key)
+{
+	std::ostringstream name;
+	name << dir;
+	if (!dir.empty() && (dir[dir.size()-1]!='/') && (dir[dir.size()-1]!='\\'))
+		name << "/";
+	name << "mesh_" << std::hex << std::setw(16) << std::setfill('0') << key << ".cache";
+	return name.str();
+}
+
+bool CSMeshCache::OpenRead(std::string filename, uint64_t key)
+{
+	Close();
+	m_Write = false;
+	m_Failed = false;
+	m_File = fopen(filename.c_str(), "rb");
+	if (m_File==NULL)
+		return false;
+	fseek(m_File, 0, SEEK_END);
+	long size = ftell(m_File);
+	fseek(m_File, 0, SEEK_SET);
+	m_Remaining = size>0 ? size : 0;
+
+	char magic[sizeof(MESH_CACHE_MAGIC)];
+	uint32_t version = 0;
+	uint64_t fileKey = 0;
+	if (Read(magic, sizeof(magic)) && ReadValue(version) && ReadValue(fileKey))
+		if ((memcmp(magic, MESH_CACHE_MAGIC, sizeof(magic))==0) && (version==MESH_CACHE_VERSION) && (fileKey==key))
+			return true;
+	Close();
+	return false;
+}
+
+bool CSMeshCache::OpenWrite(std::string filename, uint64_t key)
+{
+	Close();
+	m_Write = true;
+	m_Failed = false;
+	m_Filename = filename;
+	// unique temporary name for concurrent writers of the same cache file, the process id separates processes, the object address all writers of a process
+	std::ostringstream temp;
+	temp << filename << "." << std::dec << (uint64_t)getpid() << "_" << std::hex << (uint64_t)(size_t)this << ".tmp";
+	m_TempFilename = temp.str();
+	m_File = fopen(m_TempFilename.c_str(), "wb");
+	if (m_File==NULL)
+		return false;
+	uint32_t version = MESH_CACHE_VERSION;
+	if (Write(MESH_CACHE_MAGIC, sizeof(MESH_CACHE_MAGIC)) && WriteValue(version) && WriteValue(key))
+		return true;
+	Abort();
+	return false;
+}
+
+bool CSMeshCache::Close()
+{
+	if (m_File==NULL)
+		return false;
+	bool ok = (fclose(m_File)==0) && (m_Failed==false);
+	m_File = NULL;
+	if (m_Write==false)
+		return ok;
+	m_Write = false;
+	if (ok)
+	{
+		ok = (rename(m_TempFilename.c_str(), m_Filename.c_str())==0);
+		if (ok==false)
+		{
+			// the file may have been written concurrently, rename does not replace existing files on Windows
+			remove(m_Filename.c_str());
+			ok = (rename(m_TempFilename.c_str(), m_Filename.c_str())==0);
+		}
+	}
+	if (ok==false)
+		remove(m_TempFilename.c_str());
+	return ok;
+}
+
+void CSMeshCache::Abort()
+{
+	if (m_File==NULL)
+		return;
+	fclose(m_File);
+	m_File = NULL;
+	if (m_Write)
+		remove(m_TempFilename.c_str());
+	m_Write = false;
+}
+
+bool CSMeshCache::Write(const void* data, size_t size)
+{
+	if ((m_File==NULL) || (m_Write==false) || m_Failed)
+		return false;
+	if (fwrite(data, 1, size, m_File)!=size)
+		return Fail();
+	return true;
+}
+
+bool CSMeshCache::Read(void* data, size_t size)
+{
+	if ((m_File==NULL) || m_Write || m_Failed)
+		return false;
+	if ((size>m_Remaining) || (fread(data, 1, size, m_File)!=size))
+		return Fail();
+	m_Remaining -= size;
+	return true;
+}
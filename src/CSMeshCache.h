@@ -0,0 +1,88 @@
+/*
+*	Copyright (C) 2016 Thorsten Liebig (Thorsten.Liebig@gmx.de)
+*
+*	This program is free software: you can redistribute it and/or modify
+*	it under the terms of the GNU Lesser General Public License as published
+*	by the Free Software Foundation, either version 3 of the License, or
+*	(at your option) any later version.
+*
+*	This program is distributed in the hope that it will be useful,
+*	but WITHOUT ANY WARRANTY; without even the implied warranty of
+*	MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+*	GNU Lesser General Public License for more details.
+*
+*	You should have received a copy of the GNU Lesser General Public License
+*	along with this program.  If not, see <http://www.gnu.org/licenses/>.
+*/
+
+#pragma once
+
+#include <stdio.h>
+#include <string>
+#include <vector>
+#include "stdint.h"
+#include "CSXCAD_Global.h"
+
+//! Binary cache file of processed mesh geometry
+/*!
+ A cache file starts with a magic string, a format version and a 64bit key (e.g. the hash of the source file content), followed by arrays (number of elements and raw data).
+ A cache file is written to a temporary file first and renamed when complete, thus parallel runs only ever see complete files.
+ The data is stored in the native byte order, a cache directory can not be shared between machines of different byte order.
+ */
+class CSXCAD_EXPORT CSMeshCache
+{
+public:
+	CSMeshCache();
+	virtual ~CSMeshCache();
+
+	//! Get the 64bit FNV-1a hash of the file content. \return false if the file can not be read
+	static bool HashFile(std::string filename, uint64_t &hash);
+	//! Combine a hash with another value
+	static uint64_t HashCombine(uint64_t hash, uint64_t val);
+	//! Get the name of the cache file for the given key in directory dir
+	static std::string GetCacheFilename(std::string dir, uint64_t key);
+
+	//! Open an existing cache file. \return false if the file does not exist or was written for a different key or format
+	bool OpenRead(std::string filename, uint64_t key);
+	//! Create a new cache file, the file is only visible after a successful Close()
+	bool OpenWrite(std::string filename, uint64_t key);
+	//! Close the cache file. \return false if any read or write has failed
+	bool Close();
+	//! Discard a cache file that is written
+	void Abort();
+
+	bool IsOpen() const {return m_File!=NULL;}
+
+	bool Write(const void* data, size_t size);
+	bool Read(void* data, size_t size);
+
+	template <class T> bool WriteValue(const T &val) {return Write(&val, sizeof(T));}
+	template <class T> bool ReadValue(T &val) {return Read(&val, sizeof(T));}
+
+	//! Write the number of elements followed by the elements of a vector of plain values
+	template <class T> bool WriteArray(const std::vector<T> &vec)
+	{
+		uint64_t num = vec.size();
+		return WriteValue(num) && (vec.empty() || Write(&vec[0], vec.size()*sizeof(T)));
+	}
+	//! Read a vector written by WriteArray, at most maxNum elements are accepted
+	template <class T> bool ReadArray(std::vector<T> &vec, uint64_t maxNum=(uint64_t)-1)
+	{
+		uint64_t num = 0;
+		if ((ReadValue(num)==false) || (num>maxNum) || (num>m_Remaining/sizeof(T)))
+			return Fail();
+		vec.resize(num);
+		return vec.empty() || Read(&vec[0], vec.size()*sizeof(T));
+	}
+
+protected:
+	FILE* m_File;
+	bool m_Write;
+	bool m_Failed;
+	//! number of bytes left to read
+	uint64_t m_Remaining;
+	std::string m_Filename;
+	std::string m_TempFilename;
+
+	bool Fail() {m_Failed=true; return false;}
+};
@@ -0,0 +1,704 @@
+/*
+*	Copyright (C) 2016 Thorsten Liebig (Thorsten.Liebig@gmx.de)
+*
+*	This program is free software: you can redistribute it and/or modify
+*	it under the terms of the GNU Lesser General Public License as published
+*	by the Free Software Foundation, either version 3 of the License, or
+*	(at your option) any later version.
+*
+*	This program is distributed in the hope that it will be useful,
+*	but WITHOUT ANY WARRANTY; without even the implied warranty of
+*	MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+*	GNU Lesser General Public License for more details.
+*
+*	You should have received a copy of the GNU Lesser General Public License
+*	along with this program.  If not, see <http://www.gnu.org/licenses/>.
+*/
+
+#include <cstdio>
+#include <cstdlib>
+#include <cstring>
+#include <sstream>
+#include <algorithm>
+#include <sys/stat.h>
+#include "stdint.h"
+
+#include "CSMeshFileReader.h"
+
+#define MESH_READ_BUFFER_SIZE (1<<20)
+
+//! Buffered sequential reading of binary data and text lines
+class CSMeshFileReader::InputStream
+{
+public:
+	InputStream() {m_File=NULL; m_Pos=0; m_Len=0; m_Buffer.resize(MESH_READ_BUFFER_SIZE);}
+	~InputStream() {Close();}
+
+	bool Open(std::string filename)
+	{
+		Close();
+		m_File = fopen(filename.c_str(), "rb");
+		m_Pos = 0;
+		m_Len = 0;
+		return (m_File!=NULL);
+	}
+
+	void Close()
+	{
+		if (m_File)
+			fclose(m_File);
+		m_File = NULL;
+	}
+
+	bool Read(void* dest, size_t size)
+	{
+		char* out = (char*)dest;
+		while (size>0)
+		{
+			if ((m_Pos>=m_Len) && (Fill()==false))
+				return false;
+			size_t num = std::min(size, m_Len-m_Pos);
+			memcpy(out, &m_Buffer[m_Pos], num);
+			m_Pos += num;
+			out += num;
+			size -= num;
+		}
+		return true;
+	}
+
+	//! Read the next line without the line break. \return false at the end of the file
+	bool GetLine(std::string &line)
+	{
+		line.clear();
+		bool found = false;
+		while (true)
+		{
+			if ((m_Pos>=m_Len) && (Fill()==false))
+				return found;
+			found = true;
+			const char* start = &m_Buffer[m_Pos];
+			const char* end = (const char*)memchr(start, '\n', m_Len-m_Pos);
+			if (end)
+			{
+				line.append(start, end-start);
+				m_Pos += (end-start)+1;
+				if (!line.empty() && (line[line.size()-1]=='\r'))
+					line.erase(line.size()-1);
+				return true;
+			}
+			line.append(start, m_Len-m_Pos);
+			m_Pos = m_Len;
+		}
+	}
+
+protected:
+	FILE* m_File;
+	std::vector<char> m_Buffer;
+	size_t m_Pos;
+	size_t m_Len;
+
+	bool Fill()
+	{
+		if (m_File==NULL)
+			return false;
+		m_Pos = 0;
+		m_Len = fread(&m_Buffer[0], 1, m_Buffer.size(), m_File);
+		return (m_Len>0);
+	}
+};
+
+// check if the line starts with the given keyword (after leading white space), return the position after the keyword or NULL
+static const char* MatchKeyword(const std::string &line, const char* keyword)
+{
+	const char* c = line.c_str();
+	while ((*c==' ') || (*c=='\t'))
+		++c;
+	size_t len = strlen(keyword);
+	if (strncmp(c, keyword, len)!=0)
+		return NULL;
+	if ((c[len]!=0) && (c[len]!=' ') && (c[len]!='\t'))
+		return NULL;
+	return c+len;
+}
+
+static bool IsLittleEndian()
+{
+	uint16_t test = 1;
+	return (*(unsigned char*)&test)==1;
+}
+
+static void SwapBytes(unsigned char* data, size_t size)
+{
+	for (size_t n=0;n<size/2;++n)
+		std::swap(data[n], data[size-1-n]);
+}
+
+/*********************CSMeshFileReader********************************************************************/
+CSMeshFileReader::CSMeshFileReader()
+{
+	m_MergeMode = -1;
+	m_Merge = false;
+	m_HashMask = 0;
+	Clear();
+}
+
+CSMeshFileReader::~CSMeshFileReader()
+{
+}
+
+void CSMeshFileReader::Clear()
+{
+	m_Vertices.clear();
+	m_FaceIndices.clear();
+	m_FaceOffsets.clear();
+	m_FaceOffsets.push_back(0);
+	std::vector<int>().swap(m_HashTable);
+	m_HashMask = 0;
+	m_Error.clear();
+}
+
+int* CSMeshFileReader::GetFace(unsigned int n, unsigned int &numVertices)
+{
+	if (n>=GetNumFaces())
+	{
+		numVertices = 0;
+		return NULL;
+	}
+	numVertices = m_FaceOffsets[n+1]-m_FaceOffsets[n];
+	return &m_FaceIndices[m_FaceOffsets[n]];
+}
+
+bool CSMeshFileReader::Prepare(bool merge)
+{
+	Clear();
+	m_Merge = merge;
+	if (m_Merge)
+	{
+		m_HashTable.resize(1<<16, -1);
+		m_HashMask = m_HashTable.size()-1;
+	}
+	return true;
+}
+
+size_t CSMeshFileReader::HashVertex(const float* coord) const
+{
+	uint32_t bits[3];
+	memcpy(bits, coord, sizeof(bits));
+	uint64_t h = bits[0]*(uint64_t)73856093 ^ bits[1]*(uint64_t)19349663 ^ bits[2]*(uint64_t)83492791;
+	h ^= h>>29;
+	h *= (uint64_t)0xbf58476d1ce4e5b9ULL;
+	h ^= h>>32;
+	return (size_t)h;
+}
+
+void CSMeshFileReader::GrowHashTable()
+{
+	m_HashTable.assign(2*m_HashTable.size(), -1);
+	m_HashMask = m_HashTable.size()-1;
+	unsigned int num = GetNumVertices();
+	for (unsigned int n=0;n<num;++n)
+	{
+		size_t pos = HashVertex(&m_Vertices[3*n]) & m_HashMask;
+		while (m_HashTable[pos]>=0)
+			pos = (pos+1) & m_HashMask;
+		m_HashTable[pos] = n;
+	}
+}
+
+int CSMeshFileReader::AddVertex(float x, float y, float z)
+{
+	// adding zero turns a negative zero into a positive one, which is required for hashing the bit pattern
+	float coord[3] = {x+0.0f, y+0.0f, z+0.0f};
+	int index = GetNumVertices();
+	if (m_Merge)
+	{
+		size_t pos = HashVertex(coord) & m_HashMask;
+		while (m_HashTable[pos]>=0)
+		{
+			const float* v = &m_Vertices[3*m_HashTable[pos]];
+			if ((v[0]==coord[0]) && (v[1]==coord[1]) && (v[2]==coord[2]))
+				return m_HashTable[pos];
+			pos = (pos+1) & m_HashMask;
+		}
+		m_HashTable[pos] = index;
+	}
+	m_Vertices.insert(m_Vertices.end(), coord, coord+3);
+	// keep the load factor of the hash table below 1/2
+	if (m_Merge && (2*(size_t)GetNumVertices()>m_HashTable.size()))
+		GrowHashTable();
+	return index;
+}
+
+void CSMeshFileReader::AddFace(const int* vertices, unsigned int numVertices)
+{
+	if (numVertices<3)
+		return;
+	for (unsigned int n=1;n<numVertices-1;++n)
+	{
+		m_FaceIndices.push_back(vertices[0]);
+		m_FaceIndices.push_back(vertices[n]);
+		m_FaceIndices.push_back(vertices[n+1]);
+		m_FaceOffsets.push_back(m_FaceIndices.size());
+	}
+}
+
+bool CSMeshFileReader::ReadSTL(std::string filename)
+{
+	Prepare(m_MergeMode!=0);
+	InputStream in;
+	if (in.Open(filename)==false)
+	{
+		m_Error = "can't open file \"" + filename + "\"";
+		return false;
+	}
+
+	// a binary STL has an 80 byte header and the number of triangles, followed by 50 bytes per triangle
+	// an ASCII STL starts with "solid", which may be found in a binary header as well, thus check the file size first
+	unsigned char header[84];
+	bool binary = false;
+	unsigned int numTriangles = 0;
+	struct stat st;
+	if ((stat(filename.c_str(), &st)==0) && (st.st_size>=84) && in.Read(header,84))
+	{
+		uint32_t num;
+		memcpy(&num, header+80, 4);
+		if (IsLittleEndian()==false)
+			SwapBytes((unsigned char*)&num, 4);
+		numTriangles = num;
+		binary = ((uint64_t)st.st_size==84+50*(uint64_t)num);
+		if ((binary==false) && (strncmp((const char*)header, "solid", 5)!=0))
+			binary = true; // a truncated or padded binary file
+	}
+
+	bool ok;
+	if (binary)
+		ok = ReadSTLBinary(in, numTriangles);
+	else
+	{
+		in.Open(filename);
+		ok = ReadSTLASCII(in);
+	}
+	std::vector<int>().swap(m_HashTable);
+	return ok;
+}
+
+bool CSMeshFileReader::ReadSTLBinary(InputStream &in, unsigned int numTriangles)
+{
+	bool swap = (IsLittleEndian()==false);
+	m_Vertices.reserve(3*(size_t)numTriangles/2);
+	m_FaceIndices.reserve(3*(size_t)numTriangles);
+	m_FaceOffsets.reserve((size_t)numTriangles+1);
+	unsigned char data[50];
+	float coord[12];
+	int face[3];
+	for (unsigned int n=0;n<numTriangles;++n)
+	{
+		if (in.Read(data,50)==false)
+		{
+			std::stringstream ss;
+			ss << "unexpected end of file after " << n << " of " << numTriangles << " triangles";
+			m_Error = ss.str();
+			return false;
+		}
+		// normal (ignored), three vertices and a 2 byte attribute
+		if (swap)
+			for (int i=0;i<12;++i)
+				SwapBytes(data+4*i, 4);
+		memcpy(coord, data, 48);
+		for (int i=0;i<3;++i)
+			face[i] = AddVertex(coord[3+3*i], coord[4+3*i], coord[5+3*i]);
+		AddFace(face,3);
+	}
+	return true;
+}
+
+bool CSMeshFileReader::ReadSTLASCII(InputStream &in)
+{
+	std::string line;
+	std::vector<int> face;
+	while (in.GetLine(line))
+	{
+		const char* c = MatchKeyword(line, "vertex");
+		if (c)
+		{
+			char* end;
+			float coord[3];
+			for (int n=0;n<3;++n)
+			{
+				coord[n] = (float)strtod(c, &end);
+				if (end==c)
+				{
+					m_Error = "invalid vertex: \"" + line + "\"";
+					return false;
+				}
+				c = end;
+			}
+			face.push_back(AddVertex(coord[0], coord[1], coord[2]));
+		}
+		else if (MatchKeyword(line, "endloop") || MatchKeyword(line, "endfacet"))
+		{
+			if (!face.empty())
+				AddFace(&face[0], face.size());
+			face.clear();
+		}
+	}
+	if (GetNumFaces()==0)
+	{
+		m_Error = "no facets found";
+		return false;
+	}
+	return true;
+}
+
+namespace
+{
+enum PLYType
+{
+	PLY_NONE, PLY_INT8, PLY_UINT8, PLY_INT16, PLY_UINT16, PLY_INT32, PLY_UINT32, PLY_FLOAT32, PLY_FLOAT64
+};
+
+struct PLYProperty
+{
+	std::string name;
+	PLYType type;
+	//! the type of the number of entries for a list property, PLY_NONE for a scalar property
+	PLYType countType;
+};
+
+struct PLYElement
+{
+	std::string name;
+	size_t count;
+	std::vector<PLYProperty> props;
+};
+
+PLYType GetPLYType(const std::string &name)
+{
+	if ((name=="char") || (name=="int8")) return PLY_INT8;
+	if ((name=="uchar") || (name=="uint8")) return PLY_UINT8;
+	if ((name=="short") || (name=="int16")) return PLY_INT16;
+	if ((name=="ushort") || (name=="uint16")) return PLY_UINT16;
+	if ((name=="int") || (name=="int32")) return PLY_INT32;
+	if ((name=="uint") || (name=="uint32")) return PLY_UINT32;
+	if ((name=="float") || (name=="float32")) return PLY_FLOAT32;
+	if ((name=="double") || (name=="float64")) return PLY_FLOAT64;
+	return PLY_NONE;
+}
+
+size_t GetPLYTypeSize(PLYType type)
+{
+	switch (type)
+	{
+	case PLY_INT8: case PLY_UINT8: return 1;
+	case PLY_INT16: case PLY_UINT16: return 2;
+	case PLY_INT32: case PLY_UINT32: case PLY_FLOAT32: return 4;
+	case PLY_FLOAT64: return 8;
+	default: return 0;
+	}
+}
+
+//! Convert a single binary value to double
+template <typename T> double ConvertPLYValue(unsigned char* data, bool swap)
+{
+	if (swap)
+		SwapBytes(data, sizeof(T));
+	T val;
+	memcpy(&val, data, sizeof(T));
+	return (double)val;
+}
+
+double DecodePLYValue(unsigned char* data, PLYType type, bool swap)
+{
+	switch (type)
+	{
+	case PLY_INT8: return ConvertPLYValue<int8_t>(data, swap);
+	case PLY_UINT8: return ConvertPLYValue<uint8_t>(data, swap);
+	case PLY_INT16: return ConvertPLYValue<int16_t>(data, swap);
+	case PLY_UINT16: return ConvertPLYValue<uint16_t>(data, swap);
+	case PLY_INT32: return ConvertPLYValue<int32_t>(data, swap);
+	case PLY_UINT32: return ConvertPLYValue<uint32_t>(data, swap);
+	case PLY_FLOAT32: return ConvertPLYValue<float>(data, swap);
+	case PLY_FLOAT64: return ConvertPLYValue<double>(data, swap);
+	default: return 0;
+	}
+}
+}
+
+bool CSMeshFileReader::ReadPLY(std::string filename)
+{
+	Prepare(m_MergeMode==1);
+	InputStream in;
+	if (in.Open(filename)==false)
+	{
+		m_Error = "can't open file \"" + filename + "\"";
+		return false;
+	}
+
+	// read the header
+	std::string line;
+	if ((in.GetLine(line)==false) || (MatchKeyword(line, "ply")==NULL))
+	{
+		m_Error = "not a PLY file";
+		return false;
+	}
+	// 0: ascii, 1: binary little endian, 2: binary big endian
+	int format = -1;
+	std::vector<PLYElement> elements;
+	while (true)
+	{
+		if (in.GetLine(line)==false)
+		{
+			m_Error = "unexpected end of header";
+			return false;
+		}
+		std::istringstream ss(line);
+		std::string key;
+		ss >> key;
+		if (key=="end_header")
+			break;
+		else if (key=="format")
+		{
+			std::string name;
+			ss >> name;
+			if (name=="ascii")
+				format = 0;
+			else if (name=="binary_little_endian")
+				format = 1;
+			else if (name=="binary_big_endian")
+				format = 2;
+		}
+		else if (key=="element")
+		{
+			PLYElement elem;
+			ss >> elem.name >> elem.count;
+			if (ss.fail())
+			{
+				m_Error = "invalid element: \"" + line + "\"";
+				return false;
+			}
+			elements.push_back(elem);
+		}
+		else if (key=="property")
+		{
+			PLYProperty prop;
+			std::string type;
+			ss >> type;
+			prop.countType = PLY_NONE;
+			if (type=="list")
+			{
+				ss >> type;
+				prop.countType = GetPLYType(type);
+				ss >> type;
+			}
+			prop.type = GetPLYType(type);
+			ss >> prop.name;
+			if (ss.fail() || elements.empty() || (prop.type==PLY_NONE) || ((prop.countType==PLY_NONE) && (type=="list")))
+			{
+				m_Error = "invalid property: \"" + line + "\"";
+				return false;
+			}
+			elements.back().props.push_back(prop);
+		}
+	}
+	if (format<0)
+	{
+		m_Error = "unknown or missing PLY format";
+		return false;
+	}
+	bool swap = (format==1) != IsLittleEndian();
+
+	// map the vertex indices of the file to the (merged) vertices
+	std::vector<int> vertexMap;
+	std::vector<double> values;
+	std::vector<int> face;
+	unsigned char data[8];
+	for (size_t e=0;e<elements.size();++e)
+	{
+		const PLYElement &elem = elements.at(e);
+		bool isVertex = (elem.name=="vertex");
+		bool isFace = (elem.name=="face");
+		// property positions of the coordinates and the face indices
+		int coordProp[3] = {-1, -1, -1};
+		int faceProp = -1;
+		for (size_t p=0;p<elem.props.size();++p)
+		{
+			const std::string &name = elem.props.at(p).name;
+			if (isVertex && (name=="x")) coordProp[0] = p;
+			if (isVertex && (name=="y")) coordProp[1] = p;
+			if (isVertex && (name=="z")) coordProp[2] = p;
+			if (isFace && (elem.props.at(p).countType!=PLY_NONE) && ((name=="vertex_indices") || (name=="vertex_index")))
+				faceProp = p;
+		}
+		if (isVertex && ((coordProp[0]<0) || (coordProp[1]<0) || (coordProp[2]<0)))
+		{
+			m_Error = "missing vertex coordinates";
+			return false;
+		}
+		if (isVertex)
+		{
+			vertexMap.reserve(elem.count);
+			m_Vertices.reserve(3*elem.count);
+		}
+		if (isFace)
+		{
+			m_FaceIndices.reserve(3*elem.count);
+			m_FaceOffsets.reserve(elem.count+1);
+		}
+
+		for (size_t n=0;n<elem.count;++n)
+		{
+			double coord[3] = {0, 0, 0};
+			face.clear();
+			const char* c = NULL;
+			if (format==0)
+			{
+				if (in.GetLine(line)==false)
+				{
+					m_Error = "unexpected end of file in element \"" + elem.name + "\"";
+					return false;
+				}
+				c = line.c_str();
+			}
+			for (size_t p=0;p<elem.props.size();++p)
+			{
+				const PLYProperty &prop = elem.props.at(p);
+				// read the number of list entries (1 for scalar properties) and all entries
+				size_t count = 1;
+				values.clear();
+				bool ok = true;
+				if (format==0)
+				{
+					char* end;
+					if (prop.countType!=PLY_NONE)
+					{
+						count = (size_t)strtod(c, &end);
+						ok = (end!=c);
+						c = end;
+					}
+					for (size_t i=0;(i<count) && ok;++i)
+					{
+						values.push_back(strtod(c, &end));
+						ok = (end!=c);
+						c = end;
+					}
+				}
+				else
+				{
+					if (prop.countType!=PLY_NONE)
+					{
+						ok = in.Read(data, GetPLYTypeSize(prop.countType));
+						count = (size_t)DecodePLYValue(data, prop.countType, swap);
+					}
+					size_t size = GetPLYTypeSize(prop.type);
+					for (size_t i=0;(i<count) && ok;++i)
+					{
+						ok = in.Read(data, size);
+						values.push_back(DecodePLYValue(data, prop.type, swap));
+					}
+				}
+				if (ok==false)
+				{
+					m_Error = "failed to read element \"" + elem.name + "\"";
+					return false;
+				}
+				for (int i=0;i<3;++i)
+					if ((int)p==coordProp[i])
+						coord[i] = values.at(0);
+				if ((int)p==faceProp)
+				{
+					for (size_t i=0;i<values.size();++i)
+					{
+						size_t idx = (size_t)values.at(i);
+						if ((values.at(i)<0) || (idx>=vertexMap.size()))
+						{
+							m_Error = "invalid vertex index in face";
+							return false;
+						}
+						face.push_back(vertexMap.at(idx));
+					}
+				}
+			}
+			if (isVertex)
+				vertexMap.push_back(AddVertex(coord[0], coord[1], coord[2]));
+			if (isFace && !face.empty())
+				AddFace(&face[0], face.size());
+		}
+	}
+	std::vector<int>().swap(m_HashTable);
+	if (GetNumFaces()==0)
+	{
+		m_Error = "no faces found";
+		return false;
+	}
+	return true;
+}
+
+bool CSMeshFileReader::ReadOBJ(std::string filename)
+{
+	Prepare(m_MergeMode==1);
+	InputStream in;
+	if (in.Open(filename)==false)
+	{
+		m_Error = "can't open file \"" + filename + "\"";
+		return false;
+	}
+
+	std::vector<int> vertexMap;
+	std::vector<int> face;
+	std::string line;
+	while (in.GetLine(line))
+	{
+		const char* c = MatchKeyword(line, "v");
+		if (c)
+		{
+			char* end;
+			float coord[3];
+			for (int n=0;n<3;++n)
+			{
+				coord[n] = (float)strtod(c, &end);
+				if (end==c)
+				{
+					m_Error = "invalid vertex: \"" + line + "\"";
+					return false;
+				}
+				c = end;
+			}
+			vertexMap.push_back(AddVertex(coord[0], coord[1], coord[2]));
+			continue;
+		}
+		c = MatchKeyword(line, "f");
+		if (c==NULL)
+			continue; // normals, texture coordinates, groups, materials, ...
+		// each entry is v, v/vt, v/vt/vn or v//vn, negative indices are relative to the last vertex
+		face.clear();
+		while (true)
+		{
+			char* end;
+			long idx = strtol(c, &end, 10);
+			if (end==c)
+				break;
+			c = end;
+			while ((*c!=0) && (*c!=' ') && (*c!='\t'))
+				++c;
+			if (idx<0)
+				idx += vertexMap.size();
+			else
+				--idx;
+			if ((idx<0) || (idx>=(long)vertexMap.size()))
+			{
+				m_Error = "invalid vertex index in face: \"" + line + "\"";
+				return false;
+			}
+			face.push_back(vertexMap.at(idx));
+		}
+		if (!face.empty())
+			AddFace(&face[0], face.size());
+	}
+	std::vector<int>().swap(m_HashTable);
+	if (GetNumFaces()==0)
+	{
+		m_Error = "no faces found";
+		return false;
+	}
+	return true;
+}
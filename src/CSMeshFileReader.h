@@ -0,0 +1,89 @@
+/*
+*	Copyright (C) 2016 Thorsten Liebig (Thorsten.Liebig@gmx.de)
+*
+*	This program is free software: you can redistribute it and/or modify
+*	it under the terms of the GNU Lesser General Public License as published
+*	by the Free Software Foundation, either version 3 of the License, or
+*	(at your option) any later version.
+*
+*	This program is distributed in the hope that it will be useful,
+*	but WITHOUT ANY WARRANTY; without even the implied warranty of
+*	MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+*	GNU Lesser General Public License for more details.
+*
+*	You should have received a copy of the GNU Lesser General Public License
+*	along with this program.  If not, see <http://www.gnu.org/licenses/>.
+*/
+
+#pragma once
+
+#include <string>
+#include <vector>
+#include "CSXCAD_Global.h"
+
+//! Native reader for surface mesh files (STL, PLY and OBJ)
+/*!
+ Supported are binary and ASCII STL files, ASCII and binary (little and big endian) PLY files and the vertices and faces of OBJ files.
+ The files are read in a single streaming pass. Polygons with more than three vertices are split into a triangle fan.
+ Identical vertices (as in STL files, which do not share vertices between triangles) are merged using a hash table.
+ */
+class CSXCAD_EXPORT CSMeshFileReader
+{
+public:
+	CSMeshFileReader();
+	virtual ~CSMeshFileReader();
+
+	//! Remove all vertices and faces
+	void Clear();
+
+	//! Merge identical vertices. Default is true for STL and false for (indexed) PLY and OBJ files.
+	void SetMergeVertices(bool val) {m_MergeMode = val ? 1 : 0;}
+
+	//! Read a binary or ASCII STL file. \return false on error \sa GetErrorString
+	bool ReadSTL(std::string filename);
+	//! Read an ASCII or binary PLY file. \return false on error \sa GetErrorString
+	bool ReadPLY(std::string filename);
+	//! Read the vertices and faces of an OBJ file. \return false on error \sa GetErrorString
+	bool ReadOBJ(std::string filename);
+
+	unsigned int GetNumVertices() const {return m_Vertices.size()/3;}
+	//! Get the coordinates of all vertices (x,y,z for each vertex)
+	const float* GetVertices() const {return m_Vertices.empty() ? NULL : &m_Vertices[0];}
+	float* GetVertex(unsigned int n) {return &m_Vertices.at(3*n);}
+
+	unsigned int GetNumFaces() const {return m_FaceOffsets.size()-1;}
+	//! Get the vertex indices of face n
+	int* GetFace(unsigned int n, unsigned int &numVertices);
+	//! Get the start of each face in the face index array, with the total number of indices as last entry
+	const unsigned int* GetFaceOffsets() const {return &m_FaceOffsets[0];}
+	//! Get the vertex indices of all faces \sa GetFaceOffsets
+	const int* GetFaceIndices() const {return m_FaceIndices.empty() ? NULL : &m_FaceIndices[0];}
+
+	std::string GetErrorString() const {return m_Error;}
+
+protected:
+	// -1: use the file type default
+	int m_MergeMode;
+	bool m_Merge;
+
+	std::vector<float> m_Vertices;
+	std::vector<int> m_FaceIndices;
+	std::vector<unsigned int> m_FaceOffsets;
+	std::string m_Error;
+
+	//! open addressing hash table of vertex indices (-1: empty)
+	std::vector<int> m_HashTable;
+	size_t m_HashMask;
+
+	bool Prepare(bool merge);
+	//! Add a vertex, return the index of an identical vertex if merging is enabled
+	int AddVertex(float x, float y, float z);
+	//! Add a face, polygons are split into a triangle fan
+	void AddFace(const int* vertices, unsigned int numVertices);
+	void GrowHashTable();
+	size_t HashVertex(const float* coord) const;
+
+	class InputStream;
+	bool ReadSTLBinary(InputStream &in, unsigned int numTriangles);
+	bool ReadSTLASCII(InputStream &in);
+};
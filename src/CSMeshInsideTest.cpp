@@ -0,0 +1,380 @@
+/*
+*	Copyright (C) 2016 Thorsten Liebig (Thorsten.Liebig@gmx.de)
+*
+*	This program is free software: you can redistribute it and/or modify
+*	it under the terms of the GNU Lesser General Public License as published
+*	by the Free Software Foundation, either version 3 of the License, or
+*	(at your option) any later version.
+*
+*	This program is distributed in the hope that it will be useful,
+*	but WITHOUT ANY WARRANTY; without even the implied warranty of
+*	MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+*	GNU Lesser General Public License for more details.
+*
+*	You should have received a copy of the GNU Lesser General Public License
+*	along with this program.  If not, see <http://www.gnu.org/licenses/>.
+*/
+
+#include <algorithm>
+#include <math.h>
+
+#include "CSMeshInsideTest.h"
+#include "CSMeshCache.h"
+
+// maximum number of grid cells in each direction
+#define INSIDE_GRID_MAX_CELLS 2048
+
+CSMeshInsideTest::CSMeshInsideTest()
+{
+	m_NumTriangles = 0;
+	m_Voting = false;
+}
+
+CSMeshInsideTest::~CSMeshInsideTest()
+{
+}
+
+void CSMeshInsideTest::Clear()
+{
+	m_Triangles.clear();
+	m_NumTriangles = 0;
+	for (int n=0;n<3;++n)
+	{
+		m_Grid[n].offsets.clear();
+		m_Grid[n].triangles.clear();
+	}
+}
+
+bool CSMeshInsideTest::Build(const float* vertices, unsigned int numVertices, const int* indices, const unsigned int* offsets, unsigned int numFaces)
+{
+	Clear();
+	for (unsigned int f=0;f<numFaces;++f)
+	{
+		const int* face = indices + offsets[f];
+		unsigned int numVertex = offsets[f+1]-offsets[f];
+		bool valid = true;
+		for (unsigned int i=0;i<numVertex;++i)
+			if ((face[i]<0) || ((unsigned int)face[i]>=numVertices))
+				valid = false;
+		if (valid==false)
+			continue;
+		for (unsigned int i=1;i+1<numVertex;++i)
+		{
+			const int tri[3] = {face[0], face[i], face[i+1]};
+			for (int v=0;v<3;++v)
+				m_Triangles.insert(m_Triangles.end(), vertices+3*tri[v], vertices+3*tri[v]+3);
+		}
+	}
+	m_NumTriangles = m_Triangles.size()/9;
+	if (m_NumTriangles==0)
+		return false;
+
+	BuildGrid(0);
+	if (m_Voting)
+	{
+		BuildGrid(1);
+		BuildGrid(2);
+	}
+	return true;
+}
+
+void CSMeshInsideTest::SetRayVoting(bool val)
+{
+	m_Voting = val;
+	if (m_Voting)
+		for (int n=1;n<3;++n)
+			AddRayDirection(n);
+}
+
+void CSMeshInsideTest::AddRayDirection(int ny)
+{
+	if (IsValid() && (ny>=0) && (ny<3) && m_Grid[ny].offsets.empty())
+		BuildGrid(ny);
+}
+
+void CSMeshInsideTest::BuildGrid(int ny)
+{
+	int nyP = (ny+1)%3;
+	int nyPP = (ny+2)%3;
+	AxisGrid &grid = m_Grid[ny];
+
+	// projected bounding box of all triangles
+	double bound[4] = {m_Triangles[nyP], m_Triangles[nyP], m_Triangles[nyPP], m_Triangles[nyPP]};
+	for (size_t v=0;v<3*(size_t)m_NumTriangles;++v)
+	{
+		bound[0] = std::min(bound[0], (double)m_Triangles[3*v+nyP]);
+		bound[1] = std::max(bound[1], (double)m_Triangles[3*v+nyP]);
+		bound[2] = std::min(bound[2], (double)m_Triangles[3*v+nyPP]);
+		bound[3] = std::max(bound[3], (double)m_Triangles[3*v+nyPP]);
+	}
+
+	// about one triangle per cell with cells following the aspect ratio of the bounding box
+	double width[2] = {bound[1]-bound[0], bound[3]-bound[2]};
+	double cellSize = sqrt(std::max(width[0]*width[1], 1e-300)/m_NumTriangles);
+	for (int n=0;n<2;++n)
+	{
+		grid.start[n] = bound[2*n];
+		grid.num[n] = 1;
+		if ((width[n]>0) && (cellSize>0))
+			grid.num[n] = (unsigned int)std::min((double)INSIDE_GRID_MAX_CELLS, std::max(1.0, ceil(width[n]/cellSize)));
+		grid.delta[n] = width[n]>0 ? width[n]/grid.num[n] : 1.0;
+	}
+
+	// count and fill the triangles of each cell
+	size_t numCells = (size_t)grid.num[0]*grid.num[1];
+	grid.offsets.assign(numCells+1, 0);
+	grid.triangles.clear();
+	std::vector<unsigned int> cellRange(4*(size_t)m_NumTriangles, 0);
+	for (int pass=0;pass<2;++pass)
+	{
+		for (unsigned int t=0;t<m_NumTriangles;++t)
+		{
+			unsigned int* range = &cellRange[4*(size_t)t];
+			if (pass==0)
+			{
+				const float* tri = &m_Triangles[9*(size_t)t];
+				for (int n=0;n<2;++n)
+				{
+					int dir = n==0 ? nyP : nyPP;
+					double lo = std::min(std::min(tri[dir], tri[3+dir]), tri[6+dir]);
+					double hi = std::max(std::max(tri[dir], tri[3+dir]), tri[6+dir]);
+					range[2*n] = (unsigned int)std::max(0.0, floor((lo-grid.start[n])/grid.delta[n]));
+					range[2*n+1] = (unsigned int)std::max(0.0, floor((hi-grid.start[n])/grid.delta[n]));
+					range[2*n] = std::min(range[2*n], grid.num[n]-1);
+					range[2*n+1] = std::min(range[2*n+1], grid.num[n]-1);
+				}
+			}
+			for (unsigned int j=range[2];j<=range[3];++j)
+				for (unsigned int i=range[0];i<=range[1];++i)
+				{
+					size_t cell = i + (size_t)grid.num[0]*j;
+					if (pass==0)
+						++grid.offsets[cell+1];
+					else
+						grid.triangles[grid.offsets[cell]++] = t;
+				}
+		}
+		if (pass==0)
+		{
+			for (size_t c=0;c<numCells;++c)
+				grid.offsets[c+1] += grid.offsets[c];
+			grid.triangles.resize(grid.offsets[numCells]);
+		}
+		else
+		{
+			// the offsets have been moved to the end of each cell while filling
+			for (size_t c=numCells;c>0;--c)
+				grid.offsets[c] = grid.offsets[c-1];
+			grid.offsets[0] = 0;
+		}
+	}
+}
+
+bool CSMeshInsideTest::IntersectLine(int ny, unsigned int tri, double u, double v, double &pos) const
+{
+	int nyP = (ny+1)%3;
+	int nyPP = (ny+2)%3;
+	const float* t = &m_Triangles[9*(size_t)tri];
+	double pu[3] = {t[nyP], t[3+nyP], t[6+nyP]};
+	double pv[3] = {t[nyPP], t[3+nyPP], t[6+nyPP]};
+
+	// orientation of the projected triangle, lines parallel to the triangle do not cross it
+	double area = (pu[1]-pu[0])*(pv[2]-pv[0]) - (pv[1]-pv[0])*(pu[2]-pu[0]);
+	if (area==0)
+		return false;
+	double orient = area>0 ? 1 : -1;
+
+	for (int e=0;e<3;++e)
+	{
+		// evaluate each edge with its vertices in a canonical order, thus a shared edge gives the identical result for both triangles
+		int a = e;
+		int b = (e+1)%3;
+		double sign = orient;
+		if ((pu[b]<pu[a]) || ((pu[b]==pu[a]) && (pv[b]<pv[a])))
+		{
+			std::swap(a,b);
+			sign = -sign;
+		}
+		double du = pu[b]-pu[a];
+		double dv = pv[b]-pv[a];
+		double side = du*(v-pv[a]) - dv*(u-pu[a]);
+		// a point on the edge is moved by a tiny (symbolic) offset (eps, eps^2)
+		if (side==0)
+			side = (dv!=0) ? -dv : du;
+		if (sign*side<0)
+			return false;
+	}
+
+	// crossing position from the plane equation
+	double a[3] = {t[3]-t[0], t[4]-t[1], t[5]-t[2]};
+	double b[3] = {t[6]-t[0], t[7]-t[1], t[8]-t[2]};
+	double normal[3] = {a[1]*b[2]-a[2]*b[1], a[2]*b[0]-a[0]*b[2], a[0]*b[1]-a[1]*b[0]};
+	if (normal[ny]==0)
+		return false;
+	pos = t[ny] - (normal[nyP]*(u-t[nyP]) + normal[nyPP]*(v-t[nyPP]))/normal[ny];
+	return true;
+}
+
+bool CSMeshInsideTest::GetCell(int ny, const double* coord, size_t &cell) const
+{
+	if ((ny<0) || (ny>2))
+		return false;
+	const AxisGrid &grid = m_Grid[ny];
+	if (grid.offsets.empty())
+		return false;
+	double u = coord[(ny+1)%3];
+	double v = coord[(ny+2)%3];
+	double cu = floor((u-grid.start[0])/grid.delta[0]);
+	double cv = floor((v-grid.start[1])/grid.delta[1]);
+	// a point on the upper boundary belongs to the last cell
+	if ((cu==grid.num[0]) && (u==grid.start[0]+grid.num[0]*grid.delta[0]))
+		--cu;
+	if ((cv==grid.num[1]) && (v==grid.start[1]+grid.num[1]*grid.delta[1]))
+		--cv;
+	// also false for NaN
+	if (!((cu>=0) && (cv>=0) && (cu<grid.num[0]) && (cv<grid.num[1])))
+		return false;
+	cell = (size_t)cu + (size_t)grid.num[0]*(size_t)cv;
+	return true;
+}
+
+void CSMeshInsideTest::GetCrossings(int ny, const double* coord, std::vector<double> &positions) const
+{
+	positions.clear();
+	size_t cell;
+	if (GetCell(ny, coord, cell)==false)
+		return;
+	const AxisGrid &grid = m_Grid[ny];
+	double u = coord[(ny+1)%3];
+	double v = coord[(ny+2)%3];
+	double pos;
+	for (unsigned int n=grid.offsets[cell];n<grid.offsets[cell+1];++n)
+		if (IntersectLine(ny, grid.triangles[n], u, v, pos))
+			positions.push_back(pos);
+	std::sort(positions.begin(), positions.end());
+}
+
+bool CSMeshInsideTest::IsInsideRay(int ny, const double* coord) const
+{
+	size_t cell;
+	if (GetCell(ny, coord, cell)==false)
+		return false;
+	const AxisGrid &grid = m_Grid[ny];
+	double u = coord[(ny+1)%3];
+	double v = coord[(ny+2)%3];
+	double pos;
+	// same result as IsInside(coord[ny], crossings): on the surface or an odd number of crossings above
+	unsigned int above = 0;
+	for (unsigned int n=grid.offsets[cell];n<grid.offsets[cell+1];++n)
+		if (IntersectLine(ny, grid.triangles[n], u, v, pos))
+		{
+			if (pos==coord[ny])
+				return true;
+			if (pos>coord[ny])
+				++above;
+		}
+	return (above%2)==1;
+}
+
+bool CSMeshInsideTest::IsInside(double pos, const std::vector<double> &crossings)
+{
+	std::vector<double>::const_iterator it = std::lower_bound(crossings.begin(), crossings.end(), pos);
+	if ((it!=crossings.end()) && (*it==pos))
+		return true; // on the surface
+	return ((crossings.end()-it)%2)==1;
+}
+
+bool CSMeshInsideTest::IsInside(const double* coord) const
+{
+	if (IsValid()==false)
+		return false;
+	if (m_Voting==false)
+		return IsInsideRay(0, coord);
+	int votes = 0;
+	for (int ny=0;ny<3;++ny)
+		if (IsInsideRay(ny, coord))
+			++votes;
+	return votes>=2;
+}
+
+void CSMeshInsideTest::IsInside(const double* coords, size_t n, bool* inside) const
+{
+	if (IsValid()==false)
+	{
+		std::fill(inside, inside+n, false);
+		return;
+	}
+	int numRays = m_Voting ? 3 : 1;
+	std::vector<int> votes(n, 0);
+	std::vector<double> crossings;
+	for (int ny=0;ny<numRays;++ny)
+	{
+		const double* dirCoords[3] = {coords, coords+n, coords+2*n};
+		const double* lineU = dirCoords[(ny+1)%3];
+		const double* lineV = dirCoords[(ny+2)%3];
+		bool haveLine = false;
+		double coord[3];
+		for (size_t i=0;i<n;++i)
+		{
+			// reuse the crossings of the previous point on the same line
+			if ((haveLine==false) || (lineU[i]!=coord[(ny+1)%3]) || (lineV[i]!=coord[(ny+2)%3]))
+			{
+				coord[(ny+1)%3] = lineU[i];
+				coord[(ny+2)%3] = lineV[i];
+				GetCrossings(ny, coord, crossings);
+				haveLine = true;
+			}
+			if (IsInside(dirCoords[ny][i], crossings))
+				++votes[i];
+		}
+	}
+	for (size_t i=0;i<n;++i)
+		inside[i] = 2*votes[i]>numRays;
+}
+
+bool CSMeshInsideTest::WriteCache(CSMeshCache &cache) const
+{
+	unsigned char voting = m_Voting;
+	if ((cache.WriteValue(voting) && cache.WriteArray(m_Triangles))==false)
+		return false;
+	for (int ny=0;ny<3;++ny)
+	{
+		const AxisGrid &grid = m_Grid[ny];
+		if ((cache.WriteArray(grid.offsets) && cache.WriteArray(grid.triangles))==false)
+			return false;
+		if (grid.offsets.empty())
+			continue;
+		if ((cache.Write(grid.start, sizeof(grid.start)) && cache.Write(grid.delta, sizeof(grid.delta)) && cache.Write(grid.num, sizeof(grid.num)))==false)
+			return false;
+	}
+	return true;
+}
+
+bool CSMeshInsideTest::ReadCache(CSMeshCache &cache)
+{
+	Clear();
+	unsigned char voting = 0;
+	if ((cache.ReadValue(voting) && cache.ReadArray(m_Triangles))==false)
+		return false;
+	m_Voting = (voting!=0);
+	m_NumTriangles = m_Triangles.size()/9;
+	bool ok = (m_NumTriangles>0) && (m_Triangles.size()==9*(size_t)m_NumTriangles);
+	for (int ny=0;(ny<3) && ok;++ny)
+	{
+		AxisGrid &grid = m_Grid[ny];
+		ok = cache.ReadArray(grid.offsets) && cache.ReadArray(grid.triangles);
+		if ((ok==false) || grid.offsets.empty())
+			continue;
+		ok = cache.Read(grid.start, sizeof(grid.start)) && cache.Read(grid.delta, sizeof(grid.delta)) && cache.Read(grid.num, sizeof(grid.num));
+		// a broken cache file must never cause an out of range access
+		ok = ok && (grid.offsets.size()==(size_t)grid.num[0]*grid.num[1]+1) && (grid.offsets.back()==grid.triangles.size());
+		for (size_t n=1;ok && (n<grid.offsets.size());++n)
+			ok = (grid.offsets[n-1]<=grid.offsets[n]);
+		for (size_t n=0;ok && (n<grid.triangles.size());++n)
+			ok = (grid.triangles[n]<m_NumTriangles);
+	}
+	ok = ok && (m_Grid[0].offsets.empty()==false) && ((m_Voting==false) || (HasRayDirection(1) && HasRayDirection(2)));
+	if (ok==false)
+		Clear();
+	return ok;
+}
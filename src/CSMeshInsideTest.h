@@ -0,0 +1,98 @@
+/*
+*	Copyright (C) 2016 Thorsten Liebig (Thorsten.Liebig@gmx.de)
+*
+*	This program is free software: you can redistribute it and/or modify
+*	it under the terms of the GNU Lesser General Public License as published
+*	by the Free Software Foundation, either version 3 of the License, or
+*	(at your option) any later version.
+*
+*	This program is distributed in the hope that it will be useful,
+*	but WITHOUT ANY WARRANTY; without even the implied warranty of
+*	MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+*	GNU Lesser General Public License for more details.
+*
+*	You should have received a copy of the GNU Lesser General Public License
+*	along with this program.  If not, see <http://www.gnu.org/licenses/>.
+*/
+
+#pragma once
+
+#include <vector>
+#include "CSXCAD_Global.h"
+
+class CSMeshCache;
+
+//! Deterministic inside test for a closed triangle surface mesh
+/*!
+ A point is inside if an axis parallel ray starting at the point crosses the surface an odd number of times.
+ The triangles are projected onto the plane normal to the ray and a point on a shared (projected) edge or vertex is assigned to exactly one triangle
+ (symbolic perturbation of the point), thus a ray through an edge or vertex of a closed surface is counted correctly.
+ Points on the surface are inside.
+
+ The triangles are sorted into a 2D grid on the projection plane, a query only tests the triangles of a single grid cell.
+ For surfaces that are not closed, rays in x-, y- and z-direction can be used with a majority vote. \sa SetRayVoting
+
+ All queries are const and thread-safe.
+ */
+class CSXCAD_EXPORT CSMeshInsideTest
+{
+public:
+	CSMeshInsideTest();
+	virtual ~CSMeshInsideTest();
+
+	void Clear();
+
+	//! Build the test for the given mesh (x,y,z for each vertex, faces in compressed sparse row layout), polygons are split into triangle fans.
+	bool Build(const float* vertices, unsigned int numVertices, const int* indices, const unsigned int* offsets, unsigned int numFaces);
+	bool IsValid() const {return m_NumTriangles>0;}
+	unsigned int GetNumTriangles() const {return m_NumTriangles;}
+
+	//! Use a majority vote of rays in x-, y- and z-direction (default is a single ray in x-direction)
+	void SetRayVoting(bool val);
+	bool GetRayVoting() const {return m_Voting;}
+
+	//! Check if the given point is inside
+	bool IsInside(const double* coord) const;
+	//! Check n points given as structure of arrays (n x-values, n y-values, n z-values), consecutive points on a common ray share the ray cast
+	void IsInside(const double* coords, size_t n, bool* inside) const;
+
+	//! Prepare ray casts in direction ny, required for y- and z-direction if ray voting is disabled.
+	void AddRayDirection(int ny);
+	bool HasRayDirection(int ny) const {return (ny>=0) && (ny<3) && !m_Grid[ny].offsets.empty();}
+
+	//! Get the sorted positions (in direction ny) at which the line in direction ny through coord crosses the surface. \sa AddRayDirection
+	void GetCrossings(int ny, const double* coord, std::vector<double> &positions) const;
+
+	//! Write the triangles and grids to a cache file \sa CSMeshCache
+	bool WriteCache(CSMeshCache &cache) const;
+	//! Read the triangles and grids from a cache file. \return false if the cache data is invalid
+	bool ReadCache(CSMeshCache &cache);
+
+protected:
+	//! triangles sorted into a 2D grid on the plane normal to an axis
+	struct AxisGrid
+	{
+		double start[2];
+		double delta[2];
+		unsigned int num[2];
+		//! start of the triangle list for each cell, the total number as last entry
+		std::vector<unsigned int> offsets;
+		std::vector<unsigned int> triangles;
+	};
+
+	//! vertices of all triangles (9 values each)
+	std::vector<float> m_Triangles;
+	unsigned int m_NumTriangles;
+	bool m_Voting;
+	AxisGrid m_Grid[3];
+
+	void BuildGrid(int ny);
+	//! Get the position (in direction ny) where the line through (u,v) crosses triangle tri. \return false if the line misses the triangle
+	bool IntersectLine(int ny, unsigned int tri, double u, double v, double &pos) const;
+	//! Check if pos is inside based on the sorted crossings of its line
+	static bool IsInside(double pos, const std::vector<double> &crossings);
+	//! Find the grid cell (in direction ny) of the line through coord. \return false if the line misses the grid
+	bool GetCell(int ny, const double* coord, size_t &cell) const;
+	//! Check if coord is inside by the parity of the crossings of a single ray in direction ny, without storing the crossings
+	bool IsInsideRay(int ny, const double* coord) const;
+};
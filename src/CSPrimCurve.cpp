@@ -94,6 +94,7 @@ bool CSPrimCurve::GetPoint(size_t point_index, double* point, CoordinateSystem c
 void CSPrimCurve::ClearPoints()
 {
 	points.clear();
+	m_Modified=true;
 }
 
 bool CSPrimCurve::GetBoundBox(double dBoundBox[6], bool /*PreserveOrientation*/)
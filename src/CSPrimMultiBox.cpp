@@ -90,6 +90,7 @@ void CSPrimMultiBox::DeleteBox(size_t box)
 	std::vector<ParameterScalar*>::iterator end=vCoords.begin()+(box*6+6);
 
 	vCoords.erase(start,end);
+	m_Modified=true;
 }
 
 
@@ -122,6 +123,7 @@ void CSPrimMultiBox::ClearOverlap()
 	if (vCoords.size()%6==0) return;  //no work to be done
 
 	vCoords.resize(vCoords.size()-vCoords.size()%6);
+	m_Modified=true;
 }
 
 bool CSPrimMultiBox::GetBoundBox(double dBoundBox[6], bool PreserveOrientation)
@@ -18,6 +18,8 @@
 #include <sstream>
 #include <iostream>
 #include <limits>
+#include <algorithm>
+#include <math.h>
 #include "tinyxml.h"
 #include "stdint.h"
 
@@ -25,12 +27,16 @@
 #include "CSProperties.h"
 #include "CSUseful.h"
 
+// maximum number of edge bands of a polygon
+#define POLYGON_MAX_BANDS 65536
+
 CSPrimPolygon::CSPrimPolygon(unsigned int ID, ParameterSet* paraSet, CSProperties* prop) : CSPrimitives(ID,paraSet,prop)
 {
 	Type=POLYGON;
 	m_NormDir = 0;
 	Elevation.SetParameterSet(paraSet);
 	PrimTypeName = std::string("Polygon");
+	m_EdgesValid = false;
 }
 
 CSPrimPolygon::CSPrimPolygon(CSPrimPolygon* primPolygon, CSProperties *prop) : CSPrimitives(primPolygon,prop)
@@ -39,6 +45,7 @@ CSPrimPolygon::CSPrimPolygon(CSPrimPolygon* primPolygon, CSProperties *prop) : C
 	m_NormDir = primPolygon->m_NormDir;
 	Elevation.Copy(&primPolygon->Elevation);
 	PrimTypeName = std::string("Polygon");
+	m_EdgesValid = false;
 }
 
 CSPrimPolygon::CSPrimPolygon(ParameterSet* paraSet, CSProperties* prop) : CSPrimitives(paraSet,prop)
@@ -47,6 +54,7 @@ CSPrimPolygon::CSPrimPolygon(ParameterSet* paraSet, CSProperties* prop) : CSPrim
 	m_NormDir = 0;
 	Elevation.SetParameterSet(paraSet);
 	PrimTypeName = std::string("Polygon");
+	m_EdgesValid = false;
 }
 
 CSPrimPolygon::~CSPrimPolygon()
@@ -56,21 +64,25 @@ CSPrimPolygon::~CSPrimPolygon()
 void CSPrimPolygon::SetCoord(int index, double val)
 {
 	if ((index>=0) && (index<(int)vCoords.size())) vCoords.at(index).SetValue(val);
+	m_EdgesValid = false;
 }
 
 void CSPrimPolygon::SetCoord(int index, const std::string val)
 {
 	if ((index>=0) && (index<(int)vCoords.size())) vCoords.at(index).SetValue(val);
+	m_EdgesValid = false;
 }
 
 void CSPrimPolygon::AddCoord(double val)
 {
 	vCoords.push_back(ParameterScalar(clParaSet,val));
+	m_EdgesValid = false;
 }
 
 void CSPrimPolygon::AddCoord(const std::string val)
 {
 	vCoords.push_back(ParameterScalar(clParaSet,val));
+	m_EdgesValid = false;
 }
 
 void CSPrimPolygon::RemoveCoords(int /*index*/)
@@ -137,6 +149,43 @@ bool CSPrimPolygon::GetBoundBox(double dBoundBox[6], bool PreserveOrientation)
 	return accurate;
 }
 
+//! Winding number test of point (x,y) against the given edges of a polygon, edge i is the edge from vertex i-1 to vertex i
+static bool IsInsidePolygon(double x, double y, const double* vertices, size_t np, const unsigned int* edges, size_t numEdges)
+{
+	int wn = 0;
+	for (size_t e=0;e<numEdges;++e)
+	{
+		size_t i = edges[e];
+		size_t prev = (i+np-1)%np;
+		double x1 = vertices[2*prev];
+		double y1 = vertices[2*prev+1];
+		double x2 = vertices[2*i];
+		double y2 = vertices[2*i+1];
+
+		//check if coord is on a cartesian edge exactly
+		if ((x2==x1) && (x1==x) && ( ((y<y1) && (y>y2)) || ((y>y1) && (y<y2)) ))
+			return true;
+		if ((y2==y1) && (y1==y) && ( ((x<x1) && (x>x2)) || ((x>x1) && (x<x2)) ))
+			return true;
+
+		bool startover = y1 >= y ? true : false;
+		bool endover = y2 >= y ? true : false;
+		if (startover != endover)
+		{
+			if ((y2 - y)*(x2 - x1) <= (y2 - y1)*(x2 - x))
+			{
+				if (endover) wn ++;
+			}
+			else
+			{
+				if (!endover) wn --;
+			}
+		}
+	}
+	// return true if polygon is inside the polygon
+	return (wn != 0);
+}
+
 bool CSPrimPolygon::IsInside(const double* inCoord, double /*tol*/)
 {
 	if (inCoord==NULL) return false;
@@ -149,7 +198,10 @@ bool CSPrimPolygon::IsInside(const double* inCoord, double /*tol*/)
 		TransformCoords(Coord,true, CARTESIAN);
 
 	for (unsigned int n=0;n<3;++n)
+	{
+		if (!isfinite(Coord[n])) return false;
 		if ((m_BoundBox[2*n]>Coord[n]) || (m_BoundBox[2*n+1]<Coord[n])) return false;
+	}
 
 	double x=0,y=0;
 	int nP = (m_NormDir+1)%3;
@@ -157,51 +209,85 @@ bool CSPrimPolygon::IsInside(const double* inCoord, double /*tol*/)
 	x = Coord[nP];
 	y = Coord[nPP];
 
-	int wn = 0;
-
-	size_t np = vCoords.size()/2;
-	double x1 = vCoords[2*np-2].GetValue();
-	double y1 = vCoords[2*np-1].GetValue();
-	double x2 = vCoords[0].GetValue();
-	double y2 = vCoords[1].GetValue();
-	bool startover = y1 >= y ? true : false;
-	bool endover;
-
-	for (size_t i=0;i<np;++i)
+	if (m_EdgesValid==false)
 	{
-		x2 = vCoords[2*i].GetValue();
-		y2 = vCoords[2*i+1].GetValue();
+		// coordinates modified since the last Update(), test all edges
+		size_t np = vCoords.size()/2;
+		std::vector<double> vertices(2*np);
+		for (size_t i=0;i<2*np;++i)
+			vertices[i] = vCoords[i].GetValue();
+		std::vector<unsigned int> edges(np);
+		for (size_t i=0;i<np;++i)
+			edges[i] = i;
+		return IsInsidePolygon(x, y, &vertices[0], np, &edges[0], np);
+	}
 
-		//check if coord is on a cartesian edge exactly
-		if ((x2==x1) && (x1==x) && ( ((y<y1) && (y>y2)) || ((y>y1) && (y<y2)) ))
-			return true;
-		if ((y2==y1) && (y1==y) && ( ((x<x1) && (x>x2)) || ((x>x1) && (x<x2)) ))
-			return true;
+	// only the edges of the band containing y can cross the line through the point
+	double band = floor((y-m_BandStart)/m_BandDelta);
+	size_t numBands = m_BandOffsets.size()-1;
+	size_t b = band<0 ? 0 : (band<(double)(numBands-1) ? (size_t)band : numBands-1);
+	const unsigned int* edges = m_BandEdges.empty() ? NULL : &m_BandEdges[0]+m_BandOffsets[b];
+	return IsInsidePolygon(x, y, &m_Vertices[0], m_Vertices.size()/2, edges, m_BandOffsets[b+1]-m_BandOffsets[b]);
+}
 
-		endover = y2 >= y ? true : false;
-		if (startover != endover)
+void CSPrimPolygon::BuildEdgeBands()
+{
+	size_t np = vCoords.size()/2;
+	m_Vertices.resize(2*np);
+	for (size_t i=0;i<2*np;++i)
+		m_Vertices[i] = vCoords[i].GetValue();
+	m_BandEdges.clear();
+	m_BandOffsets.assign(2, 0);
+	m_BandStart = 0;
+	m_BandDelta = 1;
+	m_EdgesValid = (np>0);
+	if (np==0)
+		return;
+
+	double ymin = m_Vertices[1];
+	double ymax = m_Vertices[1];
+	for (size_t i=1;i<np;++i)
+	{
+		ymin = std::min(ymin, m_Vertices[2*i+1]);
+		ymax = std::max(ymax, m_Vertices[2*i+1]);
+	}
+	// about two edges per band, fewer bands if many edges span a lot of bands
+	size_t numBands = std::max((size_t)1, std::min(np/2, (size_t)POLYGON_MAX_BANDS));
+	std::vector<unsigned int> edgeRange(2*np);
+	while (true)
+	{
+		m_BandStart = ymin;
+		m_BandDelta = (ymax>ymin) ? (ymax-ymin)/numBands : 1;
+		size_t numEntries = 0;
+		for (size_t i=0;i<np;++i)
 		{
-			if ((y2 - y)*(x2 - x1) <= (y2 - y1)*(x2 - x))
-			{
-				if (endover) wn ++;
-			}
-			else
-			{
-				if (!endover) wn --;
-			}
+			double y1 = m_Vertices[2*((i+np-1)%np)+1];
+			double y2 = m_Vertices[2*i+1];
+			double lo = floor((std::min(y1,y2)-m_BandStart)/m_BandDelta);
+			double hi = floor((std::max(y1,y2)-m_BandStart)/m_BandDelta);
+			edgeRange[2*i] = lo<0 ? 0 : std::min((size_t)lo, numBands-1);
+			edgeRange[2*i+1] = hi<0 ? 0 : std::min((size_t)hi, numBands-1);
+			numEntries += edgeRange[2*i+1]-edgeRange[2*i]+1;
 		}
-		startover = endover;
-		y1 = y2;
-		x1 = x2;
+		if ((numBands==1) || (numEntries<=8*np))
+			break;
+		numBands = std::max((size_t)1, numBands*4*np/numEntries);
 	}
-	// return true if polygon is inside the polygon
-	if (wn != 0)
-		return true;
 
-	return false;
+	// count and fill the edges (from vertex i-1 to vertex i) of each band
+	m_BandOffsets.assign(numBands+1, 0);
+	for (size_t i=0;i<np;++i)
+		for (size_t b=edgeRange[2*i];b<=edgeRange[2*i+1];++b)
+			++m_BandOffsets[b+1];
+	for (size_t b=0;b<numBands;++b)
+		m_BandOffsets[b+1] += m_BandOffsets[b];
+	m_BandEdges.resize(m_BandOffsets[numBands]);
+	std::vector<unsigned int> pos(m_BandOffsets.begin(), m_BandOffsets.end()-1);
+	for (size_t i=0;i<np;++i)
+		for (size_t b=edgeRange[2*i];b<=edgeRange[2*i+1];++b)
+			m_BandEdges[pos[b]++] = i;
 }
 
-
 bool CSPrimPolygon::Update(std::string *ErrStr)
 {
 	int EC=0;
@@ -236,8 +322,9 @@ bool CSPrimPolygon::Update(std::string *ErrStr)
 		PSErrorCode2Msg(EC,ErrStr);
 	}
 
-	//update local bounding box used to speedup IsInside()
+	//update local bounding box and the edge bands used to speedup IsInside()
 	m_BoundBoxValid = GetBoundBox(m_BoundBox);
+	BuildEdgeBands();
 
 	return bOK;
 }
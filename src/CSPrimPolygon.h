@@ -41,7 +41,7 @@ public:
 	void AddCoord(const std::string val);
 
 	void RemoveCoords(int index);
-	void ClearCoords() {vCoords.clear();}
+	void ClearCoords() {vCoords.clear(); m_EdgesValid=false; m_Modified=true;}
 
 	double GetCoord(int index);
 	ParameterScalar* GetCoordPS(int index);
@@ -49,7 +49,7 @@ public:
 	size_t GetQtyCoords() {return vCoords.size()/2;}
 	double* GetAllCoords(size_t &Qty, double* array);
 
-	void SetNormDir(int dir) {if ((dir>=0) && (dir<3)) m_NormDir=dir;}
+	void SetNormDir(int dir) {if ((dir>=0) && (dir<3)) m_NormDir=dir; m_Modified=true;}
 
 	int GetNormDir() {return m_NormDir;}
 
@@ -73,5 +73,19 @@ protected:
 	int m_NormDir;
 	///The polygon plane elevation in direction of the normal vector
 	ParameterScalar Elevation;
+
+	//! Evaluated vertices x1,y1,x2,y2 ... xn,yn, updated by Update()
+	std::vector<double> m_Vertices;
+	//! Edges sorted into bands of the second polygon coordinate (each edge is given by its end vertex), only edges of a single band are tested by IsInside()
+	std::vector<unsigned int> m_BandEdges;
+	//! start of the edge list of each band, the total number as last entry
+	std::vector<unsigned int> m_BandOffsets;
+	double m_BandStart;
+	double m_BandDelta;
+	//! the vertices and bands are up to date with the coordinates
+	bool m_EdgesValid;
+
+	//! Evaluate all vertices and sort the edges into bands
+	void BuildEdgeBands();
 };
 
@@ -18,28 +18,40 @@
 #include <sstream>
 #include <iostream>
 #include <limits>
+#include <algorithm>
 #include "tinyxml.h"
 #include "stdint.h"
 
 #include "CSPrimPolyhedron.h"
 #include "CSPrimPolyhedron_p.h"
+#include "CSAtomic_p.h"
+#include "CSMeshCache.h"
 #include "CSProperties.h"
 #include "CSUseful.h"
+#include "CSRectGrid.h"
+
+// number of coordinates transformed at once for the batch inside test
+#define POLYHEDRON_BLOCK_SIZE 256
 
 void Polyhedron_Builder::operator()(HalfedgeDS &hds)
 {
 	// Postcondition: `hds' is a valid polyhedral surface.
+	const CSPrimPolyhedron::MeshData* mesh = m_polyhedron->m_Mesh;
+	unsigned int numFaces = m_polyhedron->GetNumFaces();
 	CGAL::Polyhedron_incremental_builder_3<HalfedgeDS> B( hds, true);
-	B.begin_surface( m_polyhedron->m_Vertices.size(), m_polyhedron->m_Faces.size());
+	B.begin_surface( m_polyhedron->GetNumVertices(), numFaces);
 	typedef HalfedgeDS::Vertex   Vertex;
 	typedef Vertex::Point Point;
-	for (size_t n=0;n<m_polyhedron->m_Vertices.size();++n)
-		B.add_vertex( Point( m_polyhedron->m_Vertices.at(n).coord[0], m_polyhedron->m_Vertices.at(n).coord[1], m_polyhedron->m_Vertices.at(n).coord[2]));
-
-	for (size_t f=0;f<m_polyhedron->m_Faces.size();++f)
+	const float* coords = mesh->vertices.empty() ? NULL : &mesh->vertices[0];
+	for (size_t n=0;n<m_polyhedron->GetNumVertices();++n)
+		B.add_vertex( Point( coords[3*n], coords[3*n+1], coords[3*n+2]));
+
+	m_polyhedron->m_FaceValid.assign(numFaces, false);
+	const int* indices = mesh->faceIndices.empty() ? NULL : &mesh->faceIndices[0];
+	std::vector<int> help;
+	for (size_t f=0;f<numFaces;++f)
 	{
-		m_polyhedron->m_Faces.at(f).valid=false;
-		int *first = m_polyhedron->m_Faces.at(f).vertices, *beyond = first+m_polyhedron->m_Faces.at(f).numVertex;
+		const int *first = indices + mesh->faceOffsets[f], *beyond = indices + mesh->faceOffsets[f+1];
 		if (B.test_facet(first, beyond))
 		{
 			B.add_facet(first, beyond);
@@ -48,26 +60,23 @@ void Polyhedron_Builder::operator()(HalfedgeDS &hds)
 				std::cerr << "Polyhedron_Builder::operator(): Error in polyhedron construction" << std::endl;
 				break;
 			}
-			m_polyhedron->m_Faces.at(f).valid=true;
+			m_polyhedron->m_FaceValid[f]=true;
 		}
 		else
 		{
 			std::cerr << "Polyhedron_Builder::operator(): Face " << f << ": Trying reverse order... ";
-			int help[m_polyhedron->m_Faces.at(f).numVertex];
-			for (unsigned int n=0;n<m_polyhedron->m_Faces.at(f).numVertex;++n)
-				help[n]=m_polyhedron->m_Faces.at(f).vertices[m_polyhedron->m_Faces.at(f).numVertex-1-n];
-			first = help;
-			beyond = first+m_polyhedron->m_Faces.at(f).numVertex;
-			if (B.test_facet(first, beyond))
+			help.assign(first, beyond);
+			std::reverse(help.begin(), help.end());
+			if (B.test_facet(help.begin(), help.end()))
 			{
-				B.add_facet(first, beyond);
+				B.add_facet(help.begin(), help.end());
 				if (B.error())
 				{
 					std::cerr << "Polyhedron_Builder::operator(): Error in polyhedron construction" << std::endl;
 					break;
 				}
 				std::cerr << "success" << std::endl;
-				m_polyhedron->m_Faces.at(f).valid=true;
+				m_polyhedron->m_FaceValid[f]=true;
 			}
 			else
 			{
@@ -84,96 +93,158 @@ CSPrimPolyhedron::CSPrimPolyhedron(unsigned int ID, ParameterSet* paraSet, CSPro
 {
 	Type = POLYHEDRON;
 	PrimTypeName = "Polyhedron";
-	d_ptr->m_PolyhedronTree = NULL;
 	m_InvalidFaces = 0;
+	m_TreeValid = false;
+	m_LazyBuild = false;
+	m_Mesh = NewMesh();
 }
 
 CSPrimPolyhedron::CSPrimPolyhedron(CSPrimPolyhedron* primPolyhedron, CSProperties *prop) : CSPrimitives(primPolyhedron,prop), d_ptr(new CSPrimPolyhedronPrivate)
 {
 	Type = POLYHEDRON;
 	PrimTypeName = "Polyhedron";
-	d_ptr->m_PolyhedronTree = NULL;
 	m_InvalidFaces = 0;
+	m_TreeValid = false;
+	m_LazyBuild = primPolyhedron->m_LazyBuild;
 
-	//copy all vertices
-	for (size_t n=0;n<primPolyhedron->m_Vertices.size();++n)
-		AddVertex(primPolyhedron->m_Vertices.at(n).coord);
-	//copy all faces
-	for (size_t n=0;n<primPolyhedron->m_Faces.size();++n)
-		AddFace(primPolyhedron->m_Faces.at(n).numVertex,primPolyhedron->m_Faces.at(n).vertices);
+	//share all vertices and faces
+	m_Mesh = primPolyhedron->m_Mesh;
+	++m_Mesh->refCount;
 }
 
 CSPrimPolyhedron::CSPrimPolyhedron(ParameterSet* paraSet, CSProperties* prop) : CSPrimitives(paraSet,prop), d_ptr(new CSPrimPolyhedronPrivate)
 {
 	Type = POLYHEDRON;
 	PrimTypeName = "Polyhedron";
-	d_ptr->m_PolyhedronTree = NULL;
 	m_InvalidFaces = 0;
+	m_TreeValid = false;
+	m_LazyBuild = false;
+	m_Mesh = NewMesh();
 }
 
 CSPrimPolyhedron::~CSPrimPolyhedron()
 {
 	Reset();
+	ReleaseMesh();
 	delete d_ptr;
 }
 
-void CSPrimPolyhedron::Reset()
+CSPrimPolyhedron::MeshData* CSPrimPolyhedron::NewMesh()
+{
+	MeshData* mesh = new MeshData();
+	mesh->faceOffsets.push_back(0);
+	mesh->refCount = 1;
+	return mesh;
+}
+
+void CSPrimPolyhedron::ReleaseMesh()
 {
-	m_Vertices.clear();
-	for (size_t n=0;n<m_Faces.size();++n)
+	if (m_Mesh && (--m_Mesh->refCount==0))
+		delete m_Mesh;
+	m_Mesh = NULL;
+}
+
+CSPrimPolyhedron::MeshData* CSPrimPolyhedron::DetachMesh()
+{
+	m_TreeValid = false;
+	m_Modified = true;
+	if (m_Mesh->refCount>1)
 	{
-		delete[] m_Faces.at(n).vertices;
-		m_Faces.at(n).vertices=NULL;
+		MeshData* mesh = new MeshData(*m_Mesh);
+		mesh->refCount = 1;
+		--m_Mesh->refCount;
+		m_Mesh = mesh;
 	}
-	m_Faces.clear();
+	return m_Mesh;
+}
+
+void CSPrimPolyhedron::Reset()
+{
+	ReleaseMesh();
+	m_Mesh = NewMesh();
+	m_FaceValid.clear();
+	m_InsideTest.Clear();
+	d_ptr->m_TransformedTest.Clear();
+	for (int n=0;n<3;++n)
+		d_ptr->m_RayDirection[n] = false;
 	d_ptr->m_Polyhedron.clear();
-	d_ptr->m_PolyhedronTree = NULL;
 	m_InvalidFaces = 0;
+	m_TreeValid = false;
+	m_Modified = true;
 }
 
 void CSPrimPolyhedron::AddVertex(float px, float py, float pz)
 {
-	vertex nv;
-	nv.coord[0]=px;nv.coord[1]=py;nv.coord[2]=pz;
-	m_Vertices.push_back(nv);
+	MeshData* mesh = DetachMesh();
+	mesh->vertices.push_back(px);
+	mesh->vertices.push_back(py);
+	mesh->vertices.push_back(pz);
+}
+
+void CSPrimPolyhedron::AddVertices(const float* coords, unsigned int numVertices)
+{
+	MeshData* mesh = DetachMesh();
+	mesh->vertices.insert(mesh->vertices.end(), coords, coords+3*(size_t)numVertices);
 }
 
 float* CSPrimPolyhedron::GetVertex(unsigned int n)
 {
-	if (n<m_Vertices.size())
-		return m_Vertices.at(n).coord;
+	if (n<GetNumVertices())
+		return &m_Mesh->vertices[3*n];
 	return NULL;
 }
 
 void CSPrimPolyhedron::AddFace(face f)
 {
-	m_Faces.push_back(f);
+	AddFace(f.numVertex, f.vertices);
+	delete[] f.vertices;
 }
 
 void CSPrimPolyhedron::AddFace(int numVertex, int* vertices)
 {
-	face f;
-	f.numVertex=numVertex;
-	f.vertices=new int[numVertex];
-	for (int n=0;n<numVertex;++n)
-		f.vertices[n]=vertices[n];
-	m_Faces.push_back(f);
+	MeshData* mesh = DetachMesh();
+	mesh->faceIndices.insert(mesh->faceIndices.end(), vertices, vertices+numVertex);
+	mesh->faceOffsets.push_back(mesh->faceIndices.size());
 }
 
 void CSPrimPolyhedron::AddFace(std::vector<int> vertices)
 {
-	face f;
-	f.numVertex=vertices.size();
-	if (f.numVertex>3)
+	if (vertices.size()>3)
 		std::cerr << __func__ << ": Warning, faces other than triangles are currently not supported for discretization, expect false results!!!" << std::endl;
-	f.vertices=new int[f.numVertex];
-	for (unsigned int n=0;n<f.numVertex;++n)
-		f.vertices[n]=vertices.at(n);
-	m_Faces.push_back(f);
+	if (vertices.empty())
+		AddFace(0, NULL);
+	else
+		AddFace(vertices.size(), &vertices[0]);
+}
+
+void CSPrimPolyhedron::AddFaces(const int* indices, const unsigned int* offsets, unsigned int numFaces)
+{
+	if (numFaces==0)
+		return;
+	MeshData* mesh = DetachMesh();
+	unsigned int start = mesh->faceIndices.size();
+	mesh->faceIndices.insert(mesh->faceIndices.end(), indices+offsets[0], indices+offsets[numFaces]);
+	mesh->faceOffsets.reserve(mesh->faceOffsets.size()+numFaces);
+	for (unsigned int n=1;n<=numFaces;++n)
+		mesh->faceOffsets.push_back(start + offsets[n]-offsets[0]);
+}
+
+void CSPrimPolyhedron::AddFaces(const int* indices, unsigned int numFaces, unsigned int numVertex)
+{
+	if (numFaces==0)
+		return;
+	MeshData* mesh = DetachMesh();
+	unsigned int start = mesh->faceIndices.size();
+	mesh->faceIndices.insert(mesh->faceIndices.end(), indices, indices+(size_t)numFaces*numVertex);
+	mesh->faceOffsets.reserve(mesh->faceOffsets.size()+numFaces);
+	for (unsigned int n=1;n<=numFaces;++n)
+		mesh->faceOffsets.push_back(start + n*numVertex);
 }
 
 bool CSPrimPolyhedron::BuildTree()
 {
+	d_ptr->m_Polyhedron.clear();
+	m_InvalidFaces = 0;
 	Polyhedron_Builder builder(this);
 	d_ptr->m_Polyhedron.delegate(builder);
 
@@ -191,58 +262,87 @@ bool CSPrimPolyhedron::BuildTree()
 		}
 	}
 
-	//build tree
-	delete d_ptr->m_PolyhedronTree;
-#if CGAL_VERSION_NR >= CGAL_VERSION_NUMBER(4,6,0)
-    d_ptr->m_PolyhedronTree = new CGAL::AABB_tree< Traits >(faces(d_ptr->m_Polyhedron).first,faces(d_ptr->m_Polyhedron).second,d_ptr->m_Polyhedron);
-#else
-    d_ptr->m_PolyhedronTree = new CGAL::AABB_tree< Traits >(d_ptr->m_Polyhedron.facets_begin(),d_ptr->m_Polyhedron.facets_end());
-#endif
+	//build inside test, surfaces not closed are tested with rays in all three directions
+	const MeshData* mesh = m_Mesh;
+	m_InsideTest.SetRayVoting(m_InvalidFaces>0);
+	m_InsideTest.Build(mesh->vertices.empty() ? NULL : &mesh->vertices[0], GetNumVertices(),
+					   mesh->faceIndices.empty() ? NULL : &mesh->faceIndices[0], &mesh->faceOffsets[0], GetNumFaces());
+
+	d_ptr->m_TransformedTest.Clear();
 
 	//update local bounding box
 	GetBoundBox(m_BoundBox);
-	double p[3] = {m_BoundBox[1]*(1.0+(double)rand()/RAND_MAX),m_BoundBox[3]*(1.0+(double)rand()/RAND_MAX),m_BoundBox[5]*(1.0+(double)rand()/RAND_MAX)};
-	d_ptr->m_RandPt = Point(p[0],p[1],p[2]);
+	for (int n=0;n<3;++n)
+		d_ptr->m_RayDirection[n] = m_InsideTest.HasRayDirection(n);
+	// published last, a query seeing the valid flag without locking also sees the complete tree
+	StoreRelease(m_TreeValid, true);
 	return true;
 }
 
 int* CSPrimPolyhedron::GetFace(unsigned int n, unsigned int &numVertices)
 {
 	numVertices = 0;
-	if (n<m_Faces.size())
+	if (n<GetNumFaces())
 	{
-		numVertices = m_Faces.at(n).numVertex;
-		return m_Faces.at(n).vertices;
+		numVertices = m_Mesh->faceOffsets[n+1]-m_Mesh->faceOffsets[n];
+		if (numVertices==0)
+			return NULL;
+		return &m_Mesh->faceIndices[m_Mesh->faceOffsets[n]];
 	}
 	return NULL;
 }
 
+bool CSPrimPolyhedron::GetFaceValid(unsigned int n) const
+{
+	if (n<m_FaceValid.size())
+		return m_FaceValid[n];
+	return false;
+}
+
 bool CSPrimPolyhedron::GetBoundBox(double dBoundBox[6], bool PreserveOrientation)
 {
 	UNUSED(PreserveOrientation); //has no orientation or preserved anyways
 	m_BoundBox_CoordSys=CARTESIAN;
 
-	if (m_Vertices.size()==0)
+	if (GetNumVertices()==0)
 		return true;
 
-	dBoundBox[0]=dBoundBox[1]=m_Vertices.at(0).coord[0];
-	dBoundBox[2]=dBoundBox[3]=m_Vertices.at(0).coord[1];
-	dBoundBox[4]=dBoundBox[5]=m_Vertices.at(0).coord[2];
+	const float* coords = &m_Mesh->vertices[0];
+	dBoundBox[0]=dBoundBox[1]=coords[0];
+	dBoundBox[2]=dBoundBox[3]=coords[1];
+	dBoundBox[4]=dBoundBox[5]=coords[2];
 
-	for (size_t n=0;n<m_Vertices.size();++n)
+	for (size_t n=0;n<GetNumVertices();++n,coords+=3)
 	{
-		dBoundBox[0]=std::min(dBoundBox[0],(double)m_Vertices.at(n).coord[0]);
-		dBoundBox[2]=std::min(dBoundBox[2],(double)m_Vertices.at(n).coord[1]);
-		dBoundBox[4]=std::min(dBoundBox[4],(double)m_Vertices.at(n).coord[2]);
-		dBoundBox[1]=std::max(dBoundBox[1],(double)m_Vertices.at(n).coord[0]);
-		dBoundBox[3]=std::max(dBoundBox[3],(double)m_Vertices.at(n).coord[1]);
-		dBoundBox[5]=std::max(dBoundBox[5],(double)m_Vertices.at(n).coord[2]);
+		dBoundBox[0]=std::min(dBoundBox[0],(double)coords[0]);
+		dBoundBox[2]=std::min(dBoundBox[2],(double)coords[1]);
+		dBoundBox[4]=std::min(dBoundBox[4],(double)coords[2]);
+		dBoundBox[1]=std::max(dBoundBox[1],(double)coords[0]);
+		dBoundBox[3]=std::max(dBoundBox[3],(double)coords[1]);
+		dBoundBox[5]=std::max(dBoundBox[5],(double)coords[2]);
 	}
 	return true;
 }
 
+int CSPrimPolyhedron::GetDimension()
+{
+	CheckTree();
+	return m_Dimension;
+}
+
+void CSPrimPolyhedron::CheckTree()
+{
+	// double-checked, a built tree is used without locking (the acquire load pairs with the release store in BuildTree)
+	if (LoadAcquire(m_TreeValid))
+		return;
+	boost::mutex::scoped_lock lock(d_ptr->m_BuildMutex);
+	if (m_TreeValid==false)
+		BuildTree();
+}
+
 bool CSPrimPolyhedron::IsInside(const double* Coord, double /*tol*/)
 {
+	CheckTree();
 	if (m_Dimension<3)
 		return false;
 
@@ -257,39 +357,213 @@ bool CSPrimPolyhedron::IsInside(const double* Coord, double /*tol*/)
 		if ((m_BoundBox[2*n]>pos[n]) || (m_BoundBox[2*n+1]<pos[n])) return false;
 	}
 
-	Point p(pos[0], pos[1], pos[2]);
-	Segment segment_query(p,d_ptr->m_RandPt);
-	// return true for an odd number of intersections
-	if ((d_ptr->m_PolyhedronTree->number_of_intersected_primitives(segment_query)%2)==1)
-		return true;
-	return false;
+	return m_InsideTest.IsInside(pos);
+}
+
+void CSPrimPolyhedron::IsInside(const double* coords, size_t n, bool* inside, double tol)
+{
+	UNUSED(tol);
+	std::fill(inside, inside+n, false);
+	CheckTree();
+	if (m_Dimension<3)
+		return;
+
+	// transform blocks of coordinates into the local cartesian system, skipping all outside the bounding box
+	double local[3*POLYHEDRON_BLOCK_SIZE];
+	size_t index[POLYHEDRON_BLOCK_SIZE];
+	bool found[POLYHEDRON_BLOCK_SIZE];
+	double coord[3], pos[3];
+	size_t i = 0;
+	while (i<n)
+	{
+		size_t cnt = 0;
+		for (;(i<n) && (cnt<POLYHEDRON_BLOCK_SIZE);++i)
+		{
+			for (int d=0;d<3;++d)
+				coord[d] = coords[i+d*n];
+			TransformCoordSystem(coord,pos,m_MeshType,CARTESIAN);
+			if (m_Transform)
+				m_Transform->InvertTransform(pos,pos);
+			bool inBox = true;
+			for (int d=0;d<3;++d)
+				if ((m_BoundBox[2*d]>pos[d]) || (m_BoundBox[2*d+1]<pos[d]))
+					inBox = false;
+			if (inBox==false)
+				continue;
+			for (int d=0;d<3;++d)
+				local[cnt+d*POLYHEDRON_BLOCK_SIZE] = pos[d];
+			index[cnt++] = i;
+		}
+		if (cnt==0)
+			continue;
+		// close the gaps of a partially filled block to get the structure of arrays layout
+		if (cnt<POLYHEDRON_BLOCK_SIZE)
+			for (int d=1;d<3;++d)
+				std::copy(local+d*POLYHEDRON_BLOCK_SIZE, local+d*POLYHEDRON_BLOCK_SIZE+cnt, local+d*cnt);
+		m_InsideTest.IsInside(local, cnt, found);
+		for (size_t k=0;k<cnt;++k)
+			inside[index[k]] = found[k];
+	}
+}
+
+bool CSPrimPolyhedron::GetInsideIntervals(int ny, const double* linesP, unsigned int numP, const double* linesPP, unsigned int numPP, std::vector<unsigned int> &lineOffsets, std::vector<double> &intervals)
+{
+	lineOffsets.assign(1,0);
+	intervals.clear();
+	CheckTree();
+	if ((ny<0) || (ny>2) || (m_Dimension<3) || (m_MeshType!=CARTESIAN) || (m_InsideTest.IsValid()==false))
+		return false;
+	// an open surface needs the majority vote of three rays per point, a single line cast is not sufficient
+	if (m_InsideTest.GetRayVoting())
+		return false;
+
+	// the transformed mesh is needed to cast lines in the global coordinate system, it is kept until the mesh or the transformation changes
+	CSMeshInsideTest* test = &m_InsideTest;
+	if (m_Transform)
+	{
+		boost::mutex::scoped_lock lock(d_ptr->m_BuildMutex);
+		test = &d_ptr->m_TransformedTest;
+		const double* matrix = m_Transform->GetMatrix();
+		bool changed = (test->IsValid()==false);
+		for (int n=0;n<16 && changed==false;++n)
+			changed = (matrix[n]!=d_ptr->m_TransformedMatrix[n]);
+		if (changed)
+		{
+			std::vector<float> vertices(m_Mesh->vertices.size());
+			double coord[3];
+			for (size_t n=0;n<vertices.size();n+=3)
+			{
+				for (int d=0;d<3;++d)
+					coord[d] = m_Mesh->vertices[n+d];
+				m_Transform->Transform(coord,coord);
+				for (int d=0;d<3;++d)
+					vertices[n+d] = coord[d];
+			}
+			test->Build(&vertices[0], GetNumVertices(), m_Mesh->faceIndices.empty() ? NULL : &m_Mesh->faceIndices[0], &m_Mesh->faceOffsets[0], GetNumFaces());
+			for (int n=0;n<16;++n)
+				d_ptr->m_TransformedMatrix[n] = matrix[n];
+		}
+		if (test->HasRayDirection(ny)==false)
+			test->AddRayDirection(ny);
+	}
+	else if (LoadAcquire(d_ptr->m_RayDirection[ny])==false)
+	{
+		// the ray direction is added to the shared inside test once, concurrent calls have to wait for it
+		boost::mutex::scoped_lock lock(d_ptr->m_BuildMutex);
+		if (d_ptr->m_RayDirection[ny]==false)
+		{
+			test->AddRayDirection(ny);
+			StoreRelease(d_ptr->m_RayDirection[ny], true);
+		}
+	}
+
+	int nyP = (ny+1)%3;
+	int nyPP = (ny+2)%3;
+	lineOffsets.reserve((size_t)numP*numPP+1);
+	std::vector<double> crossings;
+	double coord[3] = {0, 0, 0};
+	for (unsigned int j=0;j<numPP;++j)
+	{
+		coord[nyPP] = linesPP[j];
+		for (unsigned int i=0;i<numP;++i)
+		{
+			coord[nyP] = linesP[i];
+			test->GetCrossings(ny, coord, crossings);
+			// a closed surface is always entered and left again, an unpaired last crossing is ignored
+			for (size_t n=0;n+1<crossings.size();n+=2)
+			{
+				intervals.push_back(crossings[n]);
+				intervals.push_back(crossings[n+1]);
+			}
+			lineOffsets.push_back(intervals.size()/2);
+		}
+	}
+	return true;
 }
 
+bool CSPrimPolyhedron::GetInsideIntervals(CSRectGrid* grid, int ny, std::vector<unsigned int> &lineOffsets, std::vector<double> &intervals)
+{
+	lineOffsets.assign(1,0);
+	intervals.clear();
+	if ((grid==NULL) || (ny<0) || (ny>2) || (grid->GetMeshType()!=CARTESIAN))
+		return false;
+	int nyP = (ny+1)%3;
+	int nyPP = (ny+2)%3;
+	unsigned int numP = 0, numPP = 0;
+	double* linesP = grid->GetLines(nyP, NULL, numP, true);
+	double* linesPP = grid->GetLines(nyPP, NULL, numPP, true);
+	bool ok = GetInsideIntervals(ny, linesP, numP, linesPP, numPP, lineOffsets, intervals);
+	delete[] linesP;
+	delete[] linesPP;
+	return ok;
+}
 
 bool CSPrimPolyhedron::Update(std::string *ErrStr)
 {
-	BuildTree();
+	if ((m_TreeValid==false) && (m_LazyBuild==false))
+		BuildTree();
 	//update local bounding box
 	m_BoundBoxValid = GetBoundBox(m_BoundBox);
 	return CSPrimitives::Update(ErrStr);
 }
 
+bool CSPrimPolyhedron::WriteCache(CSMeshCache &cache) const
+{
+	if (m_TreeValid==false)
+		return false;
+	std::vector<unsigned char> faceValid(m_FaceValid.begin(), m_FaceValid.end());
+	uint32_t dim = m_Dimension;
+	uint32_t invalid = m_InvalidFaces;
+	return cache.WriteArray(m_Mesh->vertices) && cache.WriteArray(m_Mesh->faceIndices) && cache.WriteArray(m_Mesh->faceOffsets)
+			&& cache.WriteArray(faceValid) && cache.WriteValue(dim) && cache.WriteValue(invalid) && m_InsideTest.WriteCache(cache);
+}
+
+bool CSPrimPolyhedron::ReadCache(CSMeshCache &cache)
+{
+	Reset();
+	MeshData* mesh = m_Mesh;
+	std::vector<unsigned char> faceValid;
+	uint32_t dim = 0;
+	uint32_t invalid = 0;
+	bool ok = cache.ReadArray(mesh->vertices) && cache.ReadArray(mesh->faceIndices) && cache.ReadArray(mesh->faceOffsets)
+			&& cache.ReadArray(faceValid) && cache.ReadValue(dim) && cache.ReadValue(invalid) && m_InsideTest.ReadCache(cache);
+	ok = ok && !mesh->faceOffsets.empty() && (mesh->faceOffsets[0]==0) && (mesh->faceOffsets.back()==mesh->faceIndices.size()) && (faceValid.size()==GetNumFaces());
+	for (size_t n=1;ok && (n<mesh->faceOffsets.size());++n)
+		ok = (mesh->faceOffsets[n-1]<=mesh->faceOffsets[n]);
+	if (ok==false)
+	{
+		Reset();
+		return false;
+	}
+	m_FaceValid.assign(faceValid.begin(), faceValid.end());
+	m_Dimension = dim;
+	m_InvalidFaces = invalid;
+	d_ptr->m_TransformedTest.Clear();
+	GetBoundBox(m_BoundBox);
+	for (int n=0;n<3;++n)
+		d_ptr->m_RayDirection[n] = m_InsideTest.HasRayDirection(n);
+	StoreRelease(m_TreeValid, true);
+	return true;
+}
+
 bool CSPrimPolyhedron::Write2XML(TiXmlElement &elem, bool parameterised)
 {
 	if (CSPrimitives::Write2XML(elem,parameterised)==false)
 		return false;
 
-	for (size_t n=0;n<m_Vertices.size();++n)
+	for (unsigned int n=0;n<GetNumVertices();++n)
 	{
 		TiXmlElement vertex("Vertex");
-		TiXmlText text(CombineArray2String(m_Vertices.at(n).coord,3,','));
+		TiXmlText text(CombineArray2String(GetVertex(n),3,','));
 		vertex.InsertEndChild(text);
 		elem.InsertEndChild(vertex);
 	}
-	for (size_t n=0;n<m_Faces.size();++n)
+	unsigned int numVertex;
+	for (unsigned int n=0;n<GetNumFaces();++n)
 	{
 		TiXmlElement face("Face");
-		TiXmlText text(CombineArray2String(m_Faces.at(n).vertices,m_Faces.at(n).numVertex,','));
+		int* vertices = GetFace(n, numVertex);
+		TiXmlText text(CombineArray2String(vertices,numVertex,','));
 		face.InsertEndChild(text);
 		elem.InsertEndChild(face);
 	}
@@ -345,14 +619,15 @@ bool CSPrimPolyhedron::ReadFromXML(TiXmlNode &root)
 			return false;
 		face = face->NextSiblingElement("Face");
 	}
-	return BuildTree();
+	//the tree is build by Update() or the first query
+	return true;
 }
 
 
 void CSPrimPolyhedron::ShowPrimitiveStatus(std::ostream& stream)
 {
 	CSPrimitives::ShowPrimitiveStatus(stream);
-	stream << " Number of Vertices: " << m_Vertices.size() << std::endl;
-	stream << " Number of Faces: " << m_Faces.size() << std::endl;
+	stream << " Number of Vertices: " << GetNumVertices() << std::endl;
+	stream << " Number of Faces: " << GetNumFaces() << std::endl;
 	stream << " Number of invalid Faces: " << m_InvalidFaces << std::endl;
 }
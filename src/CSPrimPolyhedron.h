@@ -18,12 +18,18 @@
 #pragma once
 
 #include "CSPrimitives.h"
+#include "CSMeshInsideTest.h"
 
 struct CSPrimPolyhedronPrivate;
+class CSRectGrid;
+class CSMeshCache;
 
 //! Polyhedron Primitive
 /*!
  This is a polyhedron primitive. A 3D solid object, defined by vertices and faces
+
+ The vertices and faces are stored in flat arrays, the faces in a compressed sparse row layout (vertex indices of all faces plus the start offset of each face).
+ A copy of a polyhedron shares these arrays with the original until either one is modified.
  */
 class CSXCAD_EXPORT CSPrimPolyhedron : public CSPrimitives
 {
@@ -50,24 +56,56 @@ public:
 	virtual void AddVertex(float p[3]) {AddVertex(p[0],p[1],p[2]);}
 	virtual void AddVertex(double p[3]) {AddVertex(p[0],p[1],p[2]);}
 	virtual void AddVertex(float px, float py, float pz);
+	//! Add a number of vertices given as x,y,z for each vertex
+	virtual void AddVertices(const float* coords, unsigned int numVertices);
 
-	virtual unsigned int GetNumVertices() const {return m_Vertices.size();}
+	virtual unsigned int GetNumVertices() const {return m_Mesh->vertices.size()/3;}
+	//! Get the coordinates of vertex n, do not modify.
 	virtual float* GetVertex(unsigned int n);
 
+	//! Add a face, the polyhedron takes ownership of (and deletes) the vertices array of the face.
 	virtual void AddFace(face f);
 	virtual void AddFace(int numVertex, int* vertices);
 	virtual void AddFace(std::vector<int> vertices);
+	//! Add a number of faces, face n uses the vertices indices[offsets[n]] to indices[offsets[n+1]-1] (numFaces+1 offsets).
+	virtual void AddFaces(const int* indices, const unsigned int* offsets, unsigned int numFaces);
+	//! Add a number of faces with numVertex vertices each (e.g. 3 for triangles).
+	virtual void AddFaces(const int* indices, unsigned int numFaces, unsigned int numVertex=3);
 
+	//! Check the mesh and build the inside test, Update() only rebuilds if the mesh was modified since.
 	virtual bool BuildTree();
+	//! Check if the tree is up to date with the mesh \sa BuildTree
+	bool IsTreeValid() const {return m_TreeValid;}
+
+	//! Defer the tree construction from Update() until the first query (IsInside, GetDimension, ...)
+	void SetLazyBuild(bool val) {m_LazyBuild=val;}
+	bool GetLazyBuild() const {return m_LazyBuild;}
 
-	virtual unsigned int GetNumFaces() const {return m_Faces.size();}
+	virtual unsigned int GetNumFaces() const {return m_Mesh->faceOffsets.size()-1;}
+	//! Get the vertex indices of face n, do not modify.
 	virtual int* GetFace(unsigned int n, unsigned int &numVertices);
-	virtual bool GetFaceValid(unsigned int n) const {return m_Faces.at(n).valid;}
+	virtual bool GetFaceValid(unsigned int n) const;
 
 	virtual CSPrimPolyhedron* GetCopy(CSProperties *prop=NULL) {return new CSPrimPolyhedron(this,prop);}
 
 	virtual bool GetBoundBox(double dBoundBox[6], bool PreserveOrientation=false);
+	//! The dimension is known after the tree is build (3 for a solid, 2 for a surface not closed)
+	virtual int GetDimension();
 	virtual bool IsInside(const double* Coord, double tol=0);
+	//! Check n coordinates given as structure of arrays (n x-values, n y-values, n z-values) \sa CSMeshInsideTest
+	virtual void IsInside(const double* coords, size_t n, bool* inside, double tol=0);
+
+	//! Get the inside intervals along lines in direction ny (scanline voxelization)
+	/*!
+	  The lines are placed at all combinations of the positions linesP in direction (ny+1)%3 and linesPP in direction (ny+2)%3,
+	  line (i,j) has the index i+j*numP. Each line is cast only once and all inside intervals follow from its crossings with the surface.
+	  The intervals of line l are given by the (start,stop) pairs intervals[2*lineOffsets[l]] to intervals[2*lineOffsets[l+1]-1].
+	  With a transformation the lines are cast against the transformed mesh, which is kept until the mesh or the transformation matrix changes.
+	  \return false if the mesh type is not Cartesian or the polyhedron is not a solid, e.g. if its surface is not closed and ray voting is used
+	  */
+	virtual bool GetInsideIntervals(int ny, const double* linesP, unsigned int numP, const double* linesPP, unsigned int numPP, std::vector<unsigned int> &lineOffsets, std::vector<double> &intervals);
+	//! Get the inside intervals along all lines in direction ny of the given grid. \sa GetInsideIntervals
+	virtual bool GetInsideIntervals(CSRectGrid* grid, int ny, std::vector<unsigned int> &lineOffsets, std::vector<double> &intervals);
 
 	virtual bool Update(std::string *ErrStr=NULL);
 	virtual bool Write2XML(TiXmlElement &elem, bool parameterised=true);
@@ -76,8 +114,39 @@ public:
 	virtual void ShowPrimitiveStatus(std::ostream& stream);
 
 protected:
+	//! Vertices and faces, shared by copies of a polyhedron (the reference counting is not thread-safe)
+	struct MeshData
+	{
+		//! x,y,z for each vertex
+		std::vector<float> vertices;
+		//! vertex indices of all faces
+		std::vector<int> faceIndices;
+		//! start of each face in faceIndices, the total number of indices as last entry
+		std::vector<unsigned int> faceOffsets;
+		unsigned int refCount;
+	};
+
 	unsigned int m_InvalidFaces;
-	std::vector<vertex> m_Vertices;
-	std::vector<face> m_Faces;
+	//! the inside test and face states are up to date with the mesh, set with release semantics after the build \sa CheckTree
+	bool m_TreeValid;
+	bool m_LazyBuild;
+	MeshData* m_Mesh;
+	std::vector<bool> m_FaceValid;
+	CSMeshInsideTest m_InsideTest;
 	CSPrimPolyhedronPrivate *d_ptr; //!< pointer to private data structure, to hide the CGAL dependency from applications
+
+	//! Create an empty mesh
+	static MeshData* NewMesh();
+	//! Release the shared mesh
+	void ReleaseMesh();
+	//! Get an unshared mesh for modification
+	MeshData* DetachMesh();
+
+	//! Build the tree if not up to date, thread-safe for parallel queries, only locks if the tree has to be built
+	void CheckTree();
+
+	//! Write the mesh and the processed geometry (face states and inside test) to a cache file, requires a valid tree \sa BuildTree
+	bool WriteCache(CSMeshCache &cache) const;
+	//! Read the mesh and the processed geometry from a cache file, replaces the current mesh and tree
+	bool ReadCache(CSMeshCache &cache);
 };
@@ -21,12 +21,9 @@
 #include "tinyxml.h"
 #include "stdint.h"
 
-#include <vtkSTLReader.h>
-#include <vtkPLYReader.h>
-#include <vtkPolyData.h>
-#include <vtkCellArray.h>
-
 #include "CSPrimPolyhedronReader.h"
+#include "CSMeshFileReader.h"
+#include "CSMeshCache.h"
 #include "CSProperties.h"
 #include "CSUseful.h"
 
@@ -36,6 +33,7 @@ CSPrimPolyhedronReader::CSPrimPolyhedronReader(ParameterSet* paraSet, CSProperti
 	PrimTypeName = "PolyhedronReader";
 	m_filetype = UNKNOWN;
 	m_filename = std::string();
+	m_CacheKey = 0;
 }
 
 CSPrimPolyhedronReader::CSPrimPolyhedronReader(CSPrimPolyhedronReader* primPHReader, CSProperties *prop) : CSPrimPolyhedron(primPHReader, prop)
@@ -45,6 +43,8 @@ CSPrimPolyhedronReader::CSPrimPolyhedronReader(CSPrimPolyhedronReader* primPHRea
 
 	m_filename = primPHReader->m_filename;
 	m_filetype = primPHReader->m_filetype;
+	m_CacheDir = primPHReader->m_CacheDir;
+	m_CacheKey = 0;
 }
 
 CSPrimPolyhedronReader::CSPrimPolyhedronReader(unsigned int ID, ParameterSet* paraSet, CSProperties* prop) : CSPrimPolyhedron(ID, paraSet, prop)
@@ -53,12 +53,34 @@ CSPrimPolyhedronReader::CSPrimPolyhedronReader(unsigned int ID, ParameterSet* pa
 	PrimTypeName = "PolyhedronReader";
 	m_filetype = UNKNOWN;
 	m_filename = std::string();
+	m_CacheKey = 0;
 }
 
 CSPrimPolyhedronReader::~CSPrimPolyhedronReader()
 {
 }
 
+void CSPrimPolyhedronReader::Reset()
+{
+	CSPrimPolyhedron::Reset();
+	m_CacheWriteFile.clear();
+}
+
+bool CSPrimPolyhedronReader::BuildTree()
+{
+	bool ok = CSPrimPolyhedron::BuildTree();
+	if (m_CacheWriteFile.empty())
+		return ok;
+	CSMeshCache cache;
+	if ((cache.OpenWrite(m_CacheWriteFile, m_CacheKey) && WriteCache(cache) && cache.Close())==false)
+	{
+		cache.Abort();
+		std::cerr << "CSPrimPolyhedronReader::BuildTree: Warning, unable to write cache file \"" << m_CacheWriteFile << "\"" << std::endl;
+	}
+	m_CacheWriteFile.clear();
+	return ok;
+}
+
 bool CSPrimPolyhedronReader::Update(std::string *ErrStr)
 {
 	return CSPrimPolyhedron::Update(ErrStr);
@@ -67,6 +89,8 @@ bool CSPrimPolyhedronReader::Update(std::string *ErrStr)
 bool CSPrimPolyhedronReader::Write2XML(TiXmlElement &elem, bool parameterised)
 {
 	elem.SetAttribute("Filename",m_filename);
+	if (!m_CacheDir.empty())
+		elem.SetAttribute("CacheDir",m_CacheDir);
 
 	switch (m_filetype)
 	{
@@ -76,6 +100,9 @@ bool CSPrimPolyhedronReader::Write2XML(TiXmlElement &elem, bool parameterised)
 	case PLY_FILE:
 		elem.SetAttribute("FileType","PLY");
 		break;
+	case OBJ_FILE:
+		elem.SetAttribute("FileType","OBJ");
+		break;
 	default:
 		elem.SetAttribute("FileType","Unkown");
 		break;
@@ -104,40 +131,52 @@ bool CSPrimPolyhedronReader::ReadFromXML(TiXmlNode &root)
 		m_filetype=STL_FILE;
 	else if (type.compare("PLY")==0)
 		m_filetype=PLY_FILE;
+	else if (type.compare("OBJ")==0)
+		m_filetype=OBJ_FILE;
 	else
 		m_filetype=UNKNOWN;
 
+	if (elem->QueryStringAttribute("CacheDir",&m_CacheDir)!=TIXML_SUCCESS)
+		m_CacheDir.clear();
+
 	if (ReadFile()==false)
 	{
 		std::cerr << "CSPrimPolyhedronReader::ReadFromXML: Failed to read file." << std::endl;
 		return false;
 	}
 
-	return BuildTree();
+	//the tree is build by Update() or the first query
+	return true;
 }
 
 bool CSPrimPolyhedronReader::ReadFile()
 {
-	vtkPolyData *polydata = NULL;
+	//the cache contains the complete mesh and can only be used for an empty polyhedron
+	uint64_t key = 0;
+	bool useCache = !m_CacheDir.empty() && (GetNumVertices()==0) && (GetNumFaces()==0) && CSMeshCache::HashFile(m_filename, key);
+	std::string cacheFile;
+	if (useCache)
+	{
+		key = CSMeshCache::HashCombine(key, m_filetype);
+		cacheFile = CSMeshCache::GetCacheFilename(m_CacheDir, key);
+		CSMeshCache cache;
+		if (cache.OpenRead(cacheFile, key) && ReadCache(cache))
+			return true;
+	}
+
+	CSMeshFileReader reader;
+	bool ok = false;
 	switch (m_filetype)
 	{
 	case STL_FILE:
-	{
-		vtkSTLReader* reader = vtkSTLReader::New();
-		reader->SetFileName(m_filename.c_str());
-		reader->SetMerging(1);
-		polydata = reader->GetOutput(0);
-		reader->Update();
+		ok = reader.ReadSTL(m_filename);
 		break;
-	}
 	case PLY_FILE:
-	{
-		vtkPLYReader* reader = vtkPLYReader::New();
-		reader->SetFileName(m_filename.c_str());
-		polydata = reader->GetOutput(0);
-		reader->Update();
+		ok = reader.ReadPLY(m_filename);
+		break;
+	case OBJ_FILE:
+		ok = reader.ReadOBJ(m_filename);
 		break;
-	}
 	case UNKNOWN:
 	default:
 	{
@@ -146,32 +185,25 @@ bool CSPrimPolyhedronReader::ReadFile()
 		break;
 	}
 	}
-	//polydata->Update(); // not availabe for vtk 6.x, now done only on reader?
-	if ((polydata->GetNumberOfPoints()==0) || (polydata->GetNumberOfCells()==0))
+	if (ok==false)
 	{
-		std::cerr << "CSPrimPolyhedronReader::ReadFile: file invalid or empty, skipping ..." << std::endl;
+		std::cerr << "CSPrimPolyhedronReader::ReadFile: " << reader.GetErrorString() << ", skipping ..." << std::endl;
 		return false;
 	}
-	vtkCellArray *verts = polydata->GetPolys();
-	if (verts->GetNumberOfCells()==0)
+	if ((reader.GetNumVertices()==0) || (reader.GetNumFaces()==0))
 	{
 		std::cerr << "CSPrimPolyhedronReader::ReadFile: file invalid or empty, skipping ..." << std::endl;
 		return false;
 	}
 
-	for (int n=0;n<polydata->GetNumberOfPoints();++n)
-		AddVertex(polydata->GetPoint(n));
+	AddVertices(reader.GetVertices(), reader.GetNumVertices());
+	AddFaces(reader.GetFaceIndices(), reader.GetFaceOffsets(), reader.GetNumFaces());
 
-	vtkIdType numP;
-	vtkIdType *vertices = new vtkIdType[10];
-	while (verts->GetNextCell(numP, vertices))
+	//the cache is written once the tree is build
+	if (useCache)
 	{
-		face f;
-		f.numVertex=numP;
-		f.vertices = new int[f.numVertex];
-		for (unsigned int np=0;np<f.numVertex;++np)
-			f.vertices[np]=vertices[np];
-		AddFace(f);
+		m_CacheWriteFile = cacheFile;
+		m_CacheKey = key;
 	}
 	return true;
 }
@@ -17,17 +17,18 @@
 
 #pragma once
 
+#include "stdint.h"
 #include "CSPrimitives.h"
 #include "CSPrimPolyhedron.h"
 
-//! STL/PLY import primitive
+//! STL/PLY/OBJ import primitive
 class CSXCAD_EXPORT CSPrimPolyhedronReader : public CSPrimPolyhedron
 {
 public:
 	//! Import file type
 	enum FileType
 	{
-		UNKNOWN, STL_FILE, PLY_FILE
+		UNKNOWN, STL_FILE, PLY_FILE, OBJ_FILE
 	};
 
 	CSPrimPolyhedronReader(ParameterSet* paraSet, CSProperties* prop);
@@ -43,13 +44,31 @@ public:
 	virtual void SetFileType(FileType ft) {m_filetype=ft;}
 	virtual FileType GetFileType() const {return m_filetype;}
 
+	//! Set a directory to cache the processed geometry of the file (disabled if empty, default)
+	/*!
+	  The cache files are named by a hash of the file content and type. A file read again (e.g. during a parameter sweep) is loaded
+	  from the cache instead of being parsed and checked again. The geometry is cached in local coordinates, thus a changed transformation
+	  can use the same cache file. \sa CSMeshCache
+	  */
+	virtual void SetCacheDirectory(std::string dir) {m_CacheDir=dir;}
+	virtual std::string GetCacheDirectory() const {return m_CacheDir;}
+
+	virtual void Reset();
+	//! Build the tree and write the cache file of a file read before (if enabled)
+	virtual bool BuildTree();
+
 	virtual bool Update(std::string *ErrStr=NULL);
 	virtual bool Write2XML(TiXmlElement &elem, bool parameterised=true);
 	virtual bool ReadFromXML(TiXmlNode &root);
 
+	//! Read the mesh file, vertices of STL files are merged \sa CSMeshFileReader, SetCacheDirectory
 	virtual bool ReadFile();
 
 protected:
 	std::string m_filename;
 	FileType m_filetype;
+	std::string m_CacheDir;
+	//! cache file to write by the next BuildTree()
+	std::string m_CacheWriteFile;
+	uint64_t m_CacheKey;
 };
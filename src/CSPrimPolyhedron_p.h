@@ -4,14 +4,7 @@
 #include <CGAL/Simple_cartesian.h>
 #include <CGAL/Polyhedron_incremental_builder_3.h>
 #include <CGAL/Polyhedron_3.h>
-#include <CGAL/AABB_tree.h>
-#include <CGAL/AABB_traits.h>
-#if CGAL_VERSION_NR >= CGAL_VERSION_NUMBER(4,6,0)
-    #include <CGAL/AABB_face_graph_triangle_primitive.h>
-#else
-    #include <CGAL/AABB_polyhedron_triangle_primitive.h>
-    #include <CGAL/AABB_polyhedron_segment_primitive.h>
-#endif
+#include <boost/thread/mutex.hpp>
 
 typedef CGAL::Simple_cartesian<double>     Kernel;
 typedef CGAL::Polyhedron_3<Kernel>         Polyhedron;
@@ -28,20 +21,20 @@ protected:
 };
 
 typedef Kernel::Point_3                                             Point;
-#if CGAL_VERSION_NR >= CGAL_VERSION_NUMBER(4,6,0)
-typedef CGAL::AABB_face_graph_triangle_primitive<Polyhedron>        Primitive;
-#else
-typedef CGAL::AABB_polyhedron_triangle_primitive<Kernel,Polyhedron> Primitive;
-#endif
-typedef CGAL::AABB_traits<Kernel, Primitive>                        Traits;
-typedef CGAL::Simple_cartesian<double>::Ray_3                       Ray;
-typedef Kernel::Segment_3                                           Segment;
 
 struct CSPrimPolyhedronPrivate
 {
 	Polyhedron m_Polyhedron;
-	Point m_RandPt;
-	CGAL::AABB_tree<Traits> *m_PolyhedronTree;
+	//! guards a deferred build of the tree by the first (possibly parallel) query
+	boost::mutex m_BuildMutex;
+	//! the ray directions prepared in the inside test, written with release semantics (see CSPrimPolyhedron::CheckTree)
+	bool m_RayDirection[3];
+
+	//! inside test of the transformed mesh for GetInsideIntervals, valid until the mesh or the transformation matrix changes (guarded by m_BuildMutex)
+	CSMeshInsideTest m_TransformedTest;
+	double m_TransformedMatrix[16];
+
+	CSPrimPolyhedronPrivate() {m_RayDirection[0]=m_RayDirection[1]=m_RayDirection[2]=false;}
 };
 
 
@@ -35,7 +35,7 @@ public:
 
 	virtual CSPrimRotPoly* GetCopy(CSProperties *prop=NULL) {return new CSPrimRotPoly(this,prop);}
 
-	void SetRotAxisDir(int dir) {if ((dir>=0) && (dir<3)) m_RotAxisDir=dir;}
+	void SetRotAxisDir(int dir) {if ((dir>=0) && (dir<3)) m_RotAxisDir=dir; m_Modified=true;}
 
 	int GetRotAxisDir() const {return m_RotAxisDir;}
 
@@ -30,6 +30,8 @@ CSPrimUserDefined::CSPrimUserDefined(unsigned int ID, ParameterSet* paraSet, CSP
 {
 	Type=USERDEFINED;
 	fParse = new CSFunctionParser();
+	m_ParserPool = new CSFunctionParserPool();
+	m_ParserPool->SetParser(fParse);
 	stFunction = std::string();
 	CoordSystem=CARESIAN_SYSTEM;
 	for (int i=0;i<3;++i) {dPosShift[i].SetParameterSet(paraSet);}
@@ -40,6 +42,8 @@ CSPrimUserDefined::CSPrimUserDefined(CSPrimUserDefined* primUDef, CSProperties *
 {
 	Type=USERDEFINED;
 	fParse = new CSFunctionParser(*primUDef->fParse);
+	m_ParserPool = new CSFunctionParserPool();
+	m_ParserPool->SetParser(fParse);
 	stFunction = std::string(primUDef->stFunction);
 	CoordSystem = primUDef->CoordSystem;
 	for (int i=0;i<3;++i)
@@ -51,6 +55,8 @@ CSPrimUserDefined::CSPrimUserDefined(ParameterSet* paraSet, CSProperties* prop)
 {
 	Type=USERDEFINED;
 	fParse = new CSFunctionParser();
+	m_ParserPool = new CSFunctionParserPool();
+	m_ParserPool->SetParser(fParse);
 	stFunction = std::string();
 	CoordSystem=CARESIAN_SYSTEM;
 	for (int i=0;i<3;++i)
@@ -61,18 +67,21 @@ CSPrimUserDefined::CSPrimUserDefined(ParameterSet* paraSet, CSProperties* prop)
 
 CSPrimUserDefined::~CSPrimUserDefined()
 {
+	delete m_ParserPool;m_ParserPool=NULL;
 	delete fParse;fParse=NULL;
 }
 
 void CSPrimUserDefined::SetCoordSystem(UserDefinedCoordSystem newSystem)
 {
 	CoordSystem=newSystem;
+	m_Modified=true;
 }
 
 void CSPrimUserDefined::SetFunction(const char* func)
 {
 	if (func==NULL) return;
 	stFunction = std::string(func);
+	m_Modified=true;
 }
 
 bool CSPrimUserDefined::GetBoundBox(double dBoundBox[6], bool PreserveOrientation)
@@ -129,12 +138,15 @@ bool CSPrimUserDefined::IsInside(const double* Coord, double /*tol*/)
 		break;
 	default:
 		//unknown System
+		delete[] vars;
 		return false;
 		break;
 	}
 	double dValue=0;
 
-	if (fParse->GetParseErrorType()==FunctionParser::FP_NO_ERROR) dValue=fParse->Eval(vars);
+	int EC=0;
+	// the parser itself is not reentrant, evaluate a copy of it
+	if (fParse->GetParseErrorType()==FunctionParser::FP_NO_ERROR) dValue=m_ParserPool->Eval(vars,EC);
 	else dValue=0;
 	delete[] vars;vars=NULL;
 
@@ -173,6 +185,8 @@ bool CSPrimUserDefined::Update(std::string *ErrStr)
 	}
 
 	fParse->Parse(stFunction,vars);
+	// all copies used for the evaluation are outdated
+	m_ParserPool->Clear();
 
 	EC=fParse->GetParseErrorType();
 	//cout << fParse.ErrorMsg();
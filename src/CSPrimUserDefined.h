@@ -19,9 +19,12 @@
 
 #include "CSPrimitives.h"
 
+class CSFunctionParserPool;
+
 //! User defined Primitive given by an analytic formula
 /*!
  This primitive is defined by a boolean result analytic formula. If a given coordinate results in a true result the primitive is assumed existing at these coordinate.
+ The inside test is reentrant, every concurrent test evaluates its own copy of the parsed formula.
  */
 class CSXCAD_EXPORT CSPrimUserDefined: public CSPrimitives
 {
@@ -60,6 +63,8 @@ protected:
 	std::string stFunction;
 	UserDefinedCoordSystem CoordSystem;
 	CSFunctionParser* fParse;
+	//! copies of the parser for concurrent inside tests
+	CSFunctionParserPool* m_ParserPool;
 	std::string fParameter;
 	int iQtyParameter;
 	ParameterScalar dPosShift[3];
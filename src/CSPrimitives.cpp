@@ -29,6 +29,11 @@
 
 #include <math.h>
 
+#include <boost/thread/mutex.hpp>
+
+// guards the used flag of all primitives, set by concurrent coordinate queries
+static boost::mutex g_UsedMutex;
+
 #define PI acos(-1)
 
 int g_PrimUniqueIDCounter=0;
@@ -78,8 +83,8 @@ bool CSXCAD_EXPORT CoordInRange(const double* coord, const double* start, const
 CSPrimitives::CSPrimitives(unsigned int ID, ParameterSet* paraSet, CSProperties* prop)
 {
 	this->Init();
-	SetProperty(prop);
 	uiID=ID;
+	SetProperty(prop);
 	clParaSet=paraSet;
 }
 
@@ -114,6 +119,7 @@ void CSPrimitives::Init()
 	iPriority=0;
 	PrimTypeName = std::string("Base Type");
 	m_Primtive_Used = false;
+	m_Modified = true;
 	m_MeshType = CARTESIAN;
 	m_PrimCoordSystem = UNDEFINED_CS;
 	m_BoundBox_CoordSys = UNDEFINED_CS;
@@ -123,6 +129,26 @@ void CSPrimitives::Init()
 	m_BoundBoxValid = false;
 }
 
+bool CSPrimitives::GetPrimitiveUsed()
+{
+	boost::mutex::scoped_lock lock(g_UsedMutex);
+	return m_Primtive_Used;
+}
+
+void CSPrimitives::SetPrimitiveUsed(bool val)
+{
+	boost::mutex::scoped_lock lock(g_UsedMutex);
+	m_Primtive_Used=val;
+}
+
+void CSPrimitives::SetID(unsigned int ID)
+{
+	uiID=ID;
+	// the owning property looks up its primitives by ID
+	if (clProperty!=NULL)
+		clProperty->RebuildPrimitiveIndex();
+}
+
 CSTransform* CSPrimitives::GetTransform()
 {
 	if (m_Transform==NULL)
@@ -134,6 +160,8 @@ void CSPrimitives::SetProperty(CSProperties *prop)
 {
 	if ((clProperty!=NULL) && (clProperty!=prop))
 		clProperty->RemovePrimitive(this);
+	if (clProperty!=prop)
+		m_Modified=true;
 	clProperty=prop;
 	if ((prop!=NULL) && (!prop->HasPrimitive(this)))
 		prop->AddPrimitive(this);
@@ -169,6 +197,61 @@ int CSPrimitives::IsInsideBox(const double *boundbox)
 	return 1;
 }
 
+bool CSPrimitives::GetCartesianBoundBox(double dBoundBox[6])
+{
+	bool accurate = GetBoundBox(dBoundBox);
+	if (accurate==false)
+	{
+		// these primitives report an enclosing but not necessarily tight box
+		switch (Type)
+		{
+		case MULTIBOX:
+		case CYLINDER:
+		case CYLINDRICALSHELL:
+		case POLYGON:
+		case LINPOLY:
+		case CURVE:
+		case WIRE:
+			break;
+		default:
+			return false;
+		}
+	}
+
+	CoordinateSystem cs = GetBoundBoxCoordSystem();
+	if (cs==UNDEFINED_CS)
+		cs = m_MeshType;
+	if (cs!=CARTESIAN)
+		return false;
+
+	for (int n=0;n<3;++n)
+		if (dBoundBox[2*n]>dBoundBox[2*n+1])
+			std::swap(dBoundBox[2*n],dBoundBox[2*n+1]);
+
+	if ((m_Transform==NULL) || (m_Transform->HasTransform()==false))
+		return true;
+
+	// transform all eight corners and use their enclosing box
+	double corner[3];
+	double box[6];
+	for (int c=0;c<8;++c)
+	{
+		for (int n=0;n<3;++n)
+			corner[n] = dBoundBox[2*n+((c>>n)&1)];
+		m_Transform->Transform(corner,corner);
+		for (int n=0;n<3;++n)
+		{
+			if ((c==0) || (corner[n]<box[2*n]))
+				box[2*n] = corner[n];
+			if ((c==0) || (corner[n]>box[2*n+1]))
+				box[2*n+1] = corner[n];
+		}
+	}
+	for (int n=0;n<6;++n)
+		dBoundBox[n] = box[n];
+	return true;
+}
+
 bool CSPrimitives::Write2XML(TiXmlElement &elem, bool /*parameterised*/)
 {
 	elem.SetAttribute("Priority",iPriority);
@@ -89,7 +89,7 @@ public:
 	//! Getthe unique ID for this primitive.
 	unsigned int GetID() {return uiID;}
 	//! Change the unique ID for this primitive. This is not recommended! Be sure what you are doing!
-	void SetID(unsigned int ID) {uiID=ID;}
+	void SetID(unsigned int ID);
 
 	//! Get the type of this primitive. \sa PrimitiveType
 	int GetType() {return Type;}
@@ -104,6 +104,9 @@ public:
 
 	virtual CoordinateSystem GetBoundBoxCoordSystem() const {return m_BoundBox_CoordSys;}
 
+	//! Get a conservative, axis aligned bounding box in Cartesian coordinates including a possible transformation. \return false if no such box can be determined (e.g. for user defined primitives)
+	virtual bool GetCartesianBoundBox(double dBoundBox[6]);
+
 	//! Get the dimension of this primitive
 	virtual int GetDimension() {return m_Dimension;}
 
@@ -115,9 +118,9 @@ public:
 	virtual int IsInsideBox(const double*  boundbox);
 
 	//! Check whether this primitive was used. (--> IsInside() return true) \sa SetPrimitiveUsed
-	bool GetPrimitiveUsed() {return m_Primtive_Used;}
-	//! Set the primitve uses flag. \sa GetPrimitiveUsed
-	void SetPrimitiveUsed(bool val) {m_Primtive_Used=val;}
+	bool GetPrimitiveUsed();
+	//! Set the primitve uses flag, can be used by concurrent queries. \sa GetPrimitiveUsed
+	void SetPrimitiveUsed(bool val);
 
 	//! Set or change the priotity for this primitive.
 	void SetPriority(int val) {iPriority=val;}
@@ -126,6 +129,15 @@ public:
 
 	//! Update this primitive with respect to the parameters set.
 	virtual bool Update(std::string *ErrStr=NULL) {UNUSED(ErrStr);return true;}
+
+	//! Mark this primitive as modified by a change not tracked by its parameter scalars. \sa ContinuousStructure::Update
+	void SetModified(bool val=true) {m_Modified=val;}
+	//! Check if this primitive was modified since the last update by ContinuousStructure::Update
+	bool GetModified() const {return m_Modified;}
+	//! Set the parameters used during the last update of this primitive (recorded by ContinuousStructure::Update)
+	void SetParameterDependencies(const std::vector<Parameter*> &deps) {m_ParaDependencies=deps;}
+	//! Get the parameters used during the last update of this primitive
+	const std::vector<Parameter*>& GetParameterDependencies() const {return m_ParaDependencies;}
 	//! Write this primitive to a XML-node.
 	virtual bool Write2XML(TiXmlElement &elem, bool parameterised=true);
 	//! Read this primitive from a XML-node.
@@ -168,17 +180,19 @@ public:
 	bool operator!=(CSPrimitives& vgl) { return iPriority!=vgl.GetPriority();}
 
 	//! Define the input type for the weighting coordinate system 0=cartesian, 1=cylindrical, 2=spherical
-	void SetCoordInputType(CoordinateSystem type, bool doUpdate=true) {m_MeshType=type; if (doUpdate) Update();}
+	void SetCoordInputType(CoordinateSystem type, bool doUpdate=true) {m_MeshType=type; m_Modified=true; if (doUpdate) Update();}
 	//! Get the input type for the weighting coordinate system 0=cartesian, 1=cylindrical, 2=spherical
 	CoordinateSystem GetCoordInputType() const {return m_MeshType;}
 
 	//! Define the coordinate system this primitive is defined in (may be different to the input mesh type) \sa SetCoordInputType
-	void SetCoordinateSystem(CoordinateSystem cs) {m_PrimCoordSystem=cs;}
+	void SetCoordinateSystem(CoordinateSystem cs) {m_PrimCoordSystem=cs; m_Modified=true;}
 	//! Read the coordinate system for this primitive (may be different to the input mesh type) \sa GetCoordInputType
 	CoordinateSystem GetCoordinateSystem() const {return m_PrimCoordSystem;}
 
 	//! Get the CSTransform if it exists already or create a new one
 	CSTransform* GetTransform();
+	//! Check if a CSTransform was created for this primitive \sa GetTransform
+	bool HasTransform() const {return m_Transform!=NULL;}
 
 	//! Show status of this primitve
 	virtual void ShowPrimitiveStatus(std::ostream& stream);
@@ -202,6 +216,10 @@ protected:
 	std::string PrimTypeName;
 	bool m_Primtive_Used;
 
+	//! modified since the last update by ContinuousStructure::Update, parameters used during the last update
+	bool m_Modified;
+	std::vector<Parameter*> m_ParaDependencies;
+
 	//internal bounding box, updated by Update(), can be used to speedup IsInside
 	bool m_BoundBoxValid;
 	double m_BoundBox[6];
@@ -16,6 +16,7 @@
 */
 
 #include "tinyxml.h"
+#include <algorithm>
 #include <hdf5.h>
 #include <hdf5_hl.h>
 
@@ -51,8 +52,9 @@ CSPropDiscMaterial::~CSPropDiscMaterial()
 		delete[] m_mesh[n];
 		m_mesh[n]=NULL;
 	}
-	delete[] m_Disc_Ind;
-	m_Disc_Ind=NULL;
+	m_Disc_Ind.Clear();
+	delete m_IndexCache;
+	m_IndexCache=NULL;
 	delete[] m_Disc_epsR;
 	m_Disc_epsR=NULL;
 	delete[] m_Disc_kappa;
@@ -68,47 +70,140 @@ CSPropDiscMaterial::~CSPropDiscMaterial()
 	m_Transform=NULL;
 }
 
-unsigned int CSPropDiscMaterial::GetWeightingPos(const double* inCoords)
+int CSPropDiscMaterial::GetCellIndex(int ny, double coord, int hint) const
+{
+	const float* mesh = m_mesh[ny];
+	int numCells = (int)m_Size[ny]-1;
+	if ((coord<mesh[0]) || (coord>mesh[numCells]))
+		return -1;
+
+	int pos;
+	// check the given cell and its neighbors first, efficient for consecutive coordinates
+	for (pos=hint-1;(hint>=0) && (pos<=hint+1);++pos)
+	{
+		if ((pos<0) || (pos>=numCells))
+			continue;
+		if ((coord>=mesh[pos]) && ((pos==numCells-1) || (coord<mesh[pos+1])))
+			return pos;
+	}
+	if (m_MeshUniform[ny])
+	{
+		// direct index calculation, corrected for rounding errors
+		pos = (int)((coord-mesh[0])/m_MeshDelta[ny]);
+		if (pos<0)
+			pos = 0;
+		if (pos>numCells-1)
+			pos = numCells-1;
+		while ((pos>0) && (coord<mesh[pos]))
+			--pos;
+		while ((pos<numCells-1) && (coord>=mesh[pos+1]))
+			++pos;
+		return pos;
+	}
+	// last mesh line with mesh[pos]<=coord, a coordinate on the upper boundary belongs to the last cell
+	pos = (int)(std::upper_bound(mesh, mesh+numCells+1, coord) - mesh) - 1;
+	if (pos>numCells-1)
+		pos = numCells-1;
+	return pos;
+}
+
+void CSPropDiscMaterial::TransformToDiscCoords(const double* inCoords, double* coords) const
 {
-	double coords[3];
 	TransformCoordSystem(inCoords, coords, coordInputType, CARTESIAN);
 	if (m_Transform)
 		m_Transform->InvertTransform(coords,coords);
 	for (int n=0;n<3;++n)
 		coords[n]/=m_Scale;
-	unsigned int pos[3];
+}
+
+unsigned int CSPropDiscMaterial::GetWeightingPos(const double* inCoords)
+{
 	if (!(m_mesh[0] && m_mesh[1] && m_mesh[2]))
 		return -1;
+	double coords[3];
+	TransformToDiscCoords(inCoords, coords);
+	int pos[3];
 	for (int n=0;n<3;++n)
 	{
-		if (coords[n]<m_mesh[n][0])
-			return -1;
-		if (coords[n]>m_mesh[n][m_Size[n]-1])
+		pos[n] = GetCellIndex(n, coords[n]);
+		if (pos[n]<0)
 			return -1;
-		pos[n]=0;
-		for (unsigned int i=1;i<m_Size[n];++i)
+	}
+	return pos[0] + pos[1]*(m_Size[0]-1) + pos[2]*(m_Size[0]-1)*(m_Size[1]-1);
+}
+
+void CSPropDiscMaterial::GetWeightingPos(const double* inCoords, size_t n, unsigned int* weightPos)
+{
+	if (!(m_mesh[0] && m_mesh[1] && m_mesh[2]))
+	{
+		for (size_t i=0;i<n;++i)
+			weightPos[i] = -1;
+		return;
+	}
+	double inCoord[3];
+	double coords[3];
+	int pos[3];
+	int hint[3] = {-1,-1,-1};
+	for (size_t i=0;i<n;++i)
+	{
+		inCoord[0] = inCoords[i];
+		inCoord[1] = inCoords[n+i];
+		inCoord[2] = inCoords[2*n+i];
+		TransformToDiscCoords(inCoord, coords);
+		weightPos[i] = 0;
+		for (int ny=0;ny<3;++ny)
 		{
-			if (coords[n]<m_mesh[n][i])
+			pos[ny] = GetCellIndex(ny, coords[ny], hint[ny]);
+			if (pos[ny]<0)
 			{
-				pos[n]=i-1;
+				weightPos[i] = -1;
 				break;
 			}
+			hint[ny] = pos[ny];
 		}
+		if (weightPos[i]==(unsigned int)-1)
+			continue;
+		weightPos[i] = pos[0] + pos[1]*(m_Size[0]-1) + pos[2]*(m_Size[0]-1)*(m_Size[1]-1);
+	}
+}
+
+void CSPropDiscMaterial::DetectUniformMesh()
+{
+	for (int n=0;n<3;++n)
+	{
+		m_MeshUniform[n] = false;
+		m_MeshDelta[n] = 0;
+		if ((m_mesh[n]==NULL) || (m_Size[n]<2))
+			continue;
+		double delta = ((double)m_mesh[n][m_Size[n]-1]-(double)m_mesh[n][0])/(m_Size[n]-1);
+		if (delta<=0)
+			continue;
+		m_MeshUniform[n] = true;
+		for (unsigned int i=1;i<m_Size[n];++i)
+			if (fabs((double)m_mesh[n][i]-(double)m_mesh[n][0]-i*delta) > 1e-3*delta)
+			{
+				m_MeshUniform[n] = false;
+				break;
+			}
+		m_MeshDelta[n] = delta;
 	}
-	return pos[0] + pos[1]*(m_Size[0]-1) + pos[2]*(m_Size[0]-1)*(m_Size[1]-1);
 }
 
 int CSPropDiscMaterial::GetDBPos(const double* coords)
 {
-	if (m_Disc_Ind==NULL)
+	if (HasDiscIndex()==false)
 		return -1;
-	unsigned int pos = GetWeightingPos(coords);
+	return GetDBPosFromWeightingPos(GetWeightingPos(coords));
+}
+
+int CSPropDiscMaterial::GetDBPosFromWeightingPos(unsigned int pos) const
+{
 	if (pos==(unsigned int)-1)
 		return -1;
 	// material with index 0 is assumed to be background material
-	if ((m_DB_Background==false) && (m_Disc_Ind[pos]==0))
+	int db_pos = (int)GetDiscIndex(pos);
+	if ((m_DB_Background==false) && (db_pos==0))
 			return -1;
-	int db_pos = (int)m_Disc_Ind[pos];
 	if (db_pos>=(int)m_DB_size)
 	{
 		//sanity check, this should not happen!!!
@@ -118,6 +213,40 @@ int CSPropDiscMaterial::GetDBPos(const double* coords)
 	return db_pos;
 }
 
+// number of coordinates processed as one block by the batch lookup
+#define DISC_BLOCK_SIZE 64
+
+void CSPropDiscMaterial::GetDiscWeighted(const float* disc, ParameterScalar* weight, int ny, double value, const double* coords, size_t n, double* out)
+{
+	if ((disc==NULL) || (HasDiscIndex()==false))
+		return GetWeight(weight,ny,coords,n,out,value);
+
+	unsigned int weightPos[DISC_BLOCK_SIZE];
+	int dbPos[DISC_BLOCK_SIZE];
+	double blockCoords[3*DISC_BLOCK_SIZE];
+	for (size_t start=0;start<n;start+=DISC_BLOCK_SIZE)
+	{
+		size_t count = std::min((size_t)DISC_BLOCK_SIZE,n-start);
+		for (int d=0;d<3;++d)
+			for (size_t i=0;i<count;++i)
+				blockCoords[d*count+i] = coords[d*n+start+i];
+		GetWeightingPos(blockCoords, count, weightPos);
+		bool outside = false;
+		for (size_t i=0;i<count;++i)
+		{
+			dbPos[i] = GetDBPosFromWeightingPos(weightPos[i]);
+			if (dbPos[i]<0)
+				outside = true;
+		}
+		// use the weighted material values for all coordinates outside the discrete material
+		if (outside)
+			GetWeight(weight,ny,blockCoords,count,out+start,value);
+		for (size_t i=0;i<count;++i)
+			if (dbPos[i]>=0)
+				out[start+i] = disc[dbPos[i]];
+	}
+}
+
 double CSPropDiscMaterial::GetEpsilonWeighted(int ny, const double* inCoords)
 {
 	if (m_Disc_epsR==NULL)
@@ -168,6 +297,31 @@ double CSPropDiscMaterial::GetDensityWeighted(const double* inCoords)
 	return m_Disc_Density[pos];
 }
 
+void CSPropDiscMaterial::GetEpsilonWeighted(int ny, const double* coords, size_t n, double* out)
+{
+	GetDiscWeighted(m_Disc_epsR,WeightEpsilon,ny,GetEpsilon(ny),coords,n,out);
+}
+
+void CSPropDiscMaterial::GetMueWeighted(int ny, const double* coords, size_t n, double* out)
+{
+	GetDiscWeighted(m_Disc_mueR,WeightMue,ny,GetMue(ny),coords,n,out);
+}
+
+void CSPropDiscMaterial::GetKappaWeighted(int ny, const double* coords, size_t n, double* out)
+{
+	GetDiscWeighted(m_Disc_kappa,WeightKappa,ny,GetKappa(ny),coords,n,out);
+}
+
+void CSPropDiscMaterial::GetSigmaWeighted(int ny, const double* coords, size_t n, double* out)
+{
+	GetDiscWeighted(m_Disc_sigma,WeightSigma,ny,GetSigma(ny),coords,n,out);
+}
+
+void CSPropDiscMaterial::GetDensityWeighted(const double* coords, size_t n, double* out)
+{
+	GetDiscWeighted(m_Disc_Density,&WeightDensity,0,GetDensity(),coords,n,out);
+}
+
 void CSPropDiscMaterial::Init()
 {
 	m_Filename.clear();
@@ -177,8 +331,16 @@ void CSPropDiscMaterial::Init()
 	m_DB_Background = true;
 
 	for (int n=0;n<3;++n)
+	{
 		m_mesh[n]=NULL;
-	m_Disc_Ind=NULL;
+		m_MeshUniform[n]=false;
+		m_MeshDelta[n]=0;
+	}
+	m_Disc_Ind.Clear();
+	m_SparseIndex=true;
+	m_IndexCache=NULL;
+	m_LazyLoad=false;
+	m_CacheSize=256*1024*1024;
 	m_Disc_epsR=NULL;
 	m_Disc_kappa=NULL;
 	m_Disc_mueR=NULL;
@@ -202,6 +364,13 @@ bool CSPropDiscMaterial::Write2XML(TiXmlNode& root, bool parameterised, bool spa
 	filename.SetAttribute("File",m_Filename.c_str());
 	filename.SetAttribute("UseDBBackground",m_DB_Background);
 	filename.SetAttribute("Scale",m_Scale);
+	if (m_LazyLoad)
+	{
+		filename.SetAttribute("LazyLoad",1);
+		filename.SetDoubleAttribute("CacheSize",m_CacheSize/1024.0/1024.0);
+	}
+	if (m_SparseIndex==false)
+		filename.SetAttribute("SparseIndex",0);
 
 	if (m_Transform)
 		m_Transform->Write2XML(prop);
@@ -232,6 +401,14 @@ bool CSPropDiscMaterial::ReadFromXML(TiXmlNode &root)
 	if (prop->QueryDoubleAttribute("Scale",&m_Scale)!=TIXML_SUCCESS)
 		m_Scale=1;
 
+	if (prop->QueryIntAttribute("LazyLoad",&help)==TIXML_SUCCESS)
+		SetLazyLoading(help!=0);
+	double cacheSize;
+	if (prop->QueryDoubleAttribute("CacheSize",&cacheSize)==TIXML_SUCCESS)
+		SetCacheMemoryBudget(cacheSize*1024*1024);
+	if (prop->QueryIntAttribute("SparseIndex",&help)==TIXML_SUCCESS)
+		SetSparseIndexStorage(help!=0);
+
 	if (c_filename==NULL)
 		return true;
 
@@ -243,7 +420,7 @@ bool CSPropDiscMaterial::ReadFromXML(TiXmlNode &root)
 	return true;
 }
 
-void *CSPropDiscMaterial::ReadDataSet(std::string filename, std::string d_name, int type_id, int &rank, unsigned int &size, bool debug)
+void *CSPropDiscMaterial::ReadDataSet(std::string filename, std::string d_name, int64_t type_id, int &rank, unsigned int &size, bool debug)
 {
 	herr_t status;
 	H5T_class_t class_id;
@@ -298,6 +475,8 @@ void *CSPropDiscMaterial::ReadDataSet(std::string filename, std::string d_name,
 		data = (void*) new int[size];
 	else if (type_id==H5T_NATIVE_UINT8)
 		data = (void*) new uint8[size];
+	else if (type_id==H5T_NATIVE_UINT16)
+		data = (void*) new uint16_t[size];
 	else
 	{
 		std::cerr << __func__ << ": Error, unknown data type" << std::endl;
@@ -316,6 +495,8 @@ void *CSPropDiscMaterial::ReadDataSet(std::string filename, std::string d_name,
 			delete[] (int*)data;
 		else if (type_id==H5T_NATIVE_UINT8)
 			delete[] (uint8*)data;
+		else if (type_id==H5T_NATIVE_UINT16)
+			delete[] (uint16_t*)data;
 		H5Fclose(file_id);
 		return NULL;
 	}
@@ -433,6 +614,7 @@ bool CSPropDiscMaterial::ReadHDF5( std::string filename )
 		m_Disc_Density=NULL;
 	}
 
+	H5Dclose(dataset);
 	H5Fclose(file_id);
 
 	// read mesh
@@ -452,25 +634,77 @@ bool CSPropDiscMaterial::ReadHDF5( std::string filename )
 		m_Size[n]=size;
 		numCells*=(m_Size[n]-1);
 	}
+	DetectUniformMesh();
 
-	delete[] m_Disc_Ind;
-	m_Disc_Ind = (uint8*)ReadDataSet(filename, "/DiscData", H5T_NATIVE_UINT8, rank, size, true);
+	m_Disc_Ind.Clear();
+	delete m_IndexCache;
+	m_IndexCache = NULL;
 
-	if ((m_Disc_Ind==NULL) || (rank!=3) || (size!=numCells))
+	// the lazy loaded indizies are limited to 8bit
+	bool lazy = m_LazyLoad;
+	if (lazy && (m_DB_size>256))
+	{
+		std::cerr << __func__ << ": Warning, lazy loading is not supported for more than 256 database entries, reading all indizies..." << std::endl;
+		lazy = false;
+	}
+
+	if (lazy)
+	{
+		m_IndexCache = new CSBrickCache();
+		m_IndexCache->SetMemoryBudget(m_CacheSize);
+		bool ok = m_IndexCache->Open(filename, "/DiscData");
+		for (int n=0;n<3 && ok;++n)
+			ok = (m_IndexCache->GetSize(n)==m_Size[n]-1);
+		if (ok==false)
+		{
+			std::cerr << __func__ << ": Error, can't open database indizies or size is invalid, abort..." << std::endl;
+			delete m_IndexCache;
+			m_IndexCache = NULL;
+			return false;
+		}
+		if (m_IndexCache->IsMapped())
+			cout << __func__ << ": Using memory mapped database indizies" << std::endl;
+		return true;
+	}
+
+	// read the indizies with the smallest width sufficient for the database size
+	bool wide = (m_DB_size>256);
+	void* disc_ind = ReadDataSet(filename, "/DiscData", wide ? H5T_NATIVE_UINT16 : H5T_NATIVE_UINT8, rank, size, true);
+	unsigned int ind_size[3] = {m_Size[0]-1, m_Size[1]-1, m_Size[2]-1};
+	bool ok = (disc_ind!=NULL) && (rank==3) && (size==numCells);
+	if (ok && wide)
+		ok = m_Disc_Ind.SetData((uint16_t*)disc_ind, ind_size, m_SparseIndex);
+	else if (ok)
+		ok = m_Disc_Ind.SetData((uint8_t*)disc_ind, ind_size, m_SparseIndex);
+	if (wide)
+		delete[] (uint16_t*)disc_ind;
+	else
+		delete[] (uint8*)disc_ind;
+
+	if (ok==false)
 	{
 		std::cerr << __func__ << ": Error, can't read database indizies or size/rank is invalid, abort..." << std::endl;
-		delete[] m_Disc_Ind;
-		m_Disc_Ind = NULL;
+		m_Disc_Ind.Clear();
 		return false;
 	}
+	if ((m_Disc_Ind.GetStorageType()==CSIndexVolume::SPARSE8) || (m_Disc_Ind.GetStorageType()==CSIndexVolume::SPARSE16))
+		cout << __func__ << ": Using sparse database indizies (" << m_Disc_Ind.GetMemoryUsage()/1024 << " kB)" << std::endl;
 	return true;
 }
 
+size_t CSPropDiscMaterial::GetIndexMemoryUsage() const
+{
+	if (m_IndexCache)
+		return m_IndexCache->GetMemoryUsage();
+	return m_Disc_Ind.GetMemoryUsage();
+}
+
 void CSPropDiscMaterial::ShowPropertyStatus(std::ostream& stream)
 {
 	CSProperties::ShowPropertyStatus(stream);
 	stream << " --- Discrete Material Properties --- " << std::endl;
 	stream << "  Data-Base Size:\t: " << m_DB_size << std::endl;
+	stream << "  Index Memory:\t: " << GetIndexMemoryUsage()/1024 << " kB" << std::endl;
 	stream << "  Number of Voxels:\t: " << m_Size[0] << "x" << m_Size[1] << "x" << m_Size[2] << std::endl;
 	stream << " Background Material Properties: " << std::endl;
 	stream << "  Isotropy\t: " << bIsotropy << std::endl;
@@ -524,12 +758,12 @@ vtkPolyData* CSPropDiscMaterial::CreatePolyDataModel() const
 					bu = false;
 					if (pos[n]==0)
 					{
-						if (m_Disc_Ind[mat_idx]>0)
+						if (GetDiscIndex(mat_idx)>0)
 							bd=true;
 					}
 					else if (pos[n]==m_Size[n]-2)
 					{
-						if (m_Disc_Ind[mat_idx]>0)
+						if (GetDiscIndex(mat_idx)>0)
 							bu=true;
 					}
 					else
@@ -537,9 +771,9 @@ vtkPolyData* CSPropDiscMaterial::CreatePolyDataModel() const
 						rpos[n] = pos[n]-1; // set relative pos
 						mat_idx_down  = rpos[0] + rpos[1]*(m_Size[0]-1) + rpos[2]*(m_Size[0]-1)*(m_Size[1]-1);
 						rpos[n] = pos[n]; // reset relative pos
-						if ((m_Disc_Ind[mat_idx]>0) && (m_Disc_Ind[mat_idx_down]==0))
+						if ((GetDiscIndex(mat_idx)>0) && (GetDiscIndex(mat_idx_down)==0))
 							bd=true;
-						else if (m_Disc_Ind[mat_idx]==0 && (m_Disc_Ind[mat_idx_down]>0))
+						else if (GetDiscIndex(mat_idx)==0 && (GetDiscIndex(mat_idx_down)>0))
 							bu=true;
 					}
 
@@ -19,6 +19,8 @@
 
 #include "CSProperties.h"
 #include "CSPropMaterial.h"
+#include "CSBrickCache.h"
+#include "CSIndexVolume.h"
 
 typedef unsigned char uint8;
 
@@ -45,6 +47,13 @@ public:
 
 	virtual double GetDensityWeighted(const double* coords);
 
+	virtual void GetEpsilonWeighted(int ny, const double* coords, size_t n, double* out);
+	virtual void GetMueWeighted(int ny, const double* coords, size_t n, double* out);
+	virtual void GetKappaWeighted(int ny, const double* coords, size_t n, double* out);
+	virtual void GetSigmaWeighted(int ny, const double* coords, size_t n, double* out);
+
+	virtual void GetDensityWeighted(const double* coords, size_t n, double* out);
+
 	//! Set true if database index 0 is used as background material (default), or false if CSPropMaterial should be used as index 0
 	virtual void SetUseDataBaseForBackground(bool val) {m_DB_Background=val;}
 
@@ -52,6 +61,18 @@ public:
 
 	double GetScale() {return m_Scale;}
 
+	//! Keep the database indizies on disk and load them on demand, must be set before reading the file. \sa SetCacheMemoryBudget
+	void SetLazyLoading(bool val) {m_LazyLoad=val;}
+	bool GetLazyLoading() const {return m_LazyLoad;}
+	//! Set the memory budget in bytes for database indizies loaded on demand \sa SetLazyLoading
+	void SetCacheMemoryBudget(size_t bytes) {m_CacheSize=bytes; if (m_IndexCache) m_IndexCache->SetMemoryBudget(bytes);}
+	size_t GetCacheMemoryBudget() const {return m_CacheSize;}
+	//! Allow storing the database indizies as sparse bricks, used only if less memory is needed (default), must be set before reading the file. \sa CSIndexVolume
+	void SetSparseIndexStorage(bool val) {m_SparseIndex=val;}
+	bool GetSparseIndexStorage() const {return m_SparseIndex;}
+	//! Get the memory used by the database indizies in bytes
+	size_t GetIndexMemoryUsage() const;
+
 	virtual void Init();
 
 	virtual bool Write2XML(TiXmlNode& root, bool parameterised=true, bool sparse=false);
@@ -66,13 +87,36 @@ public:
 
 protected:
 	unsigned int GetWeightingPos(const double* coords);
+	//! Get the weighting positions for n coordinates (structure of arrays), consecutive coordinates are found incrementally
+	void GetWeightingPos(const double* coords, size_t n, unsigned int* weightPos);
 	int GetDBPos(const double* coords);
+	int GetDBPosFromWeightingPos(unsigned int pos) const;
+
+	//! Transform coordinates into the (unscaled) coordinate system of the discrete material
+	void TransformToDiscCoords(const double* inCoords, double* coords) const;
+	//! Get the cell index for a coordinate in the given direction or -1 if outside. A given hint (e.g. the cell of the previous coordinate) and its neighbors are checked first.
+	int GetCellIndex(int ny, double coord, int hint=-1) const;
+	//! Check if the mesh lines are equidistant in each direction, which allows a direct index calculation
+	void DetectUniformMesh();
+	bool m_MeshUniform[3];
+	double m_MeshDelta[3];
+
+	//! Batch lookup of a discrete material value, coordinates outside of the discrete material use the weighted material value
+	void GetDiscWeighted(const float* disc, ParameterScalar* weight, int ny, double value, const double* coords, size_t n, double* out);
 
 	int m_FileType;
 	std::string m_Filename;
 	unsigned int m_Size[3];
 	unsigned int m_DB_size;
-	uint8* m_Disc_Ind;
+	//! database indizies, narrowed to 8 or 16bit and optionally stored as sparse bricks
+	CSIndexVolume m_Disc_Ind;
+	bool m_SparseIndex;
+	//! database indizies loaded on demand (lazy loading)
+	CSBrickCache* m_IndexCache;
+	bool m_LazyLoad;
+	size_t m_CacheSize;
+	bool HasDiscIndex() const {return m_Disc_Ind.IsValid() || (m_IndexCache!=NULL);}
+	unsigned int GetDiscIndex(size_t pos) const {return m_Disc_Ind.IsValid() ? m_Disc_Ind.Get(pos) : m_IndexCache->Get(pos);}
 	float *m_mesh[3];
 	float *m_Disc_epsR;
 	float *m_Disc_kappa;
@@ -83,6 +127,6 @@ protected:
 	bool m_DB_Background;
 	CSTransform* m_Transform;
 
-	void* ReadDataSet(std::string filename, std::string d_name, int type_id, int &rank, unsigned int &size, bool debug=false);
+	void* ReadDataSet(std::string filename, std::string d_name, int64_t type_id, int &rank, unsigned int &size, bool debug=false);
 };
 
@@ -78,13 +78,13 @@ const std::string CSPropExcitation::GetWeightFunction(int ny) {if ((ny>=0) && (n
 double CSPropExcitation::GetWeightedExcitation(int ny, const double* coords)
 {
 	if ((ny<0) || (ny>=3)) return 0;
-	//Warning: this is not reentrant....!!!!
-	double loc_coords[3] = {coords[0],coords[1],coords[2]};
+	// coordinate parameter (x,y,z,rho,r,a,t), passed to the weighting function without modifying the shared coordinate parameter
+	double paraVal[7] = {coords[0],coords[1],coords[2],0,0,0,0};
 	double r,rho,alpha,theta;
 	if (coordInputType==1)
 	{
-		loc_coords[0] = coords[0]*cos(coords[1]);
-		loc_coords[1] = coords[0]*sin(coords[1]);
+		paraVal[0] = coords[0]*cos(coords[1]);
+		paraVal[1] = coords[0]*sin(coords[1]);
 		rho = coords[0];
 		alpha=coords[1];
 		r = sqrt(pow(coords[0],2)+pow(coords[2],2));
@@ -97,20 +97,18 @@ double CSPropExcitation::GetWeightedExcitation(int ny, const double* coords)
 		r = sqrt(pow(coords[0],2)+pow(coords[1],2)+pow(coords[2],2));
 		theta=asin(1)-atan(coords[2]/rho);
 	}
-	coordPara[0]->SetValue(loc_coords[0]);
-	coordPara[1]->SetValue(loc_coords[1]);
-	coordPara[2]->SetValue(loc_coords[2]);
-	coordPara[3]->SetValue(rho); //rho
-	coordPara[4]->SetValue(r); //r
-	coordPara[5]->SetValue(alpha);
-	coordPara[6]->SetValue(theta); //theta
-	int EC = WeightFct[ny].Evaluate();
+	paraVal[3] = rho;
+	paraVal[4] = r;
+	paraVal[5] = alpha;
+	paraVal[6] = theta;
+	int EC = 0;
+	double weight = WeightFct[ny].GetEvaluated(paraVal,EC);
 	if (EC)
 	{
 		std::cerr << "CSPropExcitation::GetWeightedExcitation: Error evaluating the weighting function (ID: " << this->GetID() << ", n=" << ny << "): " << PSErrorCode2Msg(EC) << std::endl;
 	}
 
-	return WeightFct[ny].GetValue()*GetExcitation(ny);
+	return weight*GetExcitation(ny);
 }
 
 void CSPropExcitation::SetDelay(double val)	{Delay.SetValue(val);}
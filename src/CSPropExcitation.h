@@ -74,6 +74,7 @@ public:
 	//! Get the weighting function for the given excitation component
 	const std::string GetWeightFunction(int ny);
 
+	//! Get the excitation for the given component, weighted by the weighting function at the given coordinate. This method is reentrant.
 	double GetWeightedExcitation(int ny, const double* coords);
 
 	//! Set the propagation direction for a given component
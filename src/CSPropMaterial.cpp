@@ -92,6 +92,94 @@ double CSPropMaterial::GetWeight(ParameterScalar &ps, const double* coords)
 	return value;
 }
 
+void CSPropMaterial::GetWeight(ParameterScalar *ps, int ny, const double* coords, size_t n, double* out, double scale)
+{
+	if (bIsotropy) ny=0;
+	if ((ny>2) || (ny<0))
+	{
+		for (size_t i=0;i<n;++i)
+			out[i]=0;
+		return;
+	}
+	GetWeight(ps[ny],coords,n,out,scale);
+}
+
+// number of coordinates processed as one block by the batch weighting
+#define WEIGHT_BLOCK_SIZE 64
+
+void CSPropMaterial::GetWeight(ParameterScalar &ps, const double* coords, size_t n, double* out, double scale)
+{
+	// a constant weight does not need any coordinate parameter
+	bool constWeight = (ps.GetMode()==false);
+	if (constWeight==false)
+	{
+		char *pEnd;
+		strtod(ps.GetString().c_str(),&pEnd);
+		constWeight = (*pEnd==0);
+	}
+	if (constWeight)
+	{
+		double value = ps.GetValue()*scale;
+		for (size_t i=0;i<n;++i)
+			out[i]=value;
+		return;
+	}
+
+	const double* c0 = coords;
+	const double* c1 = coords+n;
+	const double* c2 = coords+2*n;
+	// coordinate parameter (x,y,z,rho,r,a,t) for a block of coordinates
+	double para[7*WEIGHT_BLOCK_SIZE];
+	int EC=0;
+	int lastEC=0;
+	for (size_t start=0;start<n;start+=WEIGHT_BLOCK_SIZE)
+	{
+		size_t count = std::min((size_t)WEIGHT_BLOCK_SIZE,n-start);
+		if (coordInputType==1)
+		{
+			for (size_t i=0;i<count;++i)
+			{
+				double rho = c0[start+i];
+				double alpha = c1[start+i];
+				double z = c2[start+i];
+				double* p = &para[7*i];
+				p[0] = rho*cos(alpha);
+				p[1] = rho*sin(alpha);
+				p[2] = z;
+				p[3] = rho;
+				p[4] = sqrt(rho*rho+z*z);
+				p[5] = alpha;
+				p[6] = asin(1)-atan(z/rho);
+			}
+		}
+		else
+		{
+			for (size_t i=0;i<count;++i)
+			{
+				double x = c0[start+i];
+				double y = c1[start+i];
+				double z = c2[start+i];
+				double* p = &para[7*i];
+				p[0] = x;
+				p[1] = y;
+				p[2] = z;
+				p[3] = sqrt(x*x+y*y);
+				p[4] = sqrt(x*x+y*y+z*z);
+				p[5] = atan2(y,x);
+				p[6] = asin(1)-atan(z/p[3]);
+			}
+		}
+		EC=0;
+		ps.GetEvaluated(para,count,7,&out[start],EC);
+		if (EC)
+			lastEC = EC;
+		for (size_t i=0;i<count;++i)
+			out[start+i] *= scale;
+	}
+	if (lastEC)
+		std::cerr << "CSPropMaterial::GetWeight: Error evaluating the weighting function (ID: " << this->GetID() << "): " << PSErrorCode2Msg(lastEC) << std::endl;
+}
+
 void CSPropMaterial::Init()
 {
 	bIsotropy = true;
@@ -44,6 +44,8 @@ public:
 	int SetEpsilonWeightFunction(const std::string fct, int ny)	{return SetValue(fct,WeightEpsilon,ny);}
 	const std::string GetEpsilonWeightFunction(int ny)			{return GetTerm(WeightEpsilon,ny);}
 	virtual double GetEpsilonWeighted(int ny, const double* coords)	{return GetWeight(WeightEpsilon,ny,coords)*GetEpsilon(ny);}
+	//! Get the weighted epsilon for n coordinates, given as structure of arrays (n x-values, followed by n y- and n z-values). \sa GetWeight
+	virtual void GetEpsilonWeighted(int ny, const double* coords, size_t n, double* out)	{GetWeight(WeightEpsilon,ny,coords,n,out,GetEpsilon(ny));}
 
 	void SetMue(double val, int ny=0)			{SetValue(val,Mue,ny);}
 	int SetMue(const std::string val, int ny=0)		{return SetValue(val,Mue,ny);}
@@ -53,6 +55,8 @@ public:
 	int SetMueWeightFunction(const std::string fct, int ny)	{return SetValue(fct,WeightMue,ny);}
 	const std::string GetMueWeightFunction(int ny)			{return GetTerm(WeightMue,ny);}
 	virtual double GetMueWeighted(int ny, const double* coords)	{return GetWeight(WeightMue,ny,coords)*GetMue(ny);}
+	//! Get the weighted mue for n coordinates, given as structure of arrays (n x-values, followed by n y- and n z-values). \sa GetWeight
+	virtual void GetMueWeighted(int ny, const double* coords, size_t n, double* out)	{GetWeight(WeightMue,ny,coords,n,out,GetMue(ny));}
 
 	void SetKappa(double val, int ny=0)			{SetValue(val,Kappa,ny);}
 	int SetKappa(const std::string val, int ny=0)	{return SetValue(val,Kappa,ny);}
@@ -62,6 +66,8 @@ public:
 	int SetKappaWeightFunction(const std::string fct, int ny)	{return SetValue(fct,WeightKappa,ny);}
 	const std::string GetKappaWeightFunction(int ny)				{return GetTerm(WeightKappa,ny);}
 	virtual double GetKappaWeighted(int ny, const double* coords)	{return GetWeight(WeightKappa,ny,coords)*GetKappa(ny);}
+	//! Get the weighted kappa for n coordinates, given as structure of arrays (n x-values, followed by n y- and n z-values). \sa GetWeight
+	virtual void GetKappaWeighted(int ny, const double* coords, size_t n, double* out)	{GetWeight(WeightKappa,ny,coords,n,out,GetKappa(ny));}
 
 	void SetSigma(double val, int ny=0)			{SetValue(val,Sigma,ny);}
 	int SetSigma(const std::string val, int ny=0)	{return SetValue(val,Sigma,ny);}
@@ -71,6 +77,8 @@ public:
 	int SetSigmaWeightFunction(const std::string fct, int ny)	{return SetValue(fct,WeightSigma,ny);}
 	const std::string GetSigmaWeightFunction(int ny)				{return GetTerm(WeightSigma,ny);}
 	virtual double GetSigmaWeighted(int ny, const double* coords)	{return GetWeight(WeightSigma,ny,coords)*GetSigma(ny);}
+	//! Get the weighted sigma for n coordinates, given as structure of arrays (n x-values, followed by n y- and n z-values). \sa GetWeight
+	virtual void GetSigmaWeighted(int ny, const double* coords, size_t n, double* out)	{GetWeight(WeightSigma,ny,coords,n,out,GetSigma(ny));}
 
 	void SetDensity(double val)			{Density.SetValue(val);}
 	int SetDensity(const std::string val)	{return Density.SetValue(val);}
@@ -80,6 +88,8 @@ public:
 	int SetDensityWeightFunction(const std::string fct) {return WeightDensity.SetValue(fct);}
 	const std::string GetDensityWeightFunction() {return WeightDensity.GetString();}
 	virtual double GetDensityWeighted(const double* coords)	{return GetWeight(WeightDensity,coords)*GetDensity();}
+	//! Get the weighted density for n coordinates, given as structure of arrays (n x-values, followed by n y- and n z-values). \sa GetWeight
+	virtual void GetDensityWeighted(const double* coords, size_t n, double* out)	{GetWeight(WeightDensity,coords,n,out,GetDensity());}
 
 	void SetIsotropy(bool val) {bIsotropy=val;}
 	bool GetIsotropy() {return bIsotropy;}
@@ -107,5 +117,8 @@ protected:
 
 	double GetWeight(ParameterScalar &ps, const double* coords);
 	double GetWeight(ParameterScalar *ps, int ny, const double* coords);
+	//! Evaluate a weighting function for n coordinates (structure of arrays) and multiply it with the given scale
+	void GetWeight(ParameterScalar &ps, const double* coords, size_t n, double* out, double scale=1.0);
+	void GetWeight(ParameterScalar *ps, int ny, const double* coords, size_t n, double* out, double scale=1.0);
 	bool bIsotropy;
 };
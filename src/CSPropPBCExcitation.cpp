@@ -100,13 +100,13 @@ const std::string CSPropPBCExcitation::GetWeightFunction(int ny, bool type)
 double CSPropPBCExcitation::GetWeightedExcitation(int ny, const double* coords, bool type) // type = 1 -> Sin(t), type = 0 -> Cos(t)
 {
     if ((ny<0) || (ny>=3)) return 0;
-    //Warning: this is not reentrant....!!!!
-    double loc_coords[3] = {coords[0],coords[1],coords[2]};
+    // coordinate parameter (x,y,z,rho,r,a,t), passed to the weighting function without modifying the shared coordinate parameter
+    double paraVal[7] = {coords[0],coords[1],coords[2],0,0,0,0};
     double r,rho,alpha,theta;
     if (coordInputType==1)
     {
-        loc_coords[0] = coords[0]*cos(coords[1]);
-        loc_coords[1] = coords[0]*sin(coords[1]);
+        paraVal[0] = coords[0]*cos(coords[1]);
+        paraVal[1] = coords[0]*sin(coords[1]);
         rho = coords[0];
         alpha=coords[1];
         r = sqrt(pow(coords[0],2)+pow(coords[2],2));
@@ -119,28 +119,21 @@ double CSPropPBCExcitation::GetWeightedExcitation(int ny, const double* coords,
         r = sqrt(pow(coords[0],2)+pow(coords[1],2)+pow(coords[2],2));
         theta=asin(1)-atan(coords[2]/rho);
     }
-    coordPara[0]->SetValue(loc_coords[0]);
-    coordPara[1]->SetValue(loc_coords[1]);
-    coordPara[2]->SetValue(loc_coords[2]);
-    coordPara[3]->SetValue(rho); //rho
-    coordPara[4]->SetValue(r); //r
-    coordPara[5]->SetValue(alpha);
-    coordPara[6]->SetValue(theta); //theta
-    int EC;
+    paraVal[3] = rho;
+    paraVal[4] = r;
+    paraVal[5] = alpha;
+    paraVal[6] = theta;
+    int EC = 0;
+    double weight;
     if(type)
-        EC = SINWeightFct[ny].Evaluate();
-    if(!type)
-        EC = COSWeightFct[ny].Evaluate();
+        weight = SINWeightFct[ny].GetEvaluated(paraVal,EC);
+    else
+        weight = COSWeightFct[ny].GetEvaluated(paraVal,EC);
     if (EC)
     {
         std::cerr << "CSPropPBCExcitation::GetWeightedExcitation: Error evaluating the weighting function (ID: " << this->GetID() << ", n=" << ny << "): " << PSErrorCode2Msg(EC) << std::endl;
     }
-    if(type){
-        return SINWeightFct[ny].GetValue()*GetExcitation(ny, type);
-    }
-    if(!type){
-        return COSWeightFct[ny].GetValue()*GetExcitation(ny, type);
-    }
+    return weight*GetExcitation(ny, type);
 }
 
 void CSPropPBCExcitation::SetDelay(double val)	{Delay.SetValue(val);}
@@ -37,6 +37,8 @@
 #include "tinyxml.h"
 
 /*********************CSProperties********************************************************************/
+unsigned long CSProperties::s_NameCounter = 0;
+
 CSProperties::CSProperties(CSProperties* prop)
 {
 	uiID=prop->uiID;
@@ -47,10 +49,13 @@ CSProperties::CSProperties(CSProperties* prop)
 	EdgeColor=prop->EdgeColor;
 	bVisisble=prop->bVisisble;
 	sName=std::string(prop->sName);
+	++s_NameCounter;
+	m_Modified=true;
 	for (size_t i=0;i<prop->vPrimitives.size();++i)
 	{
 		vPrimitives.push_back(prop->vPrimitives.at(i));
 	}
+	RebuildPrimitiveIndex();
 	InitCoordParameter();
 }
 
@@ -69,6 +74,8 @@ CSProperties::CSProperties(ParameterSet* paraSet)
 	FillColor.a=EdgeColor.a=255;
 	bVisisble=true;
 	Type=ANY;
+	m_Modified=true;
+	m_PrimitiveIDsValid=true;
 	InitCoordParameter();
 }
 
@@ -87,6 +94,8 @@ CSProperties::CSProperties(unsigned int ID, ParameterSet* paraSet)
 	FillColor.a=EdgeColor.a=255;
 	bVisisble=true;
 	Type=ANY;
+	m_Modified=true;
+	m_PrimitiveIDsValid=true;
 	InitCoordParameter();
 }
 
@@ -102,6 +111,7 @@ CSProperties::~CSProperties()
 void CSProperties::SetCoordInputType(CoordinateSystem type, bool CopyToPrimitives)
 {
 	coordInputType = type;
+	m_Modified=true;
 	if (CopyToPrimitives==false)
 		return;
 	for (size_t i=0;i<vPrimitives.size();++i)
@@ -132,7 +142,7 @@ void CSProperties::SetID(unsigned int ID) {uiID=ID;}
 unsigned int CSProperties::GetUniqueID() {return UniqueID;}
 void CSProperties::SetUniqueID(unsigned int uID) {UniqueID=uID;}
 
-void CSProperties::SetName(const std::string name) {sName=std::string(name);}
+void CSProperties::SetName(const std::string name) {sName=std::string(name);++s_NameCounter;}
 const std::string CSProperties::GetName() {return sName;}
 
 bool CSProperties::ExistAttribute(std::string name)
@@ -238,7 +248,23 @@ bool CSProperties::Write2XML(TiXmlNode& root, bool parameterised, bool sparse)
 
 void CSProperties::AddPrimitive(CSPrimitives *prim)
 {
-	if (HasPrimitive(prim)==true)
+	if (m_PrimitiveIDsValid)
+	{
+		// the insertion into the ID lookup is also the check for duplicates
+		std::pair<std::map<unsigned int, CSPrimitives*>::iterator,bool> ins = m_PrimitiveIDs.insert(std::make_pair(prim->GetID(),prim));
+		if ((ins.second==false) && (ins.first->second!=prim))
+		{
+			// IDs are not unique, fall back to a linear search
+			m_PrimitiveIDsValid=false;
+			m_PrimitiveIDs.clear();
+		}
+		else if (ins.second==false)
+		{
+			std::cerr << __func__ << ": Error, primitive is already owned by this property!" << std::endl;
+			return;
+		}
+	}
+	if ((m_PrimitiveIDsValid==false) && (HasPrimitive(prim)==true))
 	{
 		std::cerr << __func__ << ": Error, primitive is already owned by this property!" << std::endl;
 		return;
@@ -251,20 +277,68 @@ bool CSProperties::HasPrimitive(CSPrimitives *prim)
 {
 	if (prim==NULL)
 		return false;
-	for (size_t i=0; i<vPrimitives.size();++i)
-		if (vPrimitives.at(i)==prim)
+	if (m_PrimitiveIDsValid)
+	{
+		std::map<unsigned int, CSPrimitives*>::const_iterator it = m_PrimitiveIDs.find(prim->GetID());
+		return (it!=m_PrimitiveIDs.end()) && (it->second==prim);
+	}
+	for (size_t i=vPrimitives.size(); i>0;--i)
+		if (vPrimitives.at(i-1)==prim)
 			return true;
 	return false;
 }
 
-void CSProperties::RemovePrimitive(CSPrimitives *prim)
+CSPrimitives* CSProperties::GetPrimitiveByID(unsigned int ID)
+{
+	if (m_PrimitiveIDsValid)
+	{
+		std::map<unsigned int, CSPrimitives*>::const_iterator it = m_PrimitiveIDs.find(ID);
+		if (it==m_PrimitiveIDs.end())
+			return NULL;
+		return it->second;
+	}
+	for (size_t i=0; i<vPrimitives.size();++i)
+		if (vPrimitives.at(i)->GetID()==ID)
+			return vPrimitives.at(i);
+	return NULL;
+}
+
+void CSProperties::RebuildPrimitiveIndex()
 {
+	m_PrimitiveIDs.clear();
+	m_PrimitiveIDsValid=true;
 	for (size_t i=0; i<vPrimitives.size();++i)
 	{
-		if (vPrimitives.at(i)==prim)
+		if (m_PrimitiveIDs.insert(std::make_pair(vPrimitives.at(i)->GetID(),vPrimitives.at(i))).second==false)
+		{
+			m_PrimitiveIDsValid=false;
+			m_PrimitiveIDs.clear();
+			return;
+		}
+	}
+}
+
+void CSProperties::RemovePrimitiveID(CSPrimitives *prim)
+{
+	if (m_PrimitiveIDsValid==false)
+		return;
+	std::map<unsigned int, CSPrimitives*>::iterator it = m_PrimitiveIDs.find(prim->GetID());
+	if ((it!=m_PrimitiveIDs.end()) && (it->second==prim))
+		m_PrimitiveIDs.erase(it);
+}
+
+void CSProperties::RemovePrimitive(CSPrimitives *prim)
+{
+	if (m_PrimitiveIDsValid && !HasPrimitive(prim))
+		return;
+	// search backwards, the last added primitives are removed first, e.g. by the destructor
+	for (size_t i=vPrimitives.size(); i>0;--i)
+	{
+		if (vPrimitives.at(i-1)==prim)
 		{
-			std::vector<CSPrimitives*>::iterator iter=vPrimitives.begin()+i;
+			std::vector<CSPrimitives*>::iterator iter=vPrimitives.begin()+(i-1);
 			vPrimitives.erase(iter);
+			RemovePrimitiveID(prim);
 			prim->SetProperty(NULL);
 			return;
 		}
@@ -288,6 +362,7 @@ CSPrimitives* CSProperties::TakePrimitive(size_t index)
 	CSPrimitives* prim=vPrimitives.at(index);
 	std::vector<CSPrimitives*>::iterator iter=vPrimitives.begin()+index;
 	vPrimitives.erase(iter);
+	RemovePrimitiveID(prim);
 	return prim;
 }
 
@@ -361,6 +436,7 @@ bool CSProperties::ReadFromXML(TiXmlNode &root)
 	const char* cHelp=prop->Attribute("Name");
 	if (cHelp!=NULL) sName=std::string(cHelp);
 	else sName.clear();
+	++s_NameCounter;
 
 	TiXmlElement* FC = root.FirstChildElement("FillColor");
 	if (FC!=NULL)
@@ -27,6 +27,7 @@
 #include <stdlib.h>
 #include <string>
 #include <vector>
+#include <map>
 #include "ParameterObjects.h"
 #include "CSTransform.h"
 #include "CSXCAD_Global.h"
@@ -108,6 +109,8 @@ public:
 	void SetName(const std::string name);
 	//! Get Name for this Property. \sa SetName
 	const std::string GetName();
+	//! Get a counter increased by every name change of any property. \sa ContinuousStructure::GetPropertiesByName
+	static unsigned long GetNameCounter() {return s_NameCounter;}
 
 	//! Check if given attribute exists
 	bool ExistAttribute(std::string name);
@@ -120,6 +123,10 @@ public:
 	void AddPrimitive(CSPrimitives *prim);
 	//! Check if primitive is owned by this Propertie. \sa CSPrimitives, AddPrimitive, RemovePrimitive, TakePrimitive
 	bool HasPrimitive(CSPrimitives *prim);
+	//! Get the primitive with the given unique ID owned by this property. \return NULL if not found! \sa CSPrimitives::GetID
+	CSPrimitives* GetPrimitiveByID(unsigned int ID);
+	//! Rebuild the lookup of all primitives by their ID, done by CSPrimitives::SetID.
+	void RebuildPrimitiveIndex();
 	//! Removes a primitive of this Property. Caller must take ownership! \sa CSPrimitives, AddPrimitive, TakePrimitive
 	void RemovePrimitive(CSPrimitives *prim);
 	//! Removes and deletes a primitive of this Property. \sa CSPrimitives, RemovePrimitive, AddPrimitive, TakePrimitive
@@ -184,6 +191,15 @@ public:
 	//! Update all parameters. Nothing to do in this base class. \param ErrStr Methode writes error messages to this string! \return Update success
 	virtual bool Update(std::string *ErrStr=NULL);
 
+	//! Mark this property as modified by a change not tracked by its parameter scalars. \sa ContinuousStructure::Update
+	void SetModified(bool val=true) {m_Modified=val;}
+	//! Check if this property was modified since the last update by ContinuousStructure::Update
+	bool GetModified() const {return m_Modified;}
+	//! Set the parameters used during the last update of this property (recorded by ContinuousStructure::Update)
+	void SetParameterDependencies(const std::vector<Parameter*> &deps) {m_ParaDependencies=deps;}
+	//! Get the parameters used during the last update of this property
+	const std::vector<Parameter*>& GetParameterDependencies() const {return m_ParaDependencies;}
+
 	//! Write this property to a xml-node. \param parameterised Use false if parameters should be written as values. Parameters are lost!
 	virtual bool Write2XML(TiXmlNode& root, bool parameterised=true, bool sparse=false);
 	//! Read property from xml-node. \return Successful read-operation. 
@@ -220,7 +236,17 @@ protected:
 
 	bool bVisisble;
 
+	//! modified since the last update by ContinuousStructure::Update, parameters used during the last update
+	bool m_Modified;
+	std::vector<Parameter*> m_ParaDependencies;
+
 	std::vector<CSPrimitives*> vPrimitives;
+	//! all primitives by their ID for fast lookups, only used if the IDs are unique
+	std::map<unsigned int, CSPrimitives*> m_PrimitiveIDs;
+	bool m_PrimitiveIDsValid;
+	void RemovePrimitiveID(CSPrimitives *prim);
+
+	static unsigned long s_NameCounter;
 
 	//! List of additional attribute names
 	std::vector<std::string> m_Attribute_Name;
@@ -21,7 +21,9 @@
 #include "CSFunctionParser.h"
 #include <stdio.h>
 #include <stdlib.h>
+#include <math.h>
 #include <iostream>
+#include <queue>
 
 CSRectGrid::CSRectGrid(void)
 {
@@ -46,15 +48,53 @@ CSRectGrid* CSRectGrid::Clone(CSRectGrid* original)
 
 void CSRectGrid::AddDiscLine(int direct, double val)
 {
-	if ((direct>=0)&&(direct<3)) Lines[direct].push_back(val);
+	if ((direct<0) || (direct>=3)) return;
+	if (!isfinite(val)) return;
+	std::vector<double>::iterator pos = std::lower_bound(Lines[direct].begin(),Lines[direct].end(),val);
+	if ((pos==Lines[direct].end()) || (*pos!=val))
+		Lines[direct].insert(pos,val);
 }
 
 void CSRectGrid::AddDiscLines(int direct, int numLines, double* vals)
 {
-	for (int n=0;n<numLines;++n)
+	if (numLines>0)
+		MergeLines(direct,vals,numLines);
+}
+
+size_t CSRectGrid::MergeLines(int direct, const double* vals, size_t numLines, double tol)
+{
+	if ((direct<0) || (direct>=3)) return 0;
+	std::vector<double> add;
+	add.reserve(numLines);
+	for (size_t n=0;n<numLines;++n)
+		if (isfinite(vals[n]))
+			add.push_back(vals[n]);
+	std::sort(add.begin(),add.end());
+
+	// merge both sorted lists, new lines too close to the last kept line or the next existing line are dropped
+	const std::vector<double> &old = Lines[direct];
+	std::vector<double> lines;
+	lines.reserve(old.size()+add.size());
+	size_t o=0, a=0, added=0;
+	while ((o<old.size()) || (a<add.size()))
 	{
-		AddDiscLine(direct,vals[n]);
+		if ((a>=add.size()) || ((o<old.size()) && (old[o]<=add[a])))
+		{
+			if (lines.empty() || (old[o]!=lines.back()))
+				lines.push_back(old[o]);
+			++o;
+			continue;
+		}
+		double val = add[a++];
+		if (!lines.empty() && (val-lines.back()<=tol))
+			continue;
+		if ((o<old.size()) && (old[o]-val<=tol))
+			continue;
+		lines.push_back(val);
+		++added;
 	}
+	Lines[direct].swap(lines);
+	return added;
 }
 
 std::string CSRectGrid::AddDiscLines(int direct, int numLines, double* vals, std::string DistFunction)
@@ -62,6 +102,7 @@ std::string CSRectGrid::AddDiscLines(int direct, int numLines, double* vals, std
 	if ((direct<0)||(direct>=3)) return std::string("Unknown grid direction!");
 	if (DistFunction.empty()==false)
 	{
+		std::vector<double> values;
 		CSFunctionParser fParse;
 		std::string dirVar;
 		switch (direct)
@@ -86,8 +127,10 @@ std::string CSRectGrid::AddDiscLines(int direct, int numLines, double* vals, std
 		{
 			dValue=fParse.Eval(&vals[n]);
 			if (fParse.EvalError()!=0) error=true;
-			AddDiscLine(direct,dValue);
+			values.push_back(dValue);
 		}
+		if (values.size()>0)
+			MergeLines(direct,&values[0],values.size());
 		if (error) return std::string("An error occured evaluation the grid function f(") + dirVar + std::string(")!");
 	}
 	return "";
@@ -104,12 +147,9 @@ bool CSRectGrid::RemoveDiscLine(int direct, int index)
 
 bool CSRectGrid::RemoveDiscLine(int direct, double val)
 {
-	if ((direct<0) || (direct>=3)) return false;
-	for (size_t i=0;i<Lines[direct].size();++i)
-	{
-		if (Lines[direct].at(i)==val) return RemoveDiscLine(direct,(int)i);
-	}
-	return false;
+	int index = GetLineIndex(direct,val);
+	if (index<0) return false;
+	return RemoveDiscLine(direct,index);
 }
 
 void CSRectGrid::clear()
@@ -130,7 +170,8 @@ bool CSRectGrid::SetLine(int direct, size_t Index, double value)
 {
 	if ((direct<0) || (direct>=3)) return false;
 	if (Lines[direct].size()<=Index) return false;
-	Lines[direct].at(Index) = value;
+	Lines[direct].erase(Lines[direct].begin()+Index);
+	AddDiscLine(direct,value);
 	return true;
 }
 
@@ -141,10 +182,9 @@ double CSRectGrid::GetLine(int direct, size_t Index)
 	return Lines[direct].at(Index);
 }
 
-double* CSRectGrid::GetLines(int direct, double *array, unsigned int &qty, bool sorted)
+double* CSRectGrid::GetLines(int direct, double *array, unsigned int &qty, bool /*sorted*/)
 {
 	if ((direct<0) || (direct>=3)) return 0;
-	if (sorted) Sort(direct);
 	delete[] array;
 	array = new double[Lines[direct].size()];
 	for (size_t i=0;i<Lines[direct].size();++i) array[i]=Lines[direct].at(i);
@@ -152,6 +192,19 @@ double* CSRectGrid::GetLines(int direct, double *array, unsigned int &qty, bool
 	return array;
 }
 
+int CSRectGrid::GetLineIndex(int direct, double val, double tol) const
+{
+	if ((direct<0) || (direct>=3)) return -1;
+	const std::vector<double> &lines = Lines[direct];
+	std::vector<double>::const_iterator pos = std::lower_bound(lines.begin(),lines.end(),val-tol);
+	if ((pos==lines.end()) || (*pos>val+tol))
+		return -1;
+	// the nearest line within the tolerance
+	if ((pos+1!=lines.end()) && (*(pos+1)<=val+tol) && (fabs(*(pos+1)-val)<fabs(*pos-val)))
+		++pos;
+	return (int)(pos-lines.begin());
+}
+
 std::string CSRectGrid::GetLinesAsString(int direct)
 {
 	std::stringstream xStr;
@@ -167,6 +220,18 @@ std::string CSRectGrid::GetLinesAsString(int direct)
 	return xStr.str();
 }
 
+//! Snap a value inside the sorted lines, given the index of the first line larger than the value
+static inline unsigned int SnapToUpper(const std::vector<double> &lines, double value, size_t upper)
+{
+	if (upper>=lines.size())
+		return lines.size()-1;
+	if (upper==0)
+		return 0;
+	if (value < 0.5*(lines[upper-1]+lines[upper]))
+		return upper-1;
+	return upper;
+}
+
 unsigned int CSRectGrid::Snap2LineNumber(int ny, double value, bool &inside) const
 {
 	inside = false;
@@ -174,17 +239,54 @@ unsigned int CSRectGrid::Snap2LineNumber(int ny, double value, bool &inside) con
 		return -1;
 	if (Lines[ny].size()==0)
 		return -1;
-	if (value<Lines[ny].at(0))
+	if (value<Lines[ny].front())
 		return 0;
-	if (value>Lines[ny].at(Lines[ny].size()-1))
+	if (!(value<=Lines[ny].back())) // also true for NaN
 		return Lines[ny].size()-1;
 	inside = true;
-	for (size_t n=0;n<Lines[ny].size()-1;++n)
+	size_t upper = std::upper_bound(Lines[ny].begin(),Lines[ny].end(),value) - Lines[ny].begin();
+	return SnapToUpper(Lines[ny], value, upper);
+}
+
+bool CSRectGrid::Snap2LineNumbers(int ny, const double* vals, size_t n, unsigned int* out, bool* inside) const
+{
+	if ((ny<0) || (ny>2))
+		return false;
+	const std::vector<double> &lines = Lines[ny];
+	if (lines.size()==0)
+		return false;
+	std::vector<double>::const_iterator upper = lines.begin();
+	double last = lines.front();
+	for (size_t i=0;i<n;++i)
 	{
-		if (value < 0.5*(Lines[ny].at(n)+Lines[ny].at(n+1)) )
-			return n;
+		double value = vals[i];
+		bool in = (value>=lines.front()) && (value<=lines.back());
+		if (inside)
+			inside[i] = in;
+		if (!in) // outside or NaN
+		{
+			out[i] = (value<lines.front()) ? 0 : lines.size()-1;
+			continue;
+		}
+		if (value<last)
+			upper = lines.begin();
+		last = value;
+		// gallop forward from the last position, then search the found range
+		size_t step = 1;
+		std::vector<double>::const_iterator stop = upper;
+		while ((stop!=lines.end()) && (*stop<=value))
+		{
+			upper = stop+1;
+			if ((size_t)(lines.end()-upper)<=step)
+				stop = lines.end();
+			else
+				stop = upper+step;
+			step *= 2;
+		}
+		upper = std::upper_bound(upper,stop,value);
+		out[i] = SnapToUpper(lines, value, upper-lines.begin());
 	}
-	return Lines[ny].size()-1;
+	return true;
 }
 
 int CSRectGrid::GetDimension()
@@ -204,23 +306,393 @@ void CSRectGrid::IncreaseResolution(int nu, int factor)
 	if ((nu<0) || (nu>=GetDimension())) return;
 	if ((factor<=1) && (factor>9)) return;
 	size_t size=Lines[nu].size();
+	std::vector<double> lines;
+	if (factor>1)
+		lines.reserve((size-1)*factor+1);
 	for (size_t i=0;i<size-1;++i)
 	{
 		double delta=(Lines[nu].at(i+1)-Lines[nu].at(i))/factor;
+		lines.push_back(Lines[nu].at(i));
 		for (int n=1;n<factor;++n)
 		{
-			AddDiscLine(nu,Lines[nu].at(i)+n*delta);
+			lines.push_back(Lines[nu].at(i)+n*delta);
 		}
 	}
-	Sort(nu);
+	lines.push_back(Lines[nu].back());
+	Lines[nu].swap(lines);
+}
+
+//! Sort the lines and remove lines closer than tol times the mean distance to the next line
+static void UniqueLines(std::vector<double> &lines, double tol=1e-7)
+{
+	std::sort(lines.begin(),lines.end());
+	lines.erase(std::unique(lines.begin(),lines.end()),lines.end());
+	if (lines.size()<2)
+		return;
+	double min_dist = (lines.back()-lines.front())/(lines.size()-1)*tol;
+	std::vector<double> out;
+	out.reserve(lines.size());
+	for (size_t n=0;n<lines.size()-1;++n)
+		if (lines.at(n+1)-lines.at(n)>=min_dist)
+			out.push_back(lines.at(n));
+	out.push_back(lines.back());
+	lines.swap(out);
 }
 
+//! Check the sorted lines for a symmetry. \return 0 if not symmetric, 1 if symmetric with a center line, 2 if symmetric without a center line
+static int CheckLineSymmetry(const std::vector<double> &lines)
+{
+	const double tolerance = 1e-10;
+	size_t NP = lines.size();
+	if (NP<=2)
+		return 0;
+	double range = lines.back()-lines.front();
+	double center = 0.5*(lines.back()+lines.front());
+	for (size_t n=0;n<NP/2;++n)
+		if (fabs((center-lines.at(n))-(lines.at(NP-n-1)-center)) > range*tolerance)
+			return 0;
+	if ((NP%2==1) && (fabs(lines.at(NP/2)-center) > range*tolerance))
+		return 0;
+	return (NP%2==0) ? 2 : 1;
+}
+
+//! Grow the resolution from start_res with the given ratio up to max_res, starting at zero and ending at rng
+static std::vector<double> OneSideTaper(double rng, double start_res, double max_res, double ratio)
+{
+	std::vector<double> l(1,0.0);
+	double res = start_res;
+	double pos = 0;
+	int N = 0;
+	while ((res<max_res) && (pos<rng))
+	{
+		res = std::min(res*ratio, max_res);
+		pos += res;
+		l.push_back(pos);
+		++N;
+	}
+	if (pos>rng)
+	{
+		// the range is too short for max_res
+		for (size_t n=0;n<l.size();++n)
+			l.at(n) *= rng/pos;
+		return l;
+	}
+
+	// adjusted ratio to end at max_res
+	double _ratio = exp((log(max_res)-log(start_res))/N);
+	l.assign(1,0.0);
+	pos = 0;
+	res = start_res;
+	for (int n=0;n<N;++n)
+	{
+		res *= _ratio;
+		pos += res;
+		l.push_back(pos);
+	}
+	while (pos<rng)
+	{
+		pos += max_res;
+		l.push_back(pos);
+	}
+	double scale = rng/pos;
+	for (size_t n=0;n<l.size();++n)
+		l.at(n) *= scale;
+	return l;
+}
+
+//! Get the number of steps and the adjusted ratio to grow from res to max_res
+static double TaperSteps(double start_res, double max_res, double ratio, int &N)
+{
+	N = 0;
+	double res = start_res;
+	while (res<max_res)
+	{
+		res *= ratio;
+		++N;
+	}
+	return exp((log(max_res)-log(start_res))/N);
+}
+
+//! Fill the range [start,stop] with lines, starting with start_res and ending with stop_res, a max. resolution of max_res and a max. ratio of neighboring cells
+static std::vector<double> SmoothRange(double start, double stop, double start_res, double stop_res, double max_res, double ratio)
+{
+	std::vector<double> lines;
+	double rng = stop-start;
+
+	// very small range
+	if ((rng<max_res) && (rng<start_res*ratio) && (rng<stop_res*ratio))
+	{
+		lines.push_back(start);
+		lines.push_back(stop);
+		UniqueLines(lines);
+		return lines;
+	}
+
+	// very large range and easy start/stop res
+	if ((start_res>=(max_res/ratio)) && (stop_res>=(max_res/ratio)))
+	{
+		int N = (int)ceil(rng/max_res);
+		for (int n=0;n<=N;++n)
+			lines.push_back(start + rng*n/N);
+		return lines;
+	}
+
+	// need to taper start
+	if ((start_res<(max_res/ratio)) && (stop_res>=(max_res/ratio)))
+	{
+		lines = OneSideTaper(rng, start_res, max_res, ratio);
+		for (size_t n=0;n<lines.size();++n)
+			lines.at(n) += start;
+		return lines;
+	}
+
+	// need to taper stop
+	if ((start_res>=(max_res/ratio)) && (stop_res<(max_res/ratio)))
+	{
+		lines = OneSideTaper(rng, stop_res, max_res, ratio);
+		for (size_t n=0;n<lines.size();++n)
+			lines.at(n) = stop - lines.at(n);
+		std::sort(lines.begin(),lines.end());
+		return lines;
+	}
+
+	// taper on both sides, left and right positions from zero
+	std::vector<double> l(1,0.0);
+	std::vector<double> r(1,0.0);
+	int N1, N2;
+	double ratio1 = TaperSteps(start_res, max_res, ratio, N1);
+	double ratio2 = TaperSteps(stop_res, max_res, ratio, N2);
+	for (int n=1;n<=N1;++n)
+		l.push_back(l.back()+start_res*pow(ratio1,n));
+	for (int n=1;n<=N2;++n)
+		r.push_back(r.back()+stop_res*pow(ratio2,n));
+
+	if (l.back()+r.back()<rng)
+	{
+		// max taper on both sides and max_res in between
+		int N = (int)ceil((rng-l.back()-r.back())/max_res);
+		for (int n=0;n<N;++n)
+			l.push_back(l.back()+max_res);
+	}
+	else
+	{
+		// increase the smaller resolution until both sides meet
+		l.assign(1,0.0);
+		r.assign(1,0.0);
+		while (l.back()+r.back()<rng)
+		{
+			if (start_res==stop_res)
+			{
+				start_res = std::min(start_res*ratio, max_res);
+				l.push_back(l.back()+start_res);
+				stop_res = std::min(stop_res*ratio, max_res);
+				r.push_back(r.back()+stop_res);
+			}
+			else if (start_res<stop_res)
+			{
+				start_res = std::min(start_res*ratio, max_res);
+				l.push_back(l.back()+start_res);
+			}
+			else
+			{
+				stop_res = std::min(stop_res*ratio, max_res);
+				r.push_back(r.back()+stop_res);
+			}
+		}
+	}
+
+	double length = l.back()+r.back();
+	for (size_t n=0;n<r.size();++n)
+		l.push_back(length-r.at(n));
+	UniqueLines(l);
+	for (size_t n=0;n<l.size();++n)
+		lines.push_back(start + l.at(n)*rng/length);
+	return lines;
+}
+
+bool CSRectGrid::SmoothMeshLines(int direct, double max_res, double ratio)
+{
+	if ((direct<0) || (direct>=3) || (max_res<=0) || (ratio<=1))
+		return false;
+	std::vector<double> lines = Lines[direct];
+	UniqueLines(lines);
+	if (lines.size()<2)
+		return false;
+
+	// smooth only one half of a symmetric mesh
+	int sym = CheckLineSymmetry(lines);
+	double center = 0.5*(lines.back()+lines.front());
+	if (sym==1)
+		lines.resize(lines.size()/2+1);
+	else if (sym==2)
+		lines.resize(lines.size()/2);
+
+	// fill all gaps larger than max_res, smallest gap first, the lines of a filled gap define the resolution at its neighbors
+	size_t numGaps = lines.size()-1;
+	std::vector< std::vector<double> > fill(numGaps);
+	std::priority_queue< std::pair<double,size_t>, std::vector< std::pair<double,size_t> >, std::greater< std::pair<double,size_t> > > gaps;
+	for (size_t n=0;n<numGaps;++n)
+		if (lines.at(n+1)-lines.at(n)>max_res)
+			gaps.push(std::make_pair(lines.at(n+1)-lines.at(n),n));
+	while (!gaps.empty())
+	{
+		size_t idx = gaps.top().second;
+		gaps.pop();
+		double start_res = max_res;
+		if (idx>0)
+		{
+			const std::vector<double> &left = fill.at(idx-1);
+			start_res = left.size()>1 ? left.back()-left.at(left.size()-2) : lines.at(idx)-lines.at(idx-1);
+		}
+		double stop_res = max_res;
+		if (idx<numGaps-1)
+		{
+			const std::vector<double> &right = fill.at(idx+1);
+			stop_res = right.size()>1 ? right.at(1)-right.at(0) : lines.at(idx+2)-lines.at(idx+1);
+		}
+		else if (sym==2)
+		{
+			// the neighbor of the last gap is the middle gap, which is filled with the resolution of this gap after mirroring
+			stop_res = std::min(2*(center-lines.back()), max_res);
+		}
+		fill.at(idx) = SmoothRange(lines.at(idx), lines.at(idx+1), start_res, stop_res, max_res, ratio);
+	}
+	for (size_t n=0;n<numGaps;++n)
+		lines.insert(lines.end(), fill.at(n).begin(), fill.at(n).end());
+	UniqueLines(lines);
+
+	// mirror the smoothed half
+	size_t half = lines.size();
+	if (sym==1)
+	{
+		for (size_t n=0;n<half-1;++n)
+			lines.push_back(2*center-lines.at(n));
+	}
+	else if (sym==2)
+	{
+		double res = lines.at(half-1)-lines.at(half-2);
+		std::vector<double> mid = SmoothRange(lines.at(half-1), 2*center-lines.at(half-1), res, res, max_res, ratio);
+		for (size_t n=0;n<half;++n)
+			lines.push_back(2*center-lines.at(n));
+		lines.insert(lines.end(), mid.begin(), mid.end());
+	}
+	UniqueLines(lines);
+	Lines[direct] = lines;
+	return true;
+}
+
+bool CSRectGrid::AnalyseMesh(int direct, MeshQuality &quality, double min_res, double max_res, double ratio) const
+{
+	quality.numLines = 0;
+	quality.minRes = quality.maxRes = 0;
+	quality.maxRatio = 1;
+	quality.maxRatioLine = 0;
+	quality.homogeneous = true;
+	quality.symmetric = false;
+	quality.violationLines.clear();
+	quality.violationTypes.clear();
+	if ((direct<0) || (direct>=3)) return false;
+	const std::vector<double> &lines = Lines[direct];
+	quality.numLines = lines.size();
+	if (lines.size()<2) return false;
+
+	// cell sizes, min/max size and max. ratio in a branch free pass
+	size_t numCells = lines.size()-1;
+	std::vector<double> delta(numCells);
+	for (size_t n=0;n<numCells;++n)
+		delta[n] = lines[n+1]-lines[n];
+	double minRes = delta[0];
+	double maxRes = delta[0];
+	for (size_t n=1;n<numCells;++n)
+	{
+		minRes = delta[n]<minRes ? delta[n] : minRes;
+		maxRes = delta[n]>maxRes ? delta[n] : maxRes;
+	}
+	double maxRatio = 1;
+	for (size_t n=1;n<numCells;++n)
+	{
+		double r = delta[n]>delta[n-1] ? delta[n]/delta[n-1] : delta[n-1]/delta[n];
+		maxRatio = r>maxRatio ? r : maxRatio;
+	}
+	unsigned int maxRatioLine = 0;
+	for (size_t n=1;n<numCells && maxRatio>1;++n)
+		if ((delta[n]/delta[n-1]==maxRatio) || (delta[n-1]/delta[n]==maxRatio))
+		{
+			maxRatioLine = n;
+			break;
+		}
+	quality.minRes = minRes;
+	quality.maxRes = maxRes;
+	quality.maxRatio = maxRatio;
+	quality.maxRatioLine = maxRatioLine;
+	quality.homogeneous = (minRes==maxRes);
+	quality.symmetric = (CheckLineSymmetry(lines)>0);
+
+	// search the violations only if a limit is exceeded
+	bool checkMax = (max_res>0) && (maxRes>max_res);
+	bool checkMin = (min_res>0) && (minRes<min_res);
+	bool checkRatio = (ratio>0) && (maxRatio>ratio*1.01);
+	if ((checkMax==false) && (checkMin==false) && (checkRatio==false))
+		return true;
+	for (size_t n=0;n<numCells;++n)
+	{
+		if (checkMax && (delta[n]>max_res))
+		{
+			quality.violationLines.push_back(n);
+			quality.violationTypes.push_back(MAX_RES_VIOLATION);
+		}
+		if (checkMin && (delta[n]<min_res))
+		{
+			quality.violationLines.push_back(n);
+			quality.violationTypes.push_back(MIN_RES_VIOLATION);
+		}
+		if (checkRatio && (n>0) && (delta[n]/delta[n-1] > ratio*1.01))
+		{
+			quality.violationLines.push_back(n);
+			quality.violationTypes.push_back(RATIO_INCREASE_VIOLATION);
+		}
+		if (checkRatio && (n>0) && (delta[n]/delta[n-1] < 1/ratio/1.01))
+		{
+			quality.violationLines.push_back(n);
+			quality.violationTypes.push_back(RATIO_DECREASE_VIOLATION);
+		}
+	}
+	return true;
+}
+
+double CSRectGrid::GetTimestepCFL() const
+{
+	const double c0 = 299792458;
+	double inv_sum = 0;
+	for (int n=0;n<3;++n)
+	{
+		MeshQuality quality;
+		if (AnalyseMesh(n,quality)==false)
+			continue;
+		double minRes = quality.minRes;
+		if ((m_meshType==CYLINDRICAL) && (n==1))
+		{
+			// azimuthal cell size at the smallest positive radius
+			std::vector<double>::const_iterator r = std::upper_bound(Lines[0].begin(),Lines[0].end(),0.0);
+			if (r==Lines[0].end())
+				continue;
+			minRes *= *r;
+		}
+		minRes *= dDeltaUnit;
+		inv_sum += 1/(minRes*minRes);
+	}
+	if (inv_sum<=0)
+		return 0;
+	return 1/(c0*sqrt(inv_sum));
+}
 
 void CSRectGrid::Sort(int direct)
 {
 	if ((direct<0) || (direct>=3)) return;
 	std::vector<double>::iterator start = Lines[direct].begin();
 	std::vector<double>::iterator end = Lines[direct].end();
+	if (std::adjacent_find(start,end,std::greater_equal<double>())==end)
+		return;
 	sort(start,end);
 	end=unique(start,end);
 	Lines[direct].erase(end,Lines[direct].end());
@@ -232,8 +704,8 @@ double* CSRectGrid::GetSimArea()
 	{
 		if (Lines[i].size()!=0)
 		{
-			SimBox[2*i]=*min_element(Lines[i].begin(),Lines[i].end());
-			SimBox[2*i+1]=*max_element(Lines[i].begin(),Lines[i].end());
+			SimBox[2*i]=Lines[i].front();
+			SimBox[2*i+1]=Lines[i].back();
 		}
 		else SimBox[2*i]=SimBox[2*i+1]=0;
 	}
@@ -251,7 +723,7 @@ bool CSRectGrid::isValid()
 
 bool CSRectGrid::Write2XML(TiXmlNode &root, bool sorted)
 {
-	if (sorted) {Sort(0);Sort(1);Sort(2);}
+	UNUSED(sorted); // lines are always sorted
 	TiXmlElement grid("RectilinearGrid");
 
 	grid.SetDoubleAttribute("DeltaUnit",dDeltaUnit);
@@ -332,9 +804,8 @@ bool CSRectGrid::ReadFromXML(TiXmlNode &root)
 	for (int i=0;i<3;++i)
 	{
 		std::vector<double> lines = SplitString2Double(LineStr[i],',');
-		for (size_t n=0;n<lines.size();++n)
-			AddDiscLine(i,lines.at(n));
-		Sort(i);
+		if (lines.size()>0)
+			MergeLines(i,&lines[0],lines.size());
 	}
 
 	return true;
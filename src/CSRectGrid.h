@@ -35,9 +35,34 @@
 class TiXmlNode;
 
 //! CSRectGrid is managing a rectilinear graded mesh.
+/*!
+ The lines in each direction are kept sorted (increasing) and free of duplicates at all times.
+ */
 class CSXCAD_EXPORT CSRectGrid
 {
 public:
+	//! Mesh violation types found by AnalyseMesh (same codes as used by CheckMesh.m)
+	enum MeshViolationType
+	{
+		MAX_RES_VIOLATION=1, MIN_RES_VIOLATION=2, RATIO_INCREASE_VIOLATION=3, RATIO_DECREASE_VIOLATION=4
+	};
+
+	//! Quality statistics of the lines in a single direction \sa AnalyseMesh
+	struct MeshQuality
+	{
+		unsigned int numLines;
+		//! min. and max. cell size (in drawing units)
+		double minRes, maxRes;
+		//! max. ratio of two neighboring cell sizes (>=1) and the index of the line in between
+		double maxRatio;
+		unsigned int maxRatioLine;
+		bool homogeneous;
+		bool symmetric;
+		//! line index and type of all violations found \sa MeshViolationType
+		std::vector<unsigned int> violationLines;
+		std::vector<int> violationTypes;
+	};
+
 	//! Create an empty grid.
 	CSRectGrid(void);
 	//! Deconstruct the grid.
@@ -45,11 +70,20 @@ public:
 
 	static CSRectGrid* Clone(CSRectGrid* original);
 
-	//! Add a disc-line in the given direction.
+	//! Add a disc-line in the given direction, inserted at its sorted position (ignored if the line exists or is not finite).
 	void AddDiscLine(int direct, double val);
+	//! Add a number of disc-lines in the given direction. \sa MergeLines
 	void AddDiscLines(int direct, int numLines, double* vals);
 	std::string AddDiscLines(int direct, int numLines, double* vals, std::string DistFunction);
 
+	//! Merge a number of (unsorted) lines into the given direction with a single linear pass over the existing lines.
+	/*!
+	 \param tol A new line closer than tol to an existing line or a new line kept before is dropped (0 removes exact duplicates only).
+	 Non-finite values (NaN, inf) are dropped as well.
+	 \return The number of new lines inserted.
+	 */
+	size_t MergeLines(int direct, const double* vals, size_t numLines, double tol=0);
+
 	//! Remove the disc-line at certain index and direction.
 	bool RemoveDiscLine(int direct, int index);
 	//! Remove the disc-line at certain value and direction.
@@ -66,6 +100,7 @@ public:
 	double GetDeltaUnit() {return dDeltaUnit;}
 
 	//! Set a disc-line in a certain direction at a given index. Will return true on success.
+	//! The line is moved to its sorted position, thus its index may change.
 	bool SetLine(int direct, size_t Index, double value);
 
 	//! Get an array of discretization lines in a certain direction.
@@ -73,18 +108,34 @@ public:
 	\param direct The direction of interest.
 	\param array The array in which the lines will be stored. Can be NULL. Caller has to delete the array.
 	\param qty Methode will return the number of lines in this direction.
-	\param sorted Define here whether the lines shall be in increasing order (default) or as currently stored (unknown order).
+	\param sorted Unused, the lines are always in increasing order.
 	 */
 	double* GetLines(int direct, double *array, unsigned int &qty, bool sorted=true);
 	//! Get quantity of lines in certain direction.
 	size_t GetQtyLines(int direct) {if ((direct>=0) && (direct<3)) return Lines[direct].size(); else return 0;}
 	//! Get a disc-line in a certain direction an at given index.
 	double GetLine(int direct, size_t Index);
+	//! Get the index of the line at the given value (within tol), -1 if there is no such line.
+	int GetLineIndex(int direct, double val, double tol=0) const;
 	//! Get disc-lines as a comma-seperated string for given direction
 	std::string GetLinesAsString(int direct);
 
 	//! Snap a given value to a grid line for the given direction
+	/*!
+	 The nearest line is found by a binary search (the value is closer to the upper line, if it is at or above their midpoint).
+	 \param inside Will be false if the value is outside the grid.
+	 \return The index of the nearest line, the first or last line for a value outside the grid (the last line for NaN).
+	 */
 	unsigned int Snap2LineNumber(int ny, double value, bool &inside) const;
+	//! Snap a number of values to their grid lines for the given direction. \sa Snap2LineNumber
+	/*!
+	 Sorted (increasing) values are snapped by a single walk over the lines, each step searching forward from the last result.
+	 Any unsorted value is snapped by a full binary search, the result is identical to Snap2LineNumber in either case.
+	 \param out Array to store the n line indices.
+	 \param inside Optional array to store the n inside flags.
+	 \return false if the direction is invalid or has no lines.
+	 */
+	bool Snap2LineNumbers(int ny, const double* vals, size_t n, unsigned int* out, bool* inside=NULL) const;
 
 	//! Write the grid to a given XML-node.
 	bool Write2XML(TiXmlNode &root, bool sorted=false);
@@ -103,7 +154,33 @@ public:
 	//! Increase the resolution in the specified direction by the given factor.
 	void IncreaseResolution(int nu, int factor);
 
-	//! Sort the lines in a given direction.
+	//! Smooth the lines in the given direction.
+	/*!
+	 Lines are added in between the existing lines, so that no cell is larger than max_res and neighboring cells grow or shrink by at most the given ratio (graded tapering), as far as the existing lines allow.
+	 A symmetric mesh is smoothed symmetrically. Existing lines closer than 1e-7 times the mean line distance are merged.
+	 \return false if there are less than two lines or the arguments are invalid.
+	 */
+	bool SmoothMeshLines(int direct, double max_res, double ratio=1.5);
+
+	//! Analyse the lines in the given direction and check them for violations of the given limits.
+	/*!
+	 All statistics are found by a single pass over the cell sizes, violations are only searched if a limit is exceeded.
+	 A cell larger than max_res or smaller than min_res is reported by the index of its first line.
+	 Two neighboring cells with a size ratio larger than ratio (with a 1% tolerance, as CheckMesh.m) are reported by the index of the line in between.
+	 A limit of 0 disables the check.
+	 \return false if there are less than two lines.
+	 */
+	bool AnalyseMesh(int direct, MeshQuality &quality, double min_res=0, double max_res=0, double ratio=0) const;
+
+	//! Estimate the max. stable timestep (in seconds) of an FDTD (Yee) scheme in vacuum on this grid.
+	/*!
+	 The estimate is based on the smallest cell size in each direction: dt = 1/(c0*sqrt(1/dx^2+1/dy^2+1/dz^2)), using the drawing unit.
+	 Directions with less than two lines are ignored. In a cylindrical grid the azimuthal cell size is taken at the smallest positive radius.
+	 \return 0 if no direction has two lines.
+	 */
+	double GetTimestepCFL() const;
+
+	//! Sort the lines in a given direction. The lines are always kept sorted, this is only needed if a derived class modified the lines directly.
 	void Sort(int direct);
 
 	//! Get the bounding box of the area defined by the disc-lines.
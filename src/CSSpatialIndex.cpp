@@ -0,0 +1,181 @@
+/*
+*	Copyright (C) 2016 Thorsten Liebig (Thorsten.Liebig@gmx.de)
+*
+*	This program is free software: you can redistribute it and/or modify
+*	it under the terms of the GNU Lesser General Public License as published
+*	by the Free Software Foundation, either version 3 of the License, or
+*	(at your option) any later version.
+*
+*	This program is distributed in the hope that it will be useful,
+*	but WITHOUT ANY WARRANTY; without even the implied warranty of
+*	MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+*	GNU Lesser General Public License for more details.
+*
+*	You should have received a copy of the GNU Lesser General Public License
+*	along with this program.  If not, see <http://www.gnu.org/licenses/>.
+*/
+
+#include <algorithm>
+#include <math.h>
+
+#include "CSSpatialIndex.h"
+#include "CSPrimitives.h"
+
+// max number of primitives in a leaf node
+#define BVH_LEAF_SIZE 4
+// max tree depth, limits the traversal stack size
+#define BVH_MAX_DEPTH 48
+
+// compare primitive ranks by the center of their boxes in a given direction
+class BoxCenterLess
+{
+public:
+	BoxCenterLess(const std::vector<double> &boxes, int ny) : m_boxes(boxes), m_ny(ny) {}
+	bool operator()(unsigned int a, unsigned int b) const
+	{
+		return (m_boxes[6*a+2*m_ny]+m_boxes[6*a+2*m_ny+1]) < (m_boxes[6*b+2*m_ny]+m_boxes[6*b+2*m_ny+1]);
+	}
+protected:
+	const std::vector<double> &m_boxes;
+	int m_ny;
+};
+
+CSSpatialIndex::CSSpatialIndex()
+{
+	m_Valid = false;
+}
+
+CSSpatialIndex::~CSSpatialIndex()
+{
+}
+
+void CSSpatialIndex::Clear()
+{
+	m_Valid = false;
+	m_Prims.clear();
+	m_Boxes.clear();
+	m_Order.clear();
+	m_Unbounded.clear();
+	m_Nodes.clear();
+}
+
+void CSSpatialIndex::Build(const std::vector<CSPrimitives*> &prims, double tol)
+{
+	Clear();
+	m_Prims = prims;
+	m_Boxes.resize(6*prims.size(),0);
+	m_Order.reserve(prims.size());
+	double box[6];
+	for (size_t i=0;i<prims.size();++i)
+	{
+		if (prims.at(i)->GetCartesianBoundBox(box)==false)
+		{
+			m_Unbounded.push_back((unsigned int)i);
+			continue;
+		}
+		for (int n=0;n<3;++n)
+		{
+			// enlarge by tolerance and some numerical headroom for transformed boxes
+			double eps = tol + 1e-12*(fabs(box[2*n])+fabs(box[2*n+1]));
+			m_Boxes[6*i+2*n]   = box[2*n]-eps;
+			m_Boxes[6*i+2*n+1] = box[2*n+1]+eps;
+		}
+		m_Order.push_back((unsigned int)i);
+	}
+	if (m_Order.size()>0)
+	{
+		m_Nodes.reserve(2*m_Order.size()/BVH_LEAF_SIZE+1);
+		BuildNode(0, m_Order.size(), 0);
+	}
+	m_Valid = true;
+}
+
+unsigned int CSSpatialIndex::BuildNode(unsigned int start, unsigned int count, int depth)
+{
+	unsigned int idx = m_Nodes.size();
+	m_Nodes.push_back(Node());
+
+	// enclosing box of all primitives and their centers
+	double box[6];
+	double cbox[6];
+	for (unsigned int i=start;i<start+count;++i)
+	{
+		const double* pbox = &m_Boxes[6*m_Order[i]];
+		for (int n=0;n<3;++n)
+		{
+			double c = 0.5*(pbox[2*n]+pbox[2*n+1]);
+			if ((i==start) || (pbox[2*n]<box[2*n]))     box[2*n]=pbox[2*n];
+			if ((i==start) || (pbox[2*n+1]>box[2*n+1])) box[2*n+1]=pbox[2*n+1];
+			if ((i==start) || (c<cbox[2*n]))   cbox[2*n]=c;
+			if ((i==start) || (c>cbox[2*n+1])) cbox[2*n+1]=c;
+		}
+	}
+	for (int n=0;n<6;++n)
+		m_Nodes[idx].box[n] = box[n];
+	m_Nodes[idx].start = start;
+	m_Nodes[idx].count = count;
+	m_Nodes[idx].child[0] = m_Nodes[idx].child[1] = -1;
+
+	if ((count<=BVH_LEAF_SIZE) || (depth>=BVH_MAX_DEPTH))
+		return idx;
+
+	// split at the median of the box centers along the largest extent
+	int ny = 0;
+	for (int n=1;n<3;++n)
+		if ((cbox[2*n+1]-cbox[2*n]) > (cbox[2*ny+1]-cbox[2*ny]))
+			ny = n;
+	if (cbox[2*ny+1]<=cbox[2*ny])
+		return idx; // all centers are identical, no split possible
+
+	unsigned int half = count/2;
+	std::nth_element(m_Order.begin()+start, m_Order.begin()+start+half, m_Order.begin()+start+count, BoxCenterLess(m_Boxes, ny));
+
+	unsigned int left = BuildNode(start, half, depth+1);
+	unsigned int right = BuildNode(start+half, count-half, depth+1);
+	m_Nodes[idx].child[0] = left;
+	m_Nodes[idx].child[1] = right;
+	return idx;
+}
+
+size_t CSSpatialIndex::FindCandidates(const double coord[3], std::vector<unsigned int> &found) const
+{
+	double box[6] = {coord[0],coord[0],coord[1],coord[1],coord[2],coord[2]};
+	return FindCandidatesInBox(box, found);
+}
+
+size_t CSSpatialIndex::FindCandidatesInBox(const double box[6], std::vector<unsigned int> &found) const
+{
+	found.clear();
+	if (m_Nodes.size()>0)
+	{
+		unsigned int stack[2*BVH_MAX_DEPTH+2];
+		int top = 0;
+		stack[top++] = 0;
+		while (top>0)
+		{
+			const Node &node = m_Nodes[stack[--top]];
+			if ((box[1]<node.box[0]) || (box[0]>node.box[1]) ||
+				(box[3]<node.box[2]) || (box[2]>node.box[3]) ||
+				(box[5]<node.box[4]) || (box[4]>node.box[5]))
+				continue;
+			if (node.child[0]>=0)
+			{
+				stack[top++] = node.child[0];
+				stack[top++] = node.child[1];
+				continue;
+			}
+			for (unsigned int i=node.start;i<node.start+node.count;++i)
+			{
+				const double* pbox = &m_Boxes[6*m_Order[i]];
+				if ((box[1]<pbox[0]) || (box[0]>pbox[1]) ||
+					(box[3]<pbox[2]) || (box[2]>pbox[3]) ||
+					(box[5]<pbox[4]) || (box[4]>pbox[5]))
+					continue;
+				found.push_back(m_Order[i]);
+			}
+		}
+	}
+	found.insert(found.end(), m_Unbounded.begin(), m_Unbounded.end());
+	std::sort(found.begin(), found.end());
+	return found.size();
+}
@@ -0,0 +1,87 @@
+/*
+*	Copyright (C) 2016 Thorsten Liebig (Thorsten.Liebig@gmx.de)
+*
+*	This program is free software: you can redistribute it and/or modify
+*	it under the terms of the GNU Lesser General Public License as published
+*	by the Free Software Foundation, either version 3 of the License, or
+*	(at your option) any later version.
+*
+*	This program is distributed in the hope that it will be useful,
+*	but WITHOUT ANY WARRANTY; without even the implied warranty of
+*	MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+*	GNU Lesser General Public License for more details.
+*
+*	You should have received a copy of the GNU Lesser General Public License
+*	along with this program.  If not, see <http://www.gnu.org/licenses/>.
+*/
+
+#pragma once
+
+#include <vector>
+#include "CSXCAD_Global.h"
+
+class CSPrimitives;
+
+//! Bounding volume hierarchy (BVH) over the Cartesian bounding boxes of a list of primitives.
+/*!
+ The primitives are identified by their rank, the position in the list given to Build().
+ This list is expected to be sorted in the order primitives win a coordinate (highest priority first),
+ thus a query can stop with the first candidate found to include a coordinate.
+ Primitives without a known bounding box are reported as candidate for every query.
+ */
+class CSXCAD_EXPORT CSSpatialIndex
+{
+public:
+	CSSpatialIndex();
+	virtual ~CSSpatialIndex();
+
+	//! Build the index for the given (priority sorted) primitives. All bounding boxes are enlarged by the given tolerance.
+	void Build(const std::vector<CSPrimitives*> &prims, double tol=0);
+
+	//! Remove all primitives, the index will be invalid afterwards.
+	void Clear();
+
+	//! Check if the index was build and is usable
+	bool IsValid() const {return m_Valid;}
+
+	//! Get the number of indexed primitives
+	size_t GetQtyPrimitives() const {return m_Prims.size();}
+	//! Get the number of primitives without a usable bounding box
+	size_t GetQtyUnbounded() const {return m_Unbounded.size();}
+
+	//! Get the primitive with the given rank
+	CSPrimitives* GetPrimitive(unsigned int rank) const {return m_Prims[rank];}
+
+	//! Find all primitives with a bounding box containing the given Cartesian coordinate.
+	/*!
+	 \param coord Cartesian coordinate
+	 \param found Vector to store the found ranks, will be cleared and filled in increasing order (highest priority first).
+	 \return Number of candidates found
+	 */
+	size_t FindCandidates(const double coord[3], std::vector<unsigned int> &found) const;
+
+	//! Find all primitives with a bounding box intersecting the given Cartesian box (xmin,xmax,ymin,...). \sa FindCandidates
+	size_t FindCandidatesInBox(const double box[6], std::vector<unsigned int> &found) const;
+
+protected:
+	struct Node
+	{
+		double box[6];
+		//! index of the two child nodes or -1 for a leaf
+		int child[2];
+		//! range of primitive ranks in m_Order for a leaf node
+		unsigned int start, count;
+	};
+
+	unsigned int BuildNode(unsigned int start, unsigned int count, int depth);
+
+	bool m_Valid;
+	std::vector<CSPrimitives*> m_Prims;
+	//! Cartesian bounding box for each bounded primitive (by rank)
+	std::vector<double> m_Boxes;
+	//! ranks of all bounded primitives, reordered during build
+	std::vector<unsigned int> m_Order;
+	//! ranks of all primitives without a bounding box
+	std::vector<unsigned int> m_Unbounded;
+	std::vector<Node> m_Nodes;
+};
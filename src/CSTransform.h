@@ -48,6 +48,8 @@ public:
 	void Invert();
 
 	double* GetMatrix() {return m_TMatrix;}
+	//! Get the inverse transformation matrix \sa InvertTransform
+	const double* GetInverseMatrix() const {return m_Inv_TMatrix;}
 
 	//! Apply a matrix directly
 	void SetMatrix(const double matrix[16], bool concatenate=true);
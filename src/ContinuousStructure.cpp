@@ -18,6 +18,8 @@
 
 #include <ctime>
 #include <iomanip>
+#include <algorithm>
+#include <boost/thread.hpp>
 #include "ContinuousStructure.h"
 #include "CSPrimPoint.h"
 #include "CSPrimBox.h"
@@ -56,6 +58,17 @@
 ContinuousStructure::ContinuousStructure(void)
 {
 	clParaSet = new ParameterSet();
+	m_UseSpatialIndex = false;
+	m_UseCompiledScene = false;
+	m_UpdateValid = false;
+	m_UpdateModCounter = 0;
+	m_TrackDirtyRegions = false;
+	m_InTransaction = false;
+	m_NameIndexValid = false;
+	m_NameIndexCounter = 0;
+	m_SnapshotUpdate = 0;
+	m_DirtyUnbounded = false;
+	m_NumThreads = 0;
 	//init datastructures...
 	clear();
 }
@@ -71,10 +84,36 @@ void ContinuousStructure::AddProperty(CSProperties* prop)
 {
 	if (prop==NULL) return;
 	prop->SetCoordInputType(m_MeshType);
-	prop->Update(&ErrString);
+	// properties added during a transaction are updated by CommitTransaction()
+	if (m_InTransaction==false)
+		prop->Update(&ErrString);
+	// the ID is the index of the property, all others keep theirs
+	prop->SetID((unsigned int)vProperties.size());
 	vProperties.push_back(prop);
 	prop->SetUniqueID(UniqueIDCounter++);
+	if (m_NameIndexValid)
+		m_NameIndex.insert(std::make_pair(prop->GetName(),prop));
+	m_SpatialIndex.Clear();
+	m_CompiledScene.Clear();
+}
+
+void ContinuousStructure::BeginTransaction()
+{
+	m_InTransaction = true;
+}
+
+void ContinuousStructure::CommitTransaction()
+{
+	if (m_InTransaction==false)
+		return;
+	m_InTransaction = false;
 	this->UpdateIDs();
+	for (size_t i=0;i<vProperties.size();++i)
+		if (vProperties.at(i)->GetModified())
+			vProperties.at(i)->Update(&ErrString);
+	m_NameIndexValid = false;
+	m_SpatialIndex.Clear();
+	m_CompiledScene.Clear();
 }
 
 bool ContinuousStructure::ReplaceProperty(CSProperties* oldProp, CSProperties* newProp)
@@ -93,7 +132,11 @@ bool ContinuousStructure::ReplaceProperty(CSProperties* oldProp, CSProperties* n
 			}
 			delete *iter;
 			*iter=newProp;
+			newProp->SetID((unsigned int)(iter-vProperties.begin()));
 			newProp->SetUniqueID(UniqueIDCounter++);
+			m_NameIndexValid = false;
+			m_SpatialIndex.Clear();
+			m_CompiledScene.Clear();
 			return true;
 		}
 	}
@@ -106,7 +149,12 @@ void ContinuousStructure::DeleteProperty(size_t index)
 	std::vector<CSProperties*>::iterator iter=vProperties.begin();
 	delete vProperties.at(index);
 	vProperties.erase(iter+index);
-	this->UpdateIDs();
+	// renumbered by CommitTransaction() during a transaction
+	if (m_InTransaction==false)
+		this->UpdateIDs();
+	m_NameIndexValid = false;
+	m_SpatialIndex.Clear();
+	m_CompiledScene.Clear();
 }
 
 void ContinuousStructure::DeleteProperty(CSProperties* prop)
@@ -118,14 +166,23 @@ void ContinuousStructure::DeleteProperty(CSProperties* prop)
 		{
 			delete *iter;
 			vProperties.erase(iter);
+			break;
 		}
 	}
-	this->UpdateIDs();
+	if (m_InTransaction==false)
+		this->UpdateIDs();
+	m_NameIndexValid = false;
+	m_SpatialIndex.Clear();
+	m_CompiledScene.Clear();
 }
 
 int ContinuousStructure::GetIndex(CSProperties* prop)
 {
 	if (prop==NULL) return -1;
+	// the ID of a property is its index, unless renumbering is pending
+	size_t id = prop->GetID();
+	if ((id<vProperties.size()) && (vProperties.at(id)==prop))
+		return (int)id;
 	for (size_t i=0;i<vProperties.size();++i)
 		if (vProperties.at(i)==prop) return (int)i;
 	return -1;
@@ -176,8 +233,27 @@ std::vector<CSPrimitives*> ContinuousStructure::GetAllPrimitives(bool sorted, CS
 	return vPrim;
 }
 
+bool sortPrimByPrioDesc(CSPrimitives* a, CSPrimitives* b)
+{
+	return a->GetPriority()>b->GetPriority();
+}
+
+std::vector<CSPrimitives*> ContinuousStructure::GetPrimitivesByPriority(CSProperties::PropertyType type)
+{
+	// same order as the linear search: highest priority first, otherwise in order of properties and their primitives
+	std::vector<CSPrimitives*> vPrim = GetAllPrimitives(false, type);
+	std::stable_sort(vPrim.begin(), vPrim.end(), sortPrimByPrioDesc);
+	return vPrim;
+}
+
 CSProperties* ContinuousStructure::HasPrimitive(CSPrimitives* prim)
 {
+	if (prim==NULL)
+		return NULL;
+	// most likely owned by its property
+	CSProperties* prop = prim->GetProperty();
+	if ((prop!=NULL) && (GetIndex(prop)>=0) && prop->HasPrimitive(prim))
+		return prop;
 	for (size_t i=0;i<vProperties.size();++i)
 		if (vProperties.at(i)->HasPrimitive(prim))
 			return vProperties.at(i);
@@ -188,6 +264,8 @@ void ContinuousStructure::DeletePrimitive(CSPrimitives* prim)
 {
 	// no special handling is necessary, deleted primitive will release itself from its owning property
 	delete prim;
+	m_SpatialIndex.Clear();
+	m_CompiledScene.Clear();
 }
 
 std::vector<CSPrimitives*> ContinuousStructure::GetPrimitivesByType(CSPrimitives::PrimitiveType type)
@@ -218,34 +296,49 @@ bool ContinuousStructure::InsertEdges2Grid(int nu)
 	double box[6] = {0,0,0,0,0,0};
 	bool accBound=false;
 	std::vector<CSPrimitives*> vPrimitives=GetAllPrimitives();
+	std::vector<double> lines;
+	lines.reserve(2*vPrimitives.size());
 	for (size_t i=0;i<vPrimitives.size();++i)
 	{
 		accBound = vPrimitives.at(i)->GetBoundBox(box);
 		if (accBound)
 		{
-			clGrid.AddDiscLine(nu,box[2*nu]);
-			clGrid.AddDiscLine(nu,box[2*nu+1]);
+			lines.push_back(box[2*nu]);
+			lines.push_back(box[2*nu+1]);
 		}
 	}
-	clGrid.Sort(nu);
+	if (lines.size()>0)
+		clGrid.MergeLines(nu,&lines[0],lines.size());
 	return true;
 }
 
 CSPrimitives* ContinuousStructure::GetPrimitiveByID(unsigned int ID)
 {
-	std::vector<CSPrimitives*> vPrimitives=GetAllPrimitives();
-	for (size_t i=0;i<vPrimitives.size();++i)
-		if (vPrimitives.at(i)->GetID()==ID)
-			return vPrimitives.at(i);
+	for (size_t i=0;i<vProperties.size();++i)
+	{
+		CSPrimitives* prim = vProperties.at(i)->GetPrimitiveByID(ID);
+		if (prim!=NULL)
+			return prim;
+	}
 	return NULL;
 }
 
 std::vector<CSProperties*> ContinuousStructure::GetPropertiesByName(std::string name)
 {
+	// rebuild the name lookup if any property was renamed
+	if ((m_NameIndexValid==false) || (m_NameIndexCounter!=CSProperties::GetNameCounter()))
+	{
+		m_NameIndex.clear();
+		for (size_t i=0;i<vProperties.size();++i)
+			m_NameIndex.insert(std::make_pair(vProperties.at(i)->GetName(),vProperties.at(i)));
+		m_NameIndexCounter = CSProperties::GetNameCounter();
+		m_NameIndexValid = true;
+	}
+	// equal names are kept in the order of insertion, i.e. the order of the properties
 	std::vector<CSProperties*> vProp;
-	for (size_t i=0;i<vProperties.size();++i)
-		if (name.compare(vProperties.at(i)->GetName())==0)
-			vProp.push_back(vProperties.at(i));
+	std::pair<std::multimap<std::string, CSProperties*>::const_iterator, std::multimap<std::string, CSProperties*>::const_iterator> range = m_NameIndex.equal_range(name);
+	for (std::multimap<std::string, CSProperties*>::const_iterator it=range.first;it!=range.second;++it)
+		vProp.push_back(it->second);
 	return vProp;
 }
 
@@ -257,6 +350,15 @@ CSProperties* ContinuousStructure::GetProperty(size_t index)
 
 CSProperties* ContinuousStructure::GetPropertyByCoordPriority(const double* coord, CSProperties::PropertyType type, bool markFoundAsUsed, CSPrimitives** foundPrimitive)
 {
+	if (m_SpatialIndex.IsValid())
+	{
+		// local candidate storage, this query is reentrant
+		std::vector<unsigned int> candidates;
+		return GetPropertyByCoordPriority(coord, type, markFoundAsUsed, foundPrimitive, candidates);
+	}
+	if (m_CompiledScene.IsValid())
+		return GetPropertyByCoordPriority(m_CompiledScene, coord, type, markFoundAsUsed, foundPrimitive);
+
 	CSProperties* winProp=NULL;
 	CSPrimitives* winPrim=NULL;
 	CSPrimitives* locPrim=NULL;
@@ -266,7 +368,7 @@ CSProperties* ContinuousStructure::GetPropertyByCoordPriority(const double* coor
 	{
 		if ((type==CSProperties::ANY) || (vProperties.at(i)->GetType() & type))
 		{
-			locPrim = vProperties.at(i)->CheckCoordInPrimitive(coord,locPrio,dDrawingTol);
+			locPrim = vProperties.at(i)->CheckCoordInPrimitive(coord,locPrio,false,dDrawingTol);
 			if (locPrim)
 			{
 				if (winProp==NULL)
@@ -291,13 +393,214 @@ CSProperties* ContinuousStructure::GetPropertyByCoordPriority(const double* coor
 	return winProp;
 }
 
-
-CSProperties** ContinuousStructure::GetPropertiesByCoordsPriority(const double* /*coords*/, CSProperties::PropertyType /*type*/, bool /*markFoundAsUsed*/)
+CSProperties* ContinuousStructure::GetPropertyByCoordPriority(const double* coord, CSProperties::PropertyType type, bool markFoundAsUsed, CSPrimitives** foundPrimitive, std::vector<unsigned int> &candidates)
 {
-	std::cerr << "ContinuousStructure::GetPropertiesByCoordsPriority --> This methode has not been implemented yet!!! return NULL" << std::endl;
+	double pos[3];
+	TransformCoordSystem(coord,pos,m_MeshType,CARTESIAN);
+	m_SpatialIndex.FindCandidates(pos, candidates);
+
+	// candidates are sorted by priority, the first primitive including the coordinate wins
+	CSPrimitives* prim=NULL;
+	CSProperties* prop=NULL;
+	for (size_t i=0;i<candidates.size();++i)
+	{
+		prim = m_SpatialIndex.GetPrimitive(candidates[i]);
+		prop = prim->GetProperty();
+		if ((type!=CSProperties::ANY) && ((prop->GetType() & type)==0))
+			continue;
+		if (m_CompiledScene.IsValid() ? m_CompiledScene.IsInside(candidates[i], coord) : prim->IsInside(coord,dDrawingTol))
+		{
+			if (markFoundAsUsed)
+				prim->SetPrimitiveUsed(true);
+			if (foundPrimitive)
+				*foundPrimitive=prim;
+			return prop;
+		}
+	}
+	if (foundPrimitive)
+		*foundPrimitive=NULL;
 	return NULL;
 }
 
+CSProperties* ContinuousStructure::GetPropertyByCoordPriority(const CSCompiledScene &scene, const double* coord, CSProperties::PropertyType type, bool markFoundAsUsed, CSPrimitives** foundPrimitive)
+{
+	int rank = scene.FindPrimitive(coord, type);
+	CSPrimitives* prim = NULL;
+	if (rank>=0)
+	{
+		prim = scene.GetPrimitive(rank);
+		if (markFoundAsUsed)
+			prim->SetPrimitiveUsed(true);
+	}
+	if (foundPrimitive)
+		*foundPrimitive=prim;
+	return prim ? prim->GetProperty() : NULL;
+}
+
+void ContinuousStructure::BuildSpatialIndex()
+{
+	m_SpatialIndex.Build(GetPrimitivesByPriority(), dDrawingTol);
+}
+
+void ContinuousStructure::SetUseSpatialIndex(bool val)
+{
+	m_UseSpatialIndex = val;
+	if (m_UseSpatialIndex==false)
+		m_SpatialIndex.Clear();
+}
+
+void ContinuousStructure::SetUseCompiledScene(bool val)
+{
+	m_UseCompiledScene = val;
+	if (m_UseCompiledScene==false)
+		m_CompiledScene.Clear();
+}
+
+void ContinuousStructure::SetTrackDirtyRegions(bool val)
+{
+	m_TrackDirtyRegions = val;
+	m_Snapshots.clear();
+	ClearDirtyRegions();
+}
+
+void ContinuousStructure::ClearDirtyRegions()
+{
+	m_DirtyRegions.clear();
+	m_DirtyUnbounded = false;
+}
+
+void ContinuousStructure::AddDirtyRegion(bool bounded, const double* box)
+{
+	if (bounded==false)
+	{
+		m_DirtyUnbounded = true;
+		return;
+	}
+	m_DirtyRegions.insert(m_DirtyRegions.end(), box, box+6);
+}
+
+void ContinuousStructure::UpdateSnapshot(CSPrimitives* prim, bool updated, bool modified, std::vector<double> &values)
+{
+	std::map<CSPrimitives*, PrimitiveSnapshot>::iterator it = m_Snapshots.find(prim);
+	bool isNew = (it==m_Snapshots.end());
+	if (isNew)
+		it = m_Snapshots.insert(std::make_pair(prim, PrimitiveSnapshot())).first;
+	PrimitiveSnapshot &snap = it->second;
+	snap.update = m_SnapshotUpdate;
+
+	// a primitive not updated (incremental update) has not changed its shape
+	if (!isNew && !updated && (snap.priority==prim->GetPriority()) && (snap.prop==prim->GetProperty()))
+		return;
+
+	double box[6];
+	bool bounded = prim->GetCartesianBoundBox(box);
+	if (prim->HasTransform())
+	{
+		const double* matrix = prim->GetTransform()->GetInverseMatrix();
+		values.insert(values.end(), matrix, matrix+12);
+	}
+	bool changed = isNew || modified || (snap.priority!=prim->GetPriority()) || (snap.prop!=prim->GetProperty()) || (snap.bounded!=bounded);
+	if (updated)
+		changed = changed || (snap.values!=values);
+	for (int n=0;(n<6) && bounded && !changed;++n)
+		changed = (snap.box[n]!=box[n]);
+	if (changed==false)
+		return;
+
+	// the old and new region
+	if (!isNew)
+		AddDirtyRegion(snap.bounded, snap.box);
+	AddDirtyRegion(bounded, box);
+
+	snap.bounded = bounded;
+	for (int n=0;n<6;++n)
+		snap.box[n] = bounded ? box[n] : 0;
+	snap.priority = prim->GetPriority();
+	snap.prop = prim->GetProperty();
+	if (updated)
+		snap.values.swap(values);
+}
+
+
+CSProperties** ContinuousStructure::GetPropertiesByCoordsPriority(const double* coords, size_t n, CSProperties::PropertyType type, bool markFoundAsUsed, CSPrimitives** foundPrimitives)
+{
+	if ((coords==NULL) || (n==0))
+		return NULL;
+	CSProperties** props = new CSProperties*[n];
+	GetPropertiesByCoordsPriority(coords, n, props, foundPrimitives, type, markFoundAsUsed);
+	return props;
+}
+
+bool ContinuousStructure::GetPropertiesByCoordsPriority(const double* coords, size_t n, CSProperties** props, CSPrimitives** foundPrimitives, CSProperties::PropertyType type, bool markFoundAsUsed)
+{
+	if ((coords==NULL) || (props==NULL))
+		return false;
+	if (n==0)
+		return true;
+
+	// the found primitives are needed to mark them as used after the search
+	CSPrimitives** prims = foundPrimitives;
+	if ((prims==NULL) && markFoundAsUsed)
+		prims = new CSPrimitives*[n];
+
+	// do not start threads for only a few coordinates
+	const size_t minCoordsPerThread = 1000;
+	unsigned int numThreads = GetNumberOfThreads(n/minCoordsPerThread);
+	if (numThreads<=1)
+		FindPropertiesByCoordsPriority(coords, 0, n, props, prims, type);
+	else
+	{
+		boost::thread_group threads;
+		size_t start = 0;
+		for (unsigned int t=0;t<numThreads;++t)
+		{
+			size_t stop = (n*(t+1))/numThreads;
+			threads.add_thread(new boost::thread(&ContinuousStructure::FindPropertiesByCoordsPriority, this, coords, start, stop, props, prims, type));
+			start = stop;
+		}
+		threads.join_all();
+	}
+
+	if (markFoundAsUsed)
+	{
+		// marked after all threads are finished, neighboring coordinates mostly find the same primitive
+		CSPrimitives* last = NULL;
+		for (size_t i=0;i<n;++i)
+			if (prims[i] && (prims[i]!=last))
+			{
+				prims[i]->SetPrimitiveUsed(true);
+				last = prims[i];
+			}
+		if (prims!=foundPrimitives)
+			delete[] prims;
+	}
+	return true;
+}
+
+void ContinuousStructure::FindPropertiesByCoordsPriority(const double* coords, size_t start, size_t stop, CSProperties** props, CSPrimitives** prims, CSProperties::PropertyType type)
+{
+	CSPrimitives* prim = NULL;
+	if (m_SpatialIndex.IsValid())
+	{
+		// candidate storage for this thread, only grows for the first few coordinates
+		std::vector<unsigned int> candidates;
+		candidates.reserve(m_SpatialIndex.GetQtyPrimitives());
+		for (size_t i=start;i<stop;++i)
+		{
+			props[i] = GetPropertyByCoordPriority(&coords[3*i], type, false, &prim, candidates);
+			if (prims)
+				prims[i] = prim;
+		}
+		return;
+	}
+	for (size_t i=start;i<stop;++i)
+	{
+		props[i] = GetPropertyByCoordPriority(&coords[3*i], type, false, &prim);
+		if (prims)
+			prims[i] = prim;
+	}
+}
+
 CSProperties* ContinuousStructure::GetPropertyByCoordPriority(const double* coord, std::vector<CSPrimitives*> primList, bool markFoundAsUsed, CSPrimitives** foundPrimitive)
 {
 	CSProperties* prop = NULL;
@@ -346,6 +649,8 @@ void ContinuousStructure::SetCoordInputType(CoordinateSystem type)
 	{
 		vProperties.at(i)->SetCoordInputType(type);
 	}
+	m_SpatialIndex.Clear();
+	m_CompiledScene.Clear();
 }
 
 bool ContinuousStructure::isGeometryValid()
@@ -402,16 +707,176 @@ double* ContinuousStructure::GetObjectArea(CSProperties::PropertyType type)
 	return ObjArea;
 }
 
-std::string ContinuousStructure::Update()
+unsigned int ContinuousStructure::GetNumberOfThreads(size_t numTasks) const
+{
+	unsigned int numThreads = m_NumThreads;
+	if (numThreads==0)
+		numThreads = boost::thread::hardware_concurrency();
+	if (numTasks<numThreads)
+		numThreads = (unsigned int)numTasks;
+	return numThreads;
+}
+
+static bool ComparePolyhedronSize(CSPrimPolyhedron* a, CSPrimPolyhedron* b)
+{
+	return a->GetNumFaces()>b->GetNumFaces();
+}
+
+//! Build the polyhedron trees taken from a shared list until it is empty
+static void BuildPolyhedronTreesWorker(std::vector<CSPrimPolyhedron*>* polyhedra, size_t* next, boost::mutex* mutex)
+{
+	while (true)
+	{
+		CSPrimPolyhedron* polyhedron;
+		{
+			boost::mutex::scoped_lock lock(*mutex);
+			if (*next>=polyhedra->size())
+				return;
+			polyhedron = polyhedra->at((*next)++);
+		}
+		polyhedron->BuildTree();
+	}
+}
+
+void ContinuousStructure::BuildPolyhedronTrees(const std::vector<CSPrimitives*> &vPrimitives)
+{
+	std::vector<CSPrimPolyhedron*> polyhedra;
+	for (size_t i=0;i<vPrimitives.size();++i)
+	{
+		CSPrimitives* prim = vPrimitives.at(i);
+		if ((prim->GetType()!=CSPrimitives::POLYHEDRON) && (prim->GetType()!=CSPrimitives::POLYHEDRONREADER))
+			continue;
+		CSPrimPolyhedron* polyhedron = static_cast<CSPrimPolyhedron*>(prim);
+		if ((polyhedron->IsTreeValid()==false) && (polyhedron->GetLazyBuild()==false))
+			polyhedra.push_back(polyhedron);
+	}
+	// largest first for a good load balance
+	std::sort(polyhedra.begin(), polyhedra.end(), ComparePolyhedronSize);
+
+	unsigned int numThreads = GetNumberOfThreads(polyhedra.size());
+	size_t next = 0;
+	boost::mutex mutex;
+	if (numThreads<=1)
+		BuildPolyhedronTreesWorker(&polyhedra, &next, &mutex);
+	else
+	{
+		boost::thread_group threads;
+		for (unsigned int t=0;t<numThreads;++t)
+			threads.add_thread(new boost::thread(&BuildPolyhedronTreesWorker, &polyhedra, &next, &mutex));
+		threads.join_all();
+	}
+}
+
+//! Check if any of the dependencies is in the (small) list of modified parameters
+static bool IsAffected(const std::vector<Parameter*> &deps, const std::vector<Parameter*> &modified)
+{
+	for (size_t n=0;n<deps.size();++n)
+		if (std::find(modified.begin(),modified.end(),deps.at(n))!=modified.end())
+			return true;
+	return false;
+}
+
+bool ContinuousStructure::FindModifiedParameters(std::vector<Parameter*> &modified) const
+{
+	modified.clear();
+	if (m_UpdateValid==false)
+		return false;
+	// any direct change of a parameter scalar or the parameter set requires a full update
+	if (m_UpdateModCounter!=clParaSet->GetScalarModificationCounter())
+		return false;
+	if (clParaSet->GetParaSetModified())
+		return false;
+	if (clParaSet->GetQtyParameter()!=m_UpdateParaNames.size())
+		return false;
+	for (size_t n=0;n<clParaSet->GetQtyParameter();++n)
+	{
+		Parameter* para = clParaSet->GetParameter(n);
+		if (para->GetName()!=m_UpdateParaNames.at(n))
+			return false;
+		if (para->GetModified())
+			modified.push_back(para);
+	}
+	return true;
+}
+
+std::string ContinuousStructure::Update(bool fullUpdate)
 {
 	ErrString.clear();
 
+	std::vector<Parameter*> modified;
+	bool incremental = (fullUpdate==false) && FindModifiedParameters(modified);
+
+	// record the parameters used by each updated property and primitive
+	std::vector<Parameter*> deps;
+	clParaSet->SetDependencyRecorder(&deps);
 	for (size_t i=0;i<vProperties.size();++i)
-		vProperties.at(i)->Update(&ErrString);
+	{
+		CSProperties* prop = vProperties.at(i);
+		if (incremental && !prop->GetModified() && !IsAffected(prop->GetParameterDependencies(),modified))
+			continue;
+		deps.clear();
+		// an object failing to update is updated again next time
+		prop->SetModified(prop->Update(&ErrString)==false);
+		prop->SetParameterDependencies(deps);
+	}
 
 	std::vector<CSPrimitives*> vPrimitives=GetAllPrimitives();
+	// build all polyhedron trees in parallel first, the primitive updates below will not rebuild them
+	BuildPolyhedronTrees(vPrimitives);
+	std::vector<double> values;
+	++m_SnapshotUpdate;
 	for (size_t i=0;i<vPrimitives.size();++i)
-		vPrimitives.at(i)->Update(&ErrString);
+	{
+		CSPrimitives* prim = vPrimitives.at(i);
+		bool primModified = prim->GetModified();
+		bool update = !incremental || primModified || IsAffected(prim->GetParameterDependencies(),modified);
+		if (update)
+		{
+			deps.clear();
+			values.clear();
+			if (m_TrackDirtyRegions)
+				clParaSet->SetValueRecorder(&values);
+			prim->SetModified(prim->Update(&ErrString)==false);
+			clParaSet->SetValueRecorder(NULL);
+			prim->SetParameterDependencies(deps);
+		}
+		if (m_TrackDirtyRegions)
+			UpdateSnapshot(prim, update, primModified, values);
+	}
+	clParaSet->SetDependencyRecorder(NULL);
+
+	if (m_TrackDirtyRegions)
+	{
+		// regions of all removed primitives
+		std::map<CSPrimitives*, PrimitiveSnapshot>::iterator it = m_Snapshots.begin();
+		while (it!=m_Snapshots.end())
+		{
+			if (it->second.update==m_SnapshotUpdate)
+			{
+				++it;
+				continue;
+			}
+			AddDirtyRegion(it->second.bounded, it->second.box);
+			m_Snapshots.erase(it++);
+		}
+	}
+
+	// all dependent objects are up to date
+	clParaSet->SetModified(false);
+	m_UpdateParaNames.resize(clParaSet->GetQtyParameter());
+	for (size_t n=0;n<m_UpdateParaNames.size();++n)
+		m_UpdateParaNames.at(n) = clParaSet->GetParameter(n)->GetName();
+	m_UpdateModCounter = clParaSet->GetScalarModificationCounter();
+	m_UpdateValid = true;
+
+	if (m_UseSpatialIndex)
+		BuildSpatialIndex();
+	else
+		m_SpatialIndex.Clear();
+	if (m_UseCompiledScene)
+		m_CompiledScene.Compile(GetPrimitivesByPriority(), m_MeshType, dDrawingTol);
+	else
+		m_CompiledScene.Clear();
 
 	return std::string(ErrString);
 }
@@ -428,6 +893,15 @@ void ContinuousStructure::clear()
 		vProperties.at(n)=NULL;
 	}
 	vProperties.clear();
+	m_SpatialIndex.Clear();
+	m_CompiledScene.Clear();
+	m_UpdateValid = false;
+	m_InTransaction = false;
+	m_NameIndexValid = false;
+	m_Snapshots.clear();
+	ClearDirtyRegions();
+	// all tracked primitives are removed
+	m_DirtyUnbounded = m_TrackDirtyRegions;
 	SetCoordInputType(CARTESIAN);
 	if (clParaSet)
 		clParaSet->clear();
@@ -518,6 +992,7 @@ const char* ContinuousStructure::ReadFromXML(TiXmlNode* rootNode)
 
 	TiXmlElement* PropNode = probs->FirstChildElement();
 	CSProperties* newProp=NULL;
+	BeginTransaction();
 	while (PropNode!=NULL)
 	{
 		const char* cProp=PropNode->Value();
@@ -567,6 +1042,8 @@ const char* ContinuousStructure::ReadFromXML(TiXmlNode* rootNode)
 		}
         PropNode=PropNode->NextSiblingElement();
 	}
+	CommitTransaction();
+	BuildPolyhedronTrees(GetAllPrimitives());
 	return ErrString.c_str();
 }
 
@@ -612,7 +1089,13 @@ bool ContinuousStructure::ReadPropertyPrimitives(TiXmlElement* PropNode, CSPrope
 			if (newPrim->ReadFromXML(*PrimNode))
 			{
 				newPrim->SetCoordInputType(m_MeshType, false);
+				// polyhedron trees are build in parallel after reading all primitives
+				bool polyhedron = (newPrim->GetType()==CSPrimitives::POLYHEDRON) || (newPrim->GetType()==CSPrimitives::POLYHEDRONREADER);
+				if (polyhedron)
+					static_cast<CSPrimPolyhedron*>(newPrim)->SetLazyBuild(true);
 				newPrim->Update(&ErrString);
+				if (polyhedron)
+					static_cast<CSPrimPolyhedron*>(newPrim)->SetLazyBuild(false);
 			}
 			else
 			{
@@ -28,11 +28,14 @@
 #include <iostream>
 #include <string>
 #include <vector>
+#include <map>
 #include "CSXCAD_Global.h"
 #include "CSProperties.h"
 #include "CSPrimitives.h"
 #include "CSRectGrid.h"
 #include "CSBackgroundMaterial.h"
+#include "CSSpatialIndex.h"
+#include "CSCompiledScene.h"
 #include "ParameterObjects.h"
 #include "CSUseful.h"
 
@@ -66,6 +69,13 @@ public:
 	//! Add an existing CSProperty. Class takes ownership!
 	void AddProperty(CSProperties* prop);
 
+	//! Start adding or removing many properties at once. Properties are not updated and property IDs are not renumbered until CommitTransaction(). \sa AddProperty, DeleteProperty
+	void BeginTransaction();
+	//! Renumber the property IDs and update all properties added since BeginTransaction().
+	void CommitTransaction();
+	//! Check if a transaction is pending. \sa BeginTransaction
+	bool InTransaction() const {return m_InTransaction;}
+
 	//! Replace an existing property with a new one. \sa AddProperty, DeleteProperty
 	bool ReplaceProperty(CSProperties* oldProp, CSProperties* newProp);
 
@@ -75,10 +85,10 @@ public:
 	//! Remove and delete a known Property
 	void DeleteProperty(CSProperties* prop);
 
-	//! Get a primitive by its unique ID.
+	//! Get a primitive by its unique ID. Each property is searched by a lookup of its primitives. \sa CSProperties::GetPrimitiveByID
 	CSPrimitives* GetPrimitiveByID(unsigned int ID);
 
-	//! Get all properties with the given name
+	//! Get all properties with the given name, using a lookup by name which is rebuild if any property was renamed.
 	std::vector<CSProperties*> GetPropertiesByName(std::string name);
 
 	//! Get a property by its internal index number. \sa GetQtyProperties
@@ -91,6 +101,45 @@ public:
 
 	//! Set a drawing tolerance. /sa GetPropertyByCoordPriority /sa GetPropertiesByCoordsPriority
 	void SetDrawingTolerance(double val) {dDrawingTol=val;}
+	//! Get the drawing tolerance. \sa SetDrawingTolerance
+	double GetDrawingTolerance() const {return dDrawingTol;}
+
+	//! Enable or disable the use of a spatial index (bounding volume hierarchy) for all coordinate queries. The index is (re-)build by Update(). \sa GetPropertyByCoordPriority
+	void SetUseSpatialIndex(bool val);
+	//! Check whether a spatial index is requested. \sa SetUseSpatialIndex
+	bool GetUseSpatialIndex() const {return m_UseSpatialIndex;}
+	//! Get the spatial index, may be invalid if not in use or the structure was modified since the last Update().
+	const CSSpatialIndex* GetSpatialIndex() const {return &m_SpatialIndex;}
+
+	//! Enable or disable the use of a compiled snapshot of all primitives for all coordinate queries. The snapshot is (re-)compiled by Update(). \sa CSCompiledScene
+	void SetUseCompiledScene(bool val);
+	//! Check whether a compiled snapshot is requested. \sa SetUseCompiledScene
+	bool GetUseCompiledScene() const {return m_UseCompiledScene;}
+	//! Get the compiled snapshot, may be invalid if not in use or the structure was modified since the last Update().
+	const CSCompiledScene* GetCompiledScene() const {return &m_CompiledScene;}
+
+	//! Enable or disable the tracking of regions changed by Update(). \sa GetDirtyRegions
+	void SetTrackDirtyRegions(bool val);
+	//! Check whether regions changed by Update() are tracked. \sa SetTrackDirtyRegions
+	bool GetTrackDirtyRegions() const {return m_TrackDirtyRegions;}
+	//! Get the regions changed by all calls to Update() since the last ClearDirtyRegions().
+	/*!
+	 Each region is the union of the old and new Cartesian bounding box (6 values each, xmin,xmax,ymin,ymax,zmin,zmax) of a primitive that was moved, resized, reshaped, added or removed,
+	 or that changed its priority or property. Overlapping regions are not merged.
+	 \sa GetDirtyRegionsUnbounded, CSGridVoxelizer::VoxelizeDirtyRegions
+	 */
+	const std::vector<double>& GetDirtyRegions() const {return m_DirtyRegions;}
+	//! Check if a changed primitive has no bounding box, e.g. a user defined primitive. In this case the entire structure has to be considered as changed.
+	bool GetDirtyRegionsUnbounded() const {return m_DirtyUnbounded;}
+	//! Start a new set of dirty regions, e.g. after a consumer has processed all changes.
+	void ClearDirtyRegions();
+
+	//! Set the number of threads used by GetPropertiesByCoordsPriority and to build the polyhedron trees in Update(), 0 (default) will use all available cores
+	void SetNumberOfThreads(unsigned int val) {m_NumThreads=val;}
+	//! Get the number of threads used by GetPropertiesByCoordsPriority, 0 means all available cores. \sa SetNumberOfThreads
+	unsigned int GetNumberOfThreads() const {return m_NumThreads;}
+	//! Get the number of threads to use for the given number of independent tasks, never more threads than tasks. \sa SetNumberOfThreads
+	unsigned int GetNumberOfThreads(size_t numTasks) const;
 
 	//! Get a property by its priority at a given coordinate and property type.
 	/*!
@@ -99,6 +148,10 @@ public:
 	\param markFoundAsUsed Mark the found primitives as beeing used. \sa WarnUnusedPrimitves
 	\param foundPrimitive return the found primitive, set to NULL if none was found
 	\return Returns NULL if coordinate is outside the mesh, no mesh is defined or no property is found.
+	If a spatial index is enabled and valid, only primitives with a bounding box containing the coordinate are tested. \sa SetUseSpatialIndex
+	If a compiled snapshot is enabled and valid, its inside tests are used instead of the tests of the primitives. \sa SetUseCompiledScene
+	Note: The index is only updated by Update(), primitives added to a property afterwards are not considered until the next Update().
+	This query is reentrant and may be used by several threads at once, as long as the structure is not modified.
 	 */
 	CSProperties* GetPropertyByCoordPriority(const double* coord, CSProperties::PropertyType type=CSProperties::ANY, bool markFoundAsUsed=false, CSPrimitives** foundPrimitive=NULL);
 
@@ -106,11 +159,27 @@ public:
 	/*!
 	\sa GetPropertyByCoordPriority
 	\param coords Give a 3*n-element array with the 3D-coordinate set (e.g. x1,y1,z1,x2,y2,z2,...)
+	\param n Number of coordinates
 	\param type Specify the type searched for. (Default is ANY-type)
 	\param markFoundAsUsed Mark the found primitives as beeing used. \sa WarnUnusedPrimitves
-	\return Returns an array of n properties. NULL if coordinate is outside the mesh, no mesh is defined or no property is found.
+	\param foundPrimitives Optional n-element array to return the found primitives.
+	\return Returns a new array of n properties, the caller has to delete[] it. An entry is NULL if no property is found at this coordinate.
 	 */
-	CSProperties** GetPropertiesByCoordsPriority(const double* coords, CSProperties::PropertyType type=CSProperties::ANY, bool markFoundAsUsed=false);
+	CSProperties** GetPropertiesByCoordsPriority(const double* coords, size_t n, CSProperties::PropertyType type=CSProperties::ANY, bool markFoundAsUsed=false, CSPrimitives** foundPrimitives=NULL);
+
+	//! Get properties by its priority at given coordinates and property type into a given array.
+	/*!
+	The search is split into equal parts for the configured number of threads, no memory is allocated per coordinate.
+	\sa GetPropertiesByCoordsPriority SetNumberOfThreads
+	\param coords Give a 3*n-element array with the 3D-coordinate set (e.g. x1,y1,z1,x2,y2,z2,...)
+	\param n Number of coordinates
+	\param props n-element array to return the found properties (NULL if none is found)
+	\param foundPrimitives n-element array to return the found primitives, may be NULL
+	\param type Specify the type searched for. (Default is ANY-type)
+	\param markFoundAsUsed Mark the found primitives as beeing used. \sa WarnUnusedPrimitves
+	\return Returns false on invalid arguments.
+	 */
+	bool GetPropertiesByCoordsPriority(const double* coords, size_t n, CSProperties** props, CSPrimitives** foundPrimitives, CSProperties::PropertyType type=CSProperties::ANY, bool markFoundAsUsed=false);
 
 	CSProperties* GetPropertyByCoordPriority(const double* coord, std::vector<CSPrimitives*> primList, bool markFoundAsUsed=false, CSPrimitives** foundPrimitive=NULL);
 
@@ -132,13 +201,16 @@ public:
 	//! Get a primitives array
 	std::vector<CSPrimitives*>  GetAllPrimitives(bool sorted=false, CSProperties::PropertyType type=CSProperties::ANY);
 
+	//! Get a primitives array in the order they win a coordinate, highest priority first and the order of properties and primitives for equal priorities. \sa GetPropertyByCoordPriority
+	std::vector<CSPrimitives*>  GetPrimitivesByPriority(CSProperties::PropertyType type=CSProperties::ANY);
+
 	//! Get a primitives array of a certian type
 	std::vector<CSPrimitives*>  GetPrimitivesByType(CSPrimitives::PrimitiveType type);
 
 	//! Get a primitives array inside a bounding box and with a certian property type (default is any)
 	std::vector<CSPrimitives*>  GetPrimitivesByBoundBox(const double* boundbox, bool sorted=false, CSProperties::PropertyType type=CSProperties::ANY);
 
-	//! Get the internal index of the property.
+	//! Get the internal index of the property, which is also its ID (unless a transaction is pending). \sa CSProperties::GetID
 	int GetIndex(CSProperties* prop);
 
 	//! Get the quantity of properties included in this structure.
@@ -150,13 +222,19 @@ public:
 	//! Get a properties array of a certian type
 	std::vector<CSProperties*>  GetPropertyByType(CSProperties::PropertyType type);
 
-	//! Get the edges of all includes primitives and add to the desired grid direction. \param nu Direction of grid (x=0,y=1,z=2).
+	//! Get the edges of all includes primitives and add to the desired grid direction. \param nu Direction of grid (x=0,y=1,z=2). The edges are given by the bounding boxes, \sa CSEdgeDetector for the edges of all primitive types.
 	bool InsertEdges2Grid(int nu);
 
 	//! Check whether the structure is valid.
 	virtual bool isGeometryValid();
 	//! Update all primitives and properties e.g. with respect to changed parameter settings. \return Gives an error message in case of a found error.
-	std::string Update();
+	/*!
+	 If only parameter values have changed since the last update, only the properties and primitives depending on a modified parameter
+	 (or marked by CSPrimitives::SetModified or CSProperties::SetModified) are updated. Any other change, e.g. a directly set value or expression
+	 of a primitive or a changed parameter set, results in a full update. The spatial index and compiled scene are always rebuild.
+	 \param fullUpdate Update all primitives and properties.
+	 */
+	std::string Update(bool fullUpdate=false);
 
 	//! Get an array containing the absolute size of the current structure.
 	double* GetObjectArea(CSProperties::PropertyType type=CSProperties::ANY);
@@ -205,6 +283,57 @@ protected:
 
 	void UpdateIDs();
 
+	//! Build the spatial index from all primitives sorted by priority
+	void BuildSpatialIndex();
+	//! Query the spatial index, the candidate vector is used as scratch space
+	CSProperties* GetPropertyByCoordPriority(const double* coord, CSProperties::PropertyType type, bool markFoundAsUsed, CSPrimitives** foundPrimitive, std::vector<unsigned int> &candidates);
+	bool m_UseSpatialIndex;
+	CSSpatialIndex m_SpatialIndex;
+	bool m_UseCompiledScene;
+	CSCompiledScene m_CompiledScene;
+	//! Query the compiled snapshot without a spatial index
+	CSProperties* GetPropertyByCoordPriority(const CSCompiledScene &scene, const double* coord, CSProperties::PropertyType type, bool markFoundAsUsed, CSPrimitives** foundPrimitive);
+
+	bool m_InTransaction;
+	//! all properties by name \sa GetPropertiesByName
+	std::multimap<std::string, CSProperties*> m_NameIndex;
+	bool m_NameIndexValid;
+	unsigned long m_NameIndexCounter;
+
+	//! state of a primitive at the last update, used to find the regions changed by an update
+	struct PrimitiveSnapshot
+	{
+		unsigned int update;
+		bool bounded;
+		double box[6];
+		int priority;
+		CSProperties* prop;
+		//! all values evaluated by the last update of the primitive
+		std::vector<double> values;
+	};
+	bool m_TrackDirtyRegions;
+	unsigned int m_SnapshotUpdate;
+	std::map<CSPrimitives*, PrimitiveSnapshot> m_Snapshots;
+	std::vector<double> m_DirtyRegions;
+	bool m_DirtyUnbounded;
+	void AddDirtyRegion(bool bounded, const double* box);
+	//! Compare the primitive with its last snapshot and add the changed region. \param updated the primitive was updated, its evaluated values are given
+	void UpdateSnapshot(CSPrimitives* prim, bool updated, bool modified, std::vector<double> &values);
+
+	//! Find all parameters modified since the last update. \return false if a full update is required
+	bool FindModifiedParameters(std::vector<Parameter*> &modified) const;
+	bool m_UpdateValid;
+	unsigned long m_UpdateModCounter;
+	//! parameter names at the last update
+	std::vector<std::string> m_UpdateParaNames;
+
+	//! Search the coordinates [start, stop) of a coordinate array, used by each thread of GetPropertiesByCoordsPriority
+	void FindPropertiesByCoordsPriority(const double* coords, size_t start, size_t stop, CSProperties** props, CSPrimitives** prims, CSProperties::PropertyType type);
+	unsigned int m_NumThreads;
+
+	//! Build the trees of all polyhedra not up to date in parallel, polyhedra set to a lazy build are skipped \sa CSPrimPolyhedron::SetLazyBuild
+	void BuildPolyhedronTrees(const std::vector<CSPrimitives*> &vPrimitives);
+
 	CoordinateSystem m_MeshType;
 
 	unsigned int maxID;
@@ -16,11 +16,19 @@
 */
 
 #include "ParameterObjects.h"
+#include <algorithm>
 #include <sstream>
 #include <iostream>
 #include "tinyxml.h"
 #include "CSFunctionParser.h"
 #include "CSUseful.h"
+#include "CSAtomic_p.h"
+
+#include <boost/thread/mutex.hpp>
+
+// guards the lazy parsing of ParameterScalar expressions by the first GetEvaluated(), if not already parsed by Evaluate()
+static boost::mutex g_ParserMutex;
+
 
 bool ReadTerm(ParameterScalar &PS, TiXmlElement &elem, const char* attr, double val)
 {
@@ -277,6 +285,9 @@ bool LinearParameter::ReadFromXML(TiXmlNode &root)
 ParameterSet::ParameterSet(void)
 {
 	bModified=true;
+	m_ScalarModCounter=0;
+	m_DependencyRecorder=NULL;
+	m_ValueRecorder=NULL;
 }
 
 ParameterSet::~ParameterSet(void)
@@ -288,6 +299,7 @@ size_t ParameterSet::LinkParameter(Parameter* newPara)
 {
 	vParameter.push_back(newPara);
 //	newPara->ParameterSet(this);
+	bModified=true;
 	return vParameter.size();
 }
 
@@ -296,6 +308,7 @@ size_t ParameterSet::DeleteParameter(size_t index)
 	if (index>=vParameter.size()) return vParameter.size();
 	std::vector<Parameter*>::iterator pIter=vParameter.begin();
 	vParameter.erase(pIter+index);
+	bModified=true;
 
 	return vParameter.size();
 }
@@ -308,6 +321,7 @@ size_t ParameterSet::DeleteParameter(Parameter* para)
 		if (*pIter==para)
 		{
 			vParameter.erase(pIter);
+			bModified=true;
 			return vParameter.size();
 		}
 		++pIter;
@@ -322,6 +336,7 @@ void ParameterSet::clear()
 		delete vParameter.at(i);
 	}
 	vParameter.clear();
+	bModified=true;
 //	ParameterString.clear();
 //	ParameterValueString.clear();
 }
@@ -515,6 +530,9 @@ bool ParameterSet::ReadFromXML(TiXmlNode &root)
 
 ParameterScalar::ParameterScalar()
 {
+	m_Parser=NULL;
+	m_ParserReady=false;
+	m_ParserPool=NULL;
 	clParaSet=NULL;
 	bModified=true;
 	ParameterMode=false;
@@ -524,12 +542,20 @@ ParameterScalar::ParameterScalar()
 
 ParameterScalar::ParameterScalar(ParameterSet* ParaSet, const std::string value)
 {
+	m_Parser=NULL;
+	m_ParserReady=false;
+	m_ParserPool=NULL;
+	clParaSet=NULL;
 	SetParameterSet(ParaSet);
 	SetValue(value);
 }
 
 ParameterScalar::ParameterScalar(ParameterSet* ParaSet, double value)
 {
+	m_Parser=NULL;
+	m_ParserReady=false;
+	m_ParserPool=NULL;
+	clParaSet=NULL;
 	SetParameterSet(ParaSet);
 	bModified=true;
 	SetValue(value);
@@ -537,15 +563,44 @@ ParameterScalar::ParameterScalar(ParameterSet* ParaSet, double value)
 
 ParameterScalar::ParameterScalar(ParameterScalar* ps)
 {
+	m_Parser=NULL;
+	m_ParserReady=false;
+	m_ParserPool=NULL;
+	clParaSet=NULL;
 	Copy(ps);
 }
 
+ParameterScalar::ParameterScalar(const ParameterScalar &ps)
+{
+	m_Parser=NULL;
+	m_ParserReady=false;
+	m_ParserPool=NULL;
+	clParaSet=NULL;
+	Copy(const_cast<ParameterScalar*>(&ps));
+}
+
 ParameterScalar::~ParameterScalar()
 {
+	ResetParser();
+}
+
+ParameterScalar& ParameterScalar::operator=(const ParameterScalar &ps)
+{
+	if (this!=&ps)
+		Copy(const_cast<ParameterScalar*>(&ps));
+	return *this;
 }
 
 void ParameterScalar::SetParameterSet(ParameterSet *paraSet)
 {
+	if (clParaSet!=paraSet)
+	{
+		ResetParser();
+		// both sets are affected, the scalar has been removed from the old one
+		SetScalarModified();
+		if (paraSet)
+			paraSet->ScalarModified();
+	}
 	clParaSet=paraSet;
 }
 
@@ -561,6 +616,9 @@ int ParameterScalar::SetValue(const std::string value, bool Eval)
 
 	ParameterMode=true;
 	bModified=true;
+	SetScalarModified();
+	if (sValue!=value)
+		ResetParser();
 	sValue=value;
 
 	if (Eval) return Evaluate();
@@ -573,6 +631,14 @@ void ParameterScalar::SetValue(double value)
 	ParameterMode=false;
 	dValue=value;
 	sValue.clear();
+	ResetParser();
+	SetScalarModified();
+}
+
+void ParameterScalar::SetScalarModified()
+{
+	if (clParaSet)
+		clParaSet->ScalarModified();
 }
 
 double ParameterScalar::GetValue() const
@@ -590,54 +656,213 @@ const std::string ParameterScalar::GetValueString() const
 }
 
 int ParameterScalar::Evaluate()
+{
+	int EC = EvaluateValue();
+	if (clParaSet && clParaSet->GetValueRecorder())
+		clParaSet->GetValueRecorder()->push_back(dValue);
+	return EC;
+}
+
+int ParameterScalar::EvaluateValue()
 {
 	if (ParameterMode==false) return 0;
+	// the parser is checked against the parameter names here (update path), thus GetEvaluated can use it without any checks
+	ValidateParser();
+	if (clParaSet && clParaSet->GetDependencyRecorder())
+		RecordDependencies();
 	if (clParaSet!=NULL)
 		bModified = bModified || clParaSet->GetModified();
 	if (bModified==false)
 		return 0;
 
-	CSFunctionParser fParse;
 	dValue=0;
 
-	if (clParaSet!=NULL)
-		fParse.Parse(sValue,clParaSet->GetParameterString());
-	else
-		fParse.Parse(sValue,"");
-
-	if (fParse.GetParseErrorType()!=FunctionParser::FP_NO_ERROR) return fParse.GetParseErrorType()+100;
+	int EC=0;
+	CSFunctionParser* fParse = GetParser(EC);
+	if (fParse==NULL) return EC;
 	bModified=false;
 
 	if (clParaSet!=NULL)
 	{
 		double *vars = new double[clParaSet->GetQtyParameter()];
 		vars=clParaSet->GetValueArray(vars);
-		dValue=fParse.Eval(vars);
+		dValue=fParse->Eval(vars);
 		delete[] vars;vars=NULL;
 	}
 	else
-		dValue=fParse.Eval(NULL);
-	return fParse.EvalError();
+		dValue=fParse->Eval(NULL);
+	return fParse->EvalError();
 }
 
 double ParameterScalar::GetEvaluated(double* ParaValues, int &EC)
 {
 	if (ParameterMode==false) return dValue;
-	CSFunctionParser fParse;
-	fParse.Parse(sValue,clParaSet->GetParameterString());
-	if (fParse.GetParseErrorType()!=FunctionParser::FP_NO_ERROR)
-	{
-		EC = fParse.GetParseErrorType()+100;
+	if (GetParser(EC)==NULL)
 		return 0;
+	return m_ParserPool->Eval(ParaValues,EC);
+}
+
+void ParameterScalar::GetEvaluated(const double* ParaValues, size_t n, size_t stride, double* out, int &EC)
+{
+	if (ParameterMode==false)
+	{
+		for (size_t i=0;i<n;++i)
+			out[i]=dValue;
+		return;
+	}
+	CSFunctionParser* fParse = NULL;
+	if (GetParser(EC)!=NULL)
+	{
+		// each set has to provide a value for every parameter the expression was parsed with
+		if (stride<m_ParserVarNames.size())
+			EC = -1;
+		else
+			fParse = m_ParserPool->Acquire();
+	}
+	if (fParse==NULL)
+	{
+		for (size_t i=0;i<n;++i)
+			out[i]=0;
+		return;
+	}
+	// a single copy of the parser for all coordinates
+	for (size_t i=0;i<n;++i)
+	{
+		out[i] = fParse->Eval(&ParaValues[i*stride]);
+		if (fParse->EvalError())
+			EC = fParse->EvalError();
+	}
+	m_ParserPool->Release(fParse);
+}
+
+bool ParameterScalar::IsParserValid() const
+{
+	if (m_Parser==NULL)
+		return false;
+	size_t nrPara = 0;
+	if (clParaSet!=NULL)
+		nrPara = clParaSet->GetQtyParameter();
+	// check if the parameter names have changed since the last parse
+	if (m_ParserVarNames.size()!=nrPara)
+		return false;
+	for (size_t n=0;n<nrPara;++n)
+		if (m_ParserVarNames.at(n)!=clParaSet->GetParameter(n)->GetName())
+			return false;
+	return true;
+}
+
+void ParameterScalar::ValidateParser()
+{
+	if (IsParserValid()==false)
+		BuildParser();
+}
+
+void ParameterScalar::BuildParser()
+{
+	ResetParser();
+	size_t nrPara = 0;
+	if (clParaSet!=NULL)
+		nrPara = clParaSet->GetQtyParameter();
+	CSFunctionParser* fParse = new CSFunctionParser();
+	m_ParserVarNames.resize(nrPara);
+	for (size_t n=0;n<nrPara;++n)
+		m_ParserVarNames.at(n) = clParaSet->GetParameter(n)->GetName();
+	if (clParaSet!=NULL)
+		fParse->Parse(sValue,clParaSet->GetParameterString());
+	else
+		fParse->Parse(sValue,"");
+	m_ParserError = 0;
+	if (fParse->GetParseErrorType()!=FunctionParser::FP_NO_ERROR)
+		m_ParserError = fParse->GetParseErrorType()+100;
+	FindDependencies();
+	m_ParserPool = new CSFunctionParserPool();
+	m_ParserPool->SetParser(fParse);
+	m_Parser = fParse;
+	// published last, a concurrent GetParser seeing the flag also sees the complete parser
+	StoreRelease(m_ParserReady, true);
+}
+
+CSFunctionParser* ParameterScalar::GetParser(int &EC)
+{
+	// double-checked, the expression is parsed only once by concurrent evaluations and used without locking afterwards
+	if (LoadAcquire(m_ParserReady)==false)
+	{
+		boost::mutex::scoped_lock lock(g_ParserMutex);
+		if (m_ParserReady==false)
+			BuildParser();
+	}
+
+	if (m_ParserError!=0)
+	{
+		EC = m_ParserError;
+		return NULL;
+	}
+	return m_Parser;
+}
+
+void ParameterScalar::ResetParser()
+{
+	m_ParserReady=false;
+	delete m_ParserPool;
+	m_ParserPool=NULL;
+	delete m_Parser;
+	m_Parser=NULL;
+	m_ParserVarNames.clear();
+	m_Dependencies.clear();
+}
+
+void ParameterScalar::FindDependencies()
+{
+	m_Dependencies.clear();
+	if (clParaSet==NULL)
+		return;
+	// all identifiers used by the expression
+	std::vector<std::string> names;
+	size_t pos = 0;
+	while (pos<sValue.size())
+	{
+		char c = sValue.at(pos);
+		if (isalpha(c) || (c=='_'))
+		{
+			size_t start = pos;
+			while ((pos<sValue.size()) && (isalnum(sValue.at(pos)) || (sValue.at(pos)=='_')))
+				++pos;
+			names.push_back(sValue.substr(start,pos-start));
+		}
+		else if (isdigit(c) || (c=='.'))
+		{
+			// skip numbers including an exponent, e.g. 1e-3
+			while ((pos<sValue.size()) && (isalnum(sValue.at(pos)) || (sValue.at(pos)=='.')))
+				++pos;
+		}
+		else
+			++pos;
+	}
+	for (size_t n=0;n<m_ParserVarNames.size();++n)
+		if (std::find(names.begin(),names.end(),m_ParserVarNames.at(n))!=names.end())
+			m_Dependencies.push_back(n);
+}
+
+void ParameterScalar::RecordDependencies()
+{
+	int EC=0;
+	GetParser(EC);
+	if (clParaSet==NULL)
+		return;
+	std::vector<Parameter*>* deps = clParaSet->GetDependencyRecorder();
+	for (size_t n=0;n<m_Dependencies.size();++n)
+	{
+		Parameter* para = clParaSet->GetParameter(m_Dependencies.at(n));
+		if (std::find(deps->begin(),deps->end(),para)==deps->end())
+			deps->push_back(para);
 	}
-	double dvalue = fParse.Eval(ParaValues);
-	EC = fParse.EvalError();
-	return dvalue;
 }
 
 void ParameterScalar::Copy(ParameterScalar* ps)
 {
+	ResetParser();
 	SetParameterSet(ps->clParaSet);
+	SetScalarModified();
 	bModified=ps->bModified;
 	ParameterMode=ps->ParameterMode;
 	sValue=std::string(ps->sValue);
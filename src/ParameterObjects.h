@@ -35,6 +35,8 @@ class Parameter;
 class LinearParameter;
 class ParameterSet;
 class ParameterScalar;
+class CSFunctionParser;
+class CSFunctionParserPool;
 class TiXmlNode;
 class TiXmlElement;
 
@@ -170,6 +172,17 @@ public:
 	//! Set the ParameterSet's modfication status \sa SetModified
 	void SetParaSetModified(bool val) {bModified=val;}
 
+	//! Get a counter increased by every direct modification (value, expression or parameter set) of a ParameterScalar using this set. \sa ContinuousStructure::Update
+	unsigned long GetScalarModificationCounter() const {return m_ScalarModCounter;}
+	//! Increase the scalar modification counter, called by all ParameterScalar using this set \sa GetScalarModificationCounter
+	void ScalarModified() {++m_ScalarModCounter;}
+	//! Record the parameters used by all expressions of this set evaluated by ParameterScalar::Evaluate() into the given vector (without duplicates), NULL to stop recording. Not thread-safe.
+	void SetDependencyRecorder(std::vector<Parameter*>* deps) {m_DependencyRecorder=deps;}
+	std::vector<Parameter*>* GetDependencyRecorder() const {return m_DependencyRecorder;}
+	//! Record the values of all scalars of this set evaluated by ParameterScalar::Evaluate() into the given vector, NULL to stop recording. Not thread-safe.
+	void SetValueRecorder(std::vector<double>* values) {m_ValueRecorder=values;}
+	std::vector<double>* GetValueRecorder() const {return m_ValueRecorder;}
+
 	//! Get the string of all parameter separated by the given spacer
 	const std::string GetParameterString(const std::string spacer=",");
 	//! Get a string of all parameter and values or only the values separated by the given spacer
@@ -202,6 +215,10 @@ protected:
 	std::vector<Parameter* > vParameter;
 	bool bModified;
 	int SweepPara;
+
+	unsigned long m_ScalarModCounter;
+	std::vector<Parameter*>* m_DependencyRecorder;
+	std::vector<double>* m_ValueRecorder;
 };
 
 void PSErrorCode2Msg(int code, std::string* msg);
@@ -218,8 +235,11 @@ public:
 	ParameterScalar(ParameterSet* ParaSet, double value);
 	ParameterScalar(ParameterSet* ParaSet, const std::string value);
 	ParameterScalar(ParameterScalar* ps);
+	ParameterScalar(const ParameterScalar &ps);
 	~ParameterScalar();
 
+	ParameterScalar& operator=(const ParameterScalar &ps);
+
 	void SetParameterSet(ParameterSet *paraSet);
 
 	int SetValue(const std::string value, bool Eval=true); ///returns eval-error-code
@@ -235,7 +255,16 @@ public:
 	//returns error-code
 	int Evaluate();
 
+	//! Evaluate the expression for the given parameter values. The expression is parsed by Evaluate() (or the first evaluation) and re-parsed by Evaluate() if the expression or the parameter names have changed.
+	/*!
+	 This method is reentrant and can be used by several threads at once without locking, each thread evaluates its own copy of the parsed expression.
+	 */
 	double GetEvaluated(double* ParaValues, int &EC);
+	//! Evaluate the expression for n sets of parameter values, using the same copy of the parsed expression for all sets. \sa GetEvaluated
+	/*!
+	 Set i starts at ParaValues[i*stride], the stride must not be smaller than the number of parameters in the parameter set (error code -1 otherwise).
+	 */
+	void GetEvaluated(const double* ParaValues, size_t n, size_t stride, double* out, int &EC);
 
 	// Copy all values and parameter from ps to this.
 	void Copy(ParameterScalar* ps);
@@ -246,6 +275,32 @@ protected:
 	bool ParameterMode;
 	std::string sValue;
 	double dValue;
+
+	//! Get the compiled function parser, it is only created if it does not exist yet (thread-safe, without locking once created). \return NULL on a parse error, the error code is set accordingly
+	CSFunctionParser* GetParser(int &EC);
+	//! Check if the compiled function parser exists and was created with the current parameter names
+	bool IsParserValid() const;
+	//! Re-create the compiled function parser if it is not valid for the current parameter names, not thread-safe \sa IsParserValid
+	void ValidateParser();
+	//! Create the compiled function parser for the current expression and parameter names
+	void BuildParser();
+	//! Delete the compiled function parser, it will be re-created on demand
+	void ResetParser();
+	CSFunctionParser* m_Parser;
+	//! the compiled function parser has been created, set with release semantics after its creation \sa GetParser
+	bool m_ParserReady;
+	//! copies of the compiled function parser for concurrent evaluations
+	CSFunctionParserPool* m_ParserPool;
+	int m_ParserError;
+	//! parameter names the compiled parser was created with
+	std::vector<std::string> m_ParserVarNames;
+	//! indices of the parameters used by the expression, found with the compiled parser
+	std::vector<size_t> m_Dependencies;
+	void FindDependencies();
+	void RecordDependencies();
+	int EvaluateValue();
+	//! Increase the modification counter of the parameter set \sa ParameterSet::GetScalarModificationCounter
+	void SetScalarModified();
 };
 
 #endif